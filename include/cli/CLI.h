@@ -2,8 +2,13 @@
 
 #include "../sql/QueryExecutor.h"
 #include <iostream>
+#include <iomanip>
 #include <string>
 #include <memory>
+#include <sstream>
+#include <vector>
+#include <mutex>
+#include <chrono>
 
 namespace cli {
 
@@ -17,12 +22,31 @@ template<typename T = int>
 class CLI {
 private:
     CatalogManager catalog;
+    std::shared_ptr<lsm::Manifest> manifest;
+    std::shared_ptr<lsm::WriteBufferManager> writeBufferManager;
+    std::shared_ptr<util::ThreadPool> queryPool;
     std::map<std::string, std::shared_ptr<lsm::LSMTree<T>>> lsmTrees;
     QueryExecutor<T> executor;
     bool running;
+    std::mutex tablesMutex;                         // lsmTrees frente al volcado periódico
+    std::unique_ptr<lsm::StatsDumper> statsDumper;  // Se destruye primero
     
 public:
-    CLI() : executor(catalog, lsmTrees), running(false) {}
+    /**
+     * @param dataDirectory Si no está vacío, la base de datos es persistente:
+     * se recuperan tablas y componentes desde su MANIFEST
+     */
+    explicit CLI(const lsm::WriteBufferManager::Options& bufferOptions = lsm::WriteBufferManager::Options(),
+                 size_t resultCacheBytes = 0, const std::string& dataDirectory = "")
+        : manifest(openManifest(dataDirectory)),
+          writeBufferManager(std::make_shared<lsm::WriteBufferManager>(bufferOptions)),
+          queryPool(std::make_shared<util::ThreadPool>()),
+          executor(catalog, lsmTrees, makeTreeOptions(resultCacheBytes)), running(false) {
+        if (manifest) {
+            catalog.attachManifest(manifest);
+            executor.openTables();
+        }
+    }
     
     /**
      * @brief Inicia el REPL
@@ -68,10 +92,21 @@ public:
                 continue;
             }
             
+            if (input.rfind("ingest ", 0) == 0) {
+                ingestFiles(input);
+                continue;
+            }
+            
+            if (input == "stats" || input.rfind("stats ", 0) == 0) {
+                statsCommand(input);
+                continue;
+            }
+            
             // Ejecutar SQL
             try {
-                std::string result = executor.execute(input);
-                std::cout << result << "\n";
+                std::lock_guard<std::mutex> lock(tablesMutex);
+                executor.execute(input, std::cout);
+                std::cout << "\n";
             } catch (const std::exception& e) {
                 std::cout << "Error: " << e.what() << "\n";
             }
@@ -83,6 +118,7 @@ public:
      */
     std::string executeCommand(const std::string& sql) {
         try {
+            std::lock_guard<std::mutex> lock(tablesMutex);
             return executor.execute(sql);
         } catch (const std::exception& e) {
             return "Error: " + std::string(e.what());
@@ -102,6 +138,22 @@ public:
     }
     
 private:
+    static std::shared_ptr<lsm::Manifest> openManifest(const std::string& dataDirectory) {
+        if (dataDirectory.empty()) return nullptr;
+        auto m = std::make_shared<lsm::Manifest>(dataDirectory);
+        m->open();
+        return m;
+    }
+    
+    TreeOptions makeTreeOptions(size_t resultCacheBytes) const {
+        TreeOptions options;
+        options.manifest = manifest;
+        options.writeBufferManager = writeBufferManager;
+        options.queryPool = queryPool;
+        options.resultCacheBytes = resultCacheBytes;
+        return options;
+    }
+    
     void printBanner() {
         std::cout << R"(
 ╔═══════════════════════════════════════════════════════════╗
@@ -116,16 +168,29 @@ private:
         std::cout << R"(
 Available Commands:
   SQL Statements:
-    CREATE TABLE name (col1 type1, col2 type2, ...)
-    INSERT INTO table VALUES (x, y, data)
+    CREATE TABLE name (col1 type1, col2 type2, ...)   (a TIMESTAMP column adds time)
+    INSERT INTO table VALUES (x, y[, t], data)[, (...) ...]
+    LOAD 'file' INTO table [FORMAT csv|wkt|binary] [HEADER] [BULK]
+         [DELIMITER ';'] [COLUMNS (x, y[, data])] [THREADS n] [MAX_ERRORS n]
+    COPY table FROM 'file' [same options as LOAD]
     SELECT COUNT(*) FROM table WHERE spatial_intersect(col, x1, y1, x2, y2)
-    SELECT * FROM table WHERE spatial_intersect(col, x1, y1, x2, y2)
+    SELECT * FROM table WHERE spatial_intersect(col, x1, y1, x2, y2[, t1, t2])
+         [AND col op value ...] [LIMIT n] [OFFSET m]   (op: = < <= > >=)
+    SELECT COUNT(*), SUM(col), AVG(col) FROM table [WHERE ...]
+         GROUP BY grid(col, cellSize)
+    PREPARE name AS INSERT INTO table VALUES (?, ?, ?)
+    EXECUTE name (v1, v2, ...)
+    DEALLOCATE name
   
   Special Commands:
     help       - Show this help message
     metrics    - Display performance metrics
     tables     - List all tables
     clear      - Clear metrics
+    stats [table]             - Per-level statistics (files, size, compaction, RA, overlap)
+    stats dump <file> <secs>  - Append stats to <file> every <secs> seconds
+    stats dump off            - Stop the periodic stats dump
+    ingest <table> <file>...  - Ingest pre-built component files
     exit/quit  - Exit the system
   
   Example Usage:
@@ -138,6 +203,15 @@ Available Commands:
     void printMetrics() {
         std::cout << "\n=== Performance Metrics ===\n";
         
+        std::cout << "\nWrite Buffer Manager: " << writeBufferManager->memoryUsage()
+                  << " / " << writeBufferManager->bufferSize() << " bytes ("
+                  << writeBufferManager->getForcedFlushes() << " forced flushes)\n";
+        
+        auto plans = executor.getPlanCacheStats();
+        std::cout << "Plan Cache: " << plans.entries << " plans, " << plans.hits << " hits, "
+                  << plans.misses << " misses, " << executor.preparedStatementCount()
+                  << " prepared statements\n";
+        
         for (const auto& [tableName, tree] : lsmTrees) {
             const auto& metrics = tree->getMetrics();
             
@@ -147,12 +221,64 @@ Available Commands:
             std::cout << "  Total Writes: " << metrics.totalWrites << "\n";
             std::cout << "  Total Reads: " << metrics.totalReads << "\n";
             std::cout << "  Total Merges: " << metrics.totalMerges << "\n";
-            std::cout << "  Avg Query Latency: " << metrics.avgQueryLatency << " ms\n";
+            std::cout << "  Avg Query Latency: " << metrics.avgQueryLatency() << " ms\n";
             std::cout << "  Component Count: " << tree->getComponentCount() << "\n";
             std::cout << "  Total Records: " << tree->getTotalRecords() << "\n";
+            std::cout << "  MemTable Memory: " << tree->getMemTableMemoryUsage() << " bytes\n";
+            
+            std::cout << "  Latency (us)        count       p50       p90       p99     p99.9       max\n";
+            printLatency("insert", metrics.insertLatency);
+            printLatency("point query", metrics.pointQueryLatency);
+            printLatency("range query", metrics.rangeQueryLatency);
+            printLatency("flush", metrics.flushLatency);
+            printLatency("merge", metrics.mergeLatency);
+            
+            if (tree->hasResultCache()) {
+                auto cache = tree->getResultCacheStats();
+                std::cout << "  Result Cache: " << cache.entries << " entries, "
+                          << cache.memoryUsage << " bytes, " << cache.hits << " hits, "
+                          << cache.misses << " misses, " << cache.invalidations
+                          << " invalidations, " << cache.evictions << " evictions\n";
+            }
+            
+            auto stall = tree->getWriteStallStats();
+            auto limits = tree->getWriteControllerOptions();
+            std::cout << "  Write Stall State: " << lsm::WriteController::stateName(stall.state) << "\n";
+            std::cout << "    L0 Components: " << stall.l0Components
+                      << " (slowdown " << limits.l0SlowdownTrigger
+                      << ", stop " << limits.l0StopTrigger << ")\n";
+            std::cout << "    Immutable MemTables: " << stall.immutableMemTables
+                      << " (slowdown " << limits.immutableSlowdownTrigger
+                      << ", stop " << limits.immutableStopTrigger << ")\n";
+            std::cout << "    Pending Compaction: " << stall.pendingCompactionBytes
+                      << " bytes (slowdown " << limits.pendingCompactionSlowdownBytes
+                      << ", stop " << limits.pendingCompactionStopBytes << ")\n";
+            std::cout << "    Delayed Rate: " << stall.currentDelayedRate << " bytes/s\n";
+            std::cout << "    Delayed Writes: " << stall.delayedWrites
+                      << " (" << stall.totalDelayMicros << " us)\n";
+            std::cout << "    Stopped Writes: " << stall.stoppedWrites
+                      << " (" << stall.totalStopMicros << " us, "
+                      << stall.stopTimeouts << " timeouts)\n";
         }
     }
     
+    static void printLatency(const char* name, const util::LatencyHistogram& histogram) {
+        auto snap = histogram.snapshot();
+        auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+        
+        std::ios::fmtflags flags(std::cout.flags());
+        std::streamsize precision = std::cout.precision();
+        std::cout << "    " << std::left << std::setw(14) << name << std::right
+                  << std::setw(8) << snap.count << std::fixed << std::setprecision(1)
+                  << std::setw(10) << us(snap.percentile(50))
+                  << std::setw(10) << us(snap.percentile(90))
+                  << std::setw(10) << us(snap.percentile(99))
+                  << std::setw(10) << us(snap.percentile(99.9))
+                  << std::setw(10) << us(snap.max) << "\n";
+        std::cout.flags(flags);
+        std::cout.precision(precision);
+    }
+    
     void printTables() {
         std::cout << "\n=== Tables ===\n";
         
@@ -165,6 +291,91 @@ Available Commands:
         }
     }
     
+    /**
+     * @brief ingest <table> <file1> [file2 ...]
+     */
+    void ingestFiles(const std::string& input) {
+        std::stringstream ss(input);
+        std::string command, tableName, file;
+        ss >> command >> tableName;
+        
+        std::vector<std::string> files;
+        while (ss >> file) {
+            files.push_back(file);
+        }
+        
+        auto it = lsmTrees.find(tableName);
+        if (it == lsmTrees.end() || files.empty()) {
+            std::cout << "Usage: ingest <table> <file1> [file2 ...] (table must exist)\n";
+            return;
+        }
+        
+        try {
+            std::lock_guard<std::mutex> lock(tablesMutex);
+            size_t count = it->second->ingestComponents(files);
+            std::cout << "Ingested " << count << " component(s) into '" << tableName << "'\n";
+        } catch (const std::exception& e) {
+            std::cout << "Error: " << e.what() << "\n";
+        }
+    }
+    
+    /**
+     * @brief Informe de estadísticas por nivel de una tabla o de todas
+     */
+    std::string statsReport(const std::string& only = "") {
+        std::lock_guard<std::mutex> lock(tablesMutex);
+        std::ostringstream out;
+        for (const auto& [tableName, tree] : lsmTrees) {
+            if (!only.empty() && tableName != only) continue;
+            const auto& metrics = tree->getMetrics();
+            out << "Table: " << tableName << " (" << metrics.totalWrites << " writes, "
+                << metrics.totalReads << " reads, " << metrics.totalMerges << " merges)\n";
+            out << lsm::formatLevelStats(tree->getLevelStats());
+        }
+        return out.str();
+    }
+    
+    /**
+     * @brief stats [table] | stats dump <file> <seconds> | stats dump off
+     */
+    void statsCommand(const std::string& input) {
+        std::stringstream ss(input);
+        std::string command, arg, file;
+        ss >> command >> arg;
+        
+        if (arg != "dump") {
+            if (!arg.empty() && lsmTrees.find(arg) == lsmTrees.end()) {
+                std::cout << "Unknown table: " << arg << "\n";
+                return;
+            }
+            std::string report = statsReport(arg);
+            std::cout << (report.empty() ? "No tables created yet.\n" : report);
+            return;
+        }
+        
+        ss >> file;
+        if (file == "off") {
+            if (!statsDumper) {
+                std::cout << "Stats dump is not running.\n";
+                return;
+            }
+            std::cout << "Stopped stats dump to '" << statsDumper->getPath() << "'\n";
+            statsDumper.reset();
+            return;
+        }
+        
+        double seconds = 0.0;
+        if (file.empty() || !(ss >> seconds) || seconds <= 0.0) {
+            std::cout << "Usage: stats dump <file> <seconds> | stats dump off\n";
+            return;
+        }
+        statsDumper.reset();
+        statsDumper = std::make_unique<lsm::StatsDumper>(
+            file, std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000.0)),
+            [this]() { return statsReport(); });
+        std::cout << "Dumping stats to '" << file << "' every " << seconds << " s\n";
+    }
+    
     void clearMetrics() {
         for (auto& [tableName, tree] : lsmTrees) {
             tree->resetMetrics();
@@ -0,0 +1,441 @@
+#pragma once
+
+#include "../spatial/MBR.h"
+#include "../spatial/Point.h"
+#include "../spatial/SpatialComparators.h"
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+
+namespace lsm {
+
+using namespace spatial;
+
+/**
+ * @brief Opciones de codificación de bloques de componentes
+ */
+struct BlockEncodingOptions {
+    size_t recordsPerBlock;
+    bool losslessCoordinates;  // Columnas que no cuantizan exactas se guardan como double
+    bool compress;             // Comprime cada bloque con BlockCodec
+
+    BlockEncodingOptions() : recordsPerBlock(4096), losslessCoordinates(true), compress(true) {}
+};
+
+/**
+ * @brief Codificación varint (LEB128) para claves y residuos
+ */
+namespace varint {
+
+inline void put(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint64_t get(const uint8_t*& p, const uint8_t* end) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p >= end) throw std::runtime_error("Corrupt block: truncated varint");
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+    throw std::runtime_error("Corrupt block: varint too long");
+}
+
+} // namespace varint
+
+/**
+ * @brief Códec LZ rápido integrado (formato de secuencias estilo LZ4)
+ * Secuencia: token [lit_len:4 | match_len-4:4], literales, offset u16,
+ * extensiones de longitud con bytes 255. La última secuencia solo lleva
+ * literales.
+ */
+class BlockCodec {
+private:
+    static constexpr size_t MIN_MATCH = 4;
+    static constexpr size_t HASH_BITS = 14;
+    static constexpr size_t MAX_OFFSET = 65535;
+    static constexpr size_t LAST_LITERALS = 5;
+
+    static uint32_t read32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint32_t hash(uint32_t v) {
+        return (v * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    static void putLength(std::vector<uint8_t>& out, size_t len) {
+        while (len >= 255) {
+            out.push_back(255);
+            len -= 255;
+        }
+        out.push_back(static_cast<uint8_t>(len));
+    }
+
+    static void emitSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t litLen,
+                             size_t offset, size_t matchLen) {
+        size_t tokenPos = out.size();
+        out.push_back(0);
+
+        uint8_t token = static_cast<uint8_t>(std::min<size_t>(litLen, 15) << 4);
+        if (litLen >= 15) putLength(out, litLen - 15);
+        out.insert(out.end(), literals, literals + litLen);
+
+        if (matchLen > 0) {
+            size_t code = matchLen - MIN_MATCH;
+            token |= static_cast<uint8_t>(std::min<size_t>(code, 15));
+            out.push_back(static_cast<uint8_t>(offset & 0xFF));
+            out.push_back(static_cast<uint8_t>(offset >> 8));
+            if (code >= 15) putLength(out, code - 15);
+        }
+        out[tokenPos] = token;
+    }
+
+    static size_t getLength(const uint8_t*& p, const uint8_t* end, size_t base) {
+        size_t len = base;
+        if (base == 15) {
+            uint8_t byte;
+            do {
+                if (p >= end) throw std::runtime_error("Corrupt block: truncated length");
+                byte = *p++;
+                len += byte;
+            } while (byte == 255);
+        }
+        return len;
+    }
+
+public:
+    static std::vector<uint8_t> compress(const std::vector<uint8_t>& in) {
+        std::vector<uint8_t> out;
+        out.reserve(in.size() / 2 + 16);
+
+        const uint8_t* base = in.data();
+        const size_t n = in.size();
+        std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);  // posición + 1
+
+        size_t anchor = 0;
+        size_t pos = 0;
+        while (n >= MIN_MATCH + LAST_LITERALS && pos + MIN_MATCH + LAST_LITERALS <= n) {
+            uint32_t seq = read32(base + pos);
+            uint32_t h = hash(seq);
+            size_t candidate = table[h];
+            table[h] = static_cast<uint32_t>(pos + 1);
+
+            if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET ||
+                read32(base + candidate - 1) != seq) {
+                ++pos;
+                continue;
+            }
+
+            size_t ref = candidate - 1;
+            size_t matchLen = MIN_MATCH;
+            while (pos + matchLen + LAST_LITERALS < n && base[ref + matchLen] == base[pos + matchLen]) {
+                ++matchLen;
+            }
+
+            emitSequence(out, base + anchor, pos - anchor, pos - ref, matchLen);
+            pos += matchLen;
+            anchor = pos;
+        }
+
+        emitSequence(out, base + anchor, n - anchor, 0, 0);
+        return out;
+    }
+
+    static std::vector<uint8_t> decompress(const uint8_t* p, size_t size, size_t rawSize) {
+        std::vector<uint8_t> out;
+        out.reserve(rawSize);
+        const uint8_t* end = p + size;
+
+        while (p < end) {
+            uint8_t token = *p++;
+            size_t litLen = getLength(p, end, token >> 4);
+            if (static_cast<size_t>(end - p) < litLen || out.size() + litLen > rawSize) {
+                throw std::runtime_error("Corrupt block: literal overrun");
+            }
+            out.insert(out.end(), p, p + litLen);
+            p += litLen;
+
+            if (p >= end) break;  // Última secuencia
+
+            if (end - p < 2) throw std::runtime_error("Corrupt block: truncated offset");
+            size_t offset = static_cast<size_t>(p[0]) | (static_cast<size_t>(p[1]) << 8);
+            p += 2;
+            size_t matchLen = getLength(p, end, token & 0x0F) + MIN_MATCH;
+
+            if (offset == 0 || offset > out.size() || out.size() + matchLen > rawSize) {
+                throw std::runtime_error("Corrupt block: bad match");
+            }
+            // Copia byte a byte: las coincidencias pueden solaparse
+            size_t from = out.size() - offset;
+            for (size_t i = 0; i < matchLen; ++i) {
+                out.push_back(out[from + i]);
+            }
+        }
+
+        if (out.size() != rawSize) throw std::runtime_error("Corrupt block: size mismatch");
+        return out;
+    }
+};
+
+/**
+ * @brief Codificador de bloques de registros espaciales
+ * Layout del bloque (SoA para decodificación vectorizable):
+ *   varint count, u8 flags,
+ *   claves de curva: varint primera + varint deltas,
+ *   coordenadas por dimensión: columna u32 cuantizada (relativa al MBR);
+ *   si lossless, un u8 de modo delante de cada columna y, cuando alguna
+ *   coordenada no sobrevive a la cuantización, la columna en double,
+ *   bitmap de tombstones, payloads T.
+ * Los bloques antiguos con FLAG_LOSSLESS (u32 + residuo XOR varint, que
+ * ocupaba más que el double) se siguen leyendo.
+ * En disco: u32 rawSize, u32 storedSize, u8 codec, bytes.
+ */
+template<typename T>
+class BlockEncoder {
+private:
+    static constexpr uint8_t FLAG_LOSSLESS = 0x01;       // Formato antiguo: residuos XOR
+    static constexpr uint8_t FLAG_EXACT_COLUMNS = 0x02;  // Modo por columna
+    static constexpr uint8_t COLUMN_QUANTIZED = 0;
+    static constexpr uint8_t COLUMN_RAW = 1;
+    static constexpr uint8_t CODEC_NONE = 0;
+    static constexpr uint8_t CODEC_LZ = 1;
+    static constexpr double QUANT_MAX = 4294967295.0;
+
+    static uint64_t bitsOf(double v) {
+        uint64_t b;
+        std::memcpy(&b, &v, sizeof(b));
+        return b;
+    }
+
+    static double fromBits(uint64_t b) {
+        double v;
+        std::memcpy(&v, &b, sizeof(v));
+        return v;
+    }
+
+    static uint32_t quantize(double value, double lo, double range) {
+        if (!(range > 0.0)) return 0;
+        double q = std::round((value - lo) / range * QUANT_MAX);
+        if (q <= 0.0) return 0;
+        if (q >= QUANT_MAX) return 0xFFFFFFFFu;
+        return static_cast<uint32_t>(q);
+    }
+
+    static void put32(std::vector<uint8_t>& out, uint32_t v) {
+        uint8_t bytes[4];
+        std::memcpy(bytes, &v, 4);
+        out.insert(out.end(), bytes, bytes + 4);
+    }
+
+    /**
+     * @brief Dequantiza una columna: bucle sin dependencias, autovectorizable
+     */
+    static void dequantizeColumn(const uint32_t* q, double* out, size_t n, double lo, double scale) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = lo + static_cast<double>(q[i]) * scale;
+        }
+    }
+
+public:
+    /**
+     * @brief Codifica registros ya ordenados por clave de curva
+     */
+    static std::vector<uint8_t> encode(const std::vector<SpatialRecord<T>>& records,
+                                       const std::vector<uint64_t>& keys,
+                                       const MBR& bounds,
+                                       const BlockEncodingOptions& options) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "BlockEncoder requires a trivially copyable payload");
+
+        const size_t n = records.size();
+        const size_t dims = bounds.dimensions();
+        std::vector<uint8_t> raw;
+        raw.reserve(n * (dims * 4 + sizeof(T) + 4) + 16);
+
+        varint::put(raw, n);
+        raw.push_back(options.losslessCoordinates ? FLAG_EXACT_COLUMNS : 0);
+
+        uint64_t prev = 0;
+        for (size_t i = 0; i < n; ++i) {
+            varint::put(raw, i == 0 ? keys[i] : keys[i] - prev);
+            prev = keys[i];
+        }
+
+        std::vector<uint32_t> column(n);
+        for (size_t d = 0; d < dims; ++d) {
+            double lo = bounds.getLower()[d];
+            double range = bounds.getUpper()[d] - lo;
+            double scale = range > 0.0 ? range / QUANT_MAX : 0.0;
+            bool exact = true;
+            for (size_t i = 0; i < n; ++i) {
+                column[i] = quantize(records[i].point[d], lo, range);
+                double approx = lo + static_cast<double>(column[i]) * scale;
+                exact = exact && bitsOf(approx) == bitsOf(records[i].point[d]);
+            }
+
+            size_t offset = raw.size();
+            if (options.losslessCoordinates) {
+                raw.push_back(exact ? COLUMN_QUANTIZED : COLUMN_RAW);
+                ++offset;
+                if (!exact) {
+                    raw.resize(offset + n * sizeof(double));
+                    for (size_t i = 0; i < n; ++i) {
+                        double value = records[i].point[d];
+                        std::memcpy(raw.data() + offset + i * sizeof(double), &value, sizeof(double));
+                    }
+                    continue;
+                }
+            }
+            raw.resize(offset + n * sizeof(uint32_t));
+            std::memcpy(raw.data() + offset, column.data(), n * sizeof(uint32_t));
+        }
+
+        std::vector<uint8_t> tombstones((n + 7) / 8, 0);
+        for (size_t i = 0; i < n; ++i) {
+            if (records[i].isTombstone) tombstones[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+        }
+        raw.insert(raw.end(), tombstones.begin(), tombstones.end());
+
+        size_t dataOffset = raw.size();
+        raw.resize(dataOffset + n * sizeof(T));
+        for (size_t i = 0; i < n; ++i) {
+            std::memcpy(raw.data() + dataOffset + i * sizeof(T), &records[i].data, sizeof(T));
+        }
+
+        std::vector<uint8_t> stored;
+        uint8_t codec = CODEC_NONE;
+        if (options.compress) {
+            stored = BlockCodec::compress(raw);
+            if (stored.size() < raw.size()) codec = CODEC_LZ;
+        }
+        const std::vector<uint8_t>& body = (codec == CODEC_LZ) ? stored : raw;
+
+        std::vector<uint8_t> out;
+        out.reserve(body.size() + 9);
+        put32(out, static_cast<uint32_t>(raw.size()));
+        put32(out, static_cast<uint32_t>(body.size()));
+        out.push_back(codec);
+        out.insert(out.end(), body.begin(), body.end());
+        return out;
+    }
+
+    /**
+     * @brief Lee la cabecera del bloque en disco y devuelve el cuerpo crudo
+     */
+    static std::vector<uint8_t> unwrap(const uint8_t* p, size_t size, size_t& consumed) {
+        if (size < 9) throw std::runtime_error("Corrupt block: truncated header");
+        uint32_t rawSize, storedSize;
+        std::memcpy(&rawSize, p, 4);
+        std::memcpy(&storedSize, p + 4, 4);
+        uint8_t codec = p[8];
+        if (size - 9 < storedSize) throw std::runtime_error("Corrupt block: truncated body");
+        consumed = 9 + storedSize;
+
+        if (codec == CODEC_LZ) return BlockCodec::decompress(p + 9, storedSize, rawSize);
+        if (codec != CODEC_NONE || storedSize != rawSize) {
+            throw std::runtime_error("Corrupt block: unknown codec");
+        }
+        return std::vector<uint8_t>(p + 9, p + 9 + storedSize);
+    }
+
+    /**
+     * @brief Decodifica un bloque (ya descomprimido) en registros
+     */
+    static std::vector<SpatialRecord<T>> decode(const std::vector<uint8_t>& raw, const MBR& bounds,
+                                                std::vector<uint64_t>* keysOut = nullptr) {
+        const uint8_t* p = raw.data();
+        const uint8_t* end = p + raw.size();
+        const size_t dims = bounds.dimensions();
+
+        uint64_t count = varint::get(p, end);
+        if (p >= end) throw std::runtime_error("Corrupt block: missing flags");
+        uint8_t flags = *p++;
+
+        // Cada registro ocupa al menos un byte de clave y su payload: acotar
+        // n con lo que queda antes de reservar nada
+        if (count > static_cast<uint64_t>(end - p) / (1 + sizeof(T))) {
+            throw std::runtime_error("Corrupt block: record count exceeds block size");
+        }
+        size_t n = static_cast<size_t>(count);
+
+        std::vector<uint64_t> keys(n);
+        uint64_t prev = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t v = varint::get(p, end);
+            keys[i] = (i == 0) ? v : prev + v;
+            prev = keys[i];
+        }
+
+        // Coordenadas en columnas (SoA) y luego transpuestas a Point
+        std::vector<double> coords(n * dims);
+        std::vector<uint32_t> column(n);
+        for (size_t d = 0; d < dims; ++d) {
+            double* out = coords.data() + d * n;
+            if (flags & FLAG_EXACT_COLUMNS) {
+                if (p >= end) throw std::runtime_error("Corrupt block: missing column mode");
+                uint8_t mode = *p++;
+                if (mode == COLUMN_RAW) {
+                    if (static_cast<size_t>(end - p) < n * sizeof(double)) {
+                        throw std::runtime_error("Corrupt block: truncated coordinates");
+                    }
+                    std::memcpy(out, p, n * sizeof(double));
+                    p += n * sizeof(double);
+                    continue;
+                }
+                if (mode != COLUMN_QUANTIZED) throw std::runtime_error("Corrupt block: bad column mode");
+            }
+
+            if (static_cast<size_t>(end - p) < n * sizeof(uint32_t)) {
+                throw std::runtime_error("Corrupt block: truncated coordinates");
+            }
+            std::memcpy(column.data(), p, n * sizeof(uint32_t));
+            p += n * sizeof(uint32_t);
+
+            double lo = bounds.getLower()[d];
+            double range = bounds.getUpper()[d] - lo;
+            double scale = range > 0.0 ? range / QUANT_MAX : 0.0;
+            dequantizeColumn(column.data(), out, n, lo, scale);
+
+            if (flags & FLAG_LOSSLESS) {
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = fromBits(bitsOf(out[i]) ^ varint::get(p, end));
+                }
+            }
+        }
+
+        size_t bitmapSize = (n + 7) / 8;
+        if (static_cast<size_t>(end - p) < bitmapSize + n * sizeof(T)) {
+            throw std::runtime_error("Corrupt block: truncated payload");
+        }
+        const uint8_t* bitmap = p;
+        p += bitmapSize;
+
+        std::vector<SpatialRecord<T>> records;
+        records.reserve(n);
+        std::vector<double> pointCoords(dims);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t d = 0; d < dims; ++d) pointCoords[d] = coords[d * n + i];
+            T data;
+            std::memcpy(&data, p + i * sizeof(T), sizeof(T));
+            bool tombstone = (bitmap[i / 8] >> (i % 8)) & 1;
+            records.emplace_back(Point(pointCoords), data, tombstone);
+        }
+
+        if (keysOut) keysOut->swap(keys);
+        return records;
+    }
+};
+
+} // namespace lsm
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "LSMComponent.h"
+#include "PartitioningStrategy.h"
+#include "../spatial/SpatialComparators.h"
+#include <vector>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <stdexcept>
+
+namespace lsm {
+
+using namespace spatial;
+
+/**
+ * @brief Constructor offline de componentes (bulk refresh)
+ * Ordena y particiona un dataset completo con STR o R*-Grove y escribe
+ * componentes terminados a disco, listos para LSMTree::ingestComponents().
+ * Evita memtable, flush y merges: WA ≈ 1 para recargas masivas.
+ */
+template<typename T>
+class ComponentBuilder {
+public:
+    struct Options {
+        std::string partitioning;     // STR, RStarGrove
+        std::string outputDirectory;
+        size_t maxComponentSize;      // Registros por componente
+        size_t dimensions;
+        double sampleRatio;           // Solo para RStarGrove
+        BlockEncodingOptions encoding;
+
+        Options() : partitioning("STR"), outputDirectory("./data/ingest"),
+                    maxComponentSize(100000), dimensions(2), sampleRatio(0.1) {}
+    };
+
+private:
+    Options options;
+
+    std::unique_ptr<PartitioningStrategy<T>> makePartitioner() const {
+        if (options.partitioning == "STR") {
+            return std::make_unique<STRPartitioning<T>>();
+        } else if (options.partitioning == "RStarGrove") {
+            return std::make_unique<RStarGrovePartitioning<T>>(options.sampleRatio);
+        }
+        throw std::invalid_argument("Unsupported partitioning for component builder: " +
+                                    options.partitioning);
+    }
+
+public:
+    explicit ComponentBuilder(const Options& opts = Options()) : options(opts) {}
+
+    /**
+     * @brief Particiona los registros y escribe los componentes a disco
+     * @return Rutas de los ficheros generados
+     * @throws std::runtime_error si la estrategia no produce ningún componente
+     */
+    std::vector<std::string> build(const std::vector<SpatialRecord<T>>& records) const {
+        std::vector<std::string> files;
+        if (records.empty()) return files;
+
+        auto partitioner = makePartitioner();
+        auto components = partitioner->partition(records, 0, options.dimensions,
+                                                  options.maxComponentSize);
+        if (components.empty()) {
+            throw std::runtime_error(options.partitioning + " partitioning produced no components for " +
+                                     std::to_string(records.size()) + " records");
+        }
+
+        for (const auto& comp : components) {
+            comp->setBlockEncoding(options.encoding);
+            if (!comp->saveToDisk(options.outputDirectory)) {
+                throw std::runtime_error("Failed to write component " + comp->getFilename());
+            }
+            files.push_back((std::filesystem::path(options.outputDirectory) /
+                             comp->getFilename()).string());
+        }
+
+        return files;
+    }
+
+    /**
+     * @brief Lee un dataset offline en formato CSV: x,y[,...],data
+     * La última columna es el payload; las anteriores son coordenadas.
+     */
+    std::vector<SpatialRecord<T>> readCSV(const std::string& path) const {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("Cannot open dataset: " + path);
+        }
+
+        std::vector<SpatialRecord<T>> records;
+        std::string line;
+        size_t lineNo = 0;
+
+        while (std::getline(in, line)) {
+            ++lineNo;
+            if (line.empty() || line[0] == '#') continue;
+
+            std::vector<double> values;
+            std::stringstream ss(line);
+            std::string field;
+            while (std::getline(ss, field, ',')) {
+                try {
+                    values.push_back(std::stod(field));
+                } catch (const std::exception&) {
+                    throw std::runtime_error("Invalid number at " + path + ":" +
+                                             std::to_string(lineNo));
+                }
+            }
+
+            if (values.size() < options.dimensions) {
+                throw std::runtime_error("Too few columns at " + path + ":" +
+                                         std::to_string(lineNo));
+            }
+
+            std::vector<double> coords(values.begin(), values.begin() + options.dimensions);
+            T data = values.size() > options.dimensions
+                ? static_cast<T>(values[options.dimensions]) : T();
+            records.emplace_back(Point(coords), data, false);
+        }
+
+        return records;
+    }
+};
+
+} // namespace lsm
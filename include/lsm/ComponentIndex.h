@@ -0,0 +1,335 @@
+#pragma once
+
+#include "LSMComponent.h"
+#include "../spatial/MBR.h"
+#include "../spatial/Point.h"
+#include <map>
+#include <queue>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+
+namespace lsm {
+
+using namespace spatial;
+
+/**
+ * @brief Índice espacial global sobre los MBRs de los componentes
+ * Una versión inmutable por conjunto de componentes: cada nivel tiene su
+ * propio R-tree empaquetado (STR) sobre los MBRs. Al cambiar el conjunto
+ * solo se reconstruyen los niveles afectados; el resto se comparte con la
+ * versión anterior. Lo usan consultas por rango, kNN y selección de
+ * compactación, en lugar de recorrer diskComponents linealmente.
+ */
+template<typename T>
+class ComponentIndex {
+public:
+    using ComponentPtr = std::shared_ptr<LSMComponent<T>>;
+
+    struct Entry {
+        ComponentPtr component;
+        uint64_t sequence;   // Secuencia de escritura más alta: mayor = más reciente
+    };
+
+private:
+    static constexpr size_t FANOUT = 16;
+    static constexpr size_t MAX_DIMS = 3;   // Espacio (x, y) y, opcionalmente, tiempo
+
+    /**
+     * @brief R-tree empaquetado de un nivel, en arrays planos
+     */
+    struct LevelIndex {
+        struct Node {
+            double lo[MAX_DIMS];
+            double hi[MAX_DIMS];
+            uint32_t first;   // Primer hijo (nodos) o primera entrada (hojas)
+            uint32_t count;
+            bool leaf;
+        };
+
+        std::vector<Entry> entries;   // Reordenadas por tiles STR
+        std::vector<Node> nodes;      // nodes.back() es la raíz
+        size_t dims = 2;
+    };
+
+    std::map<size_t, std::shared_ptr<const LevelIndex>> levels;
+    size_t totalEntries = 0;
+
+    static double lowOf(const MBR& m, size_t d) { return m.getLower()[d]; }
+    static double highOf(const MBR& m, size_t d) { return m.getUpper()[d]; }
+
+    /**
+     * @brief Construye el R-tree empaquetado de un nivel (STR en 2D o 3D)
+     */
+    static std::shared_ptr<const LevelIndex> buildLevel(std::vector<Entry> entries) {
+        auto index = std::make_shared<LevelIndex>();
+        if (entries.empty()) return index;
+
+        index->dims = std::min(MAX_DIMS, entries.front().component->getMBR().dimensions());
+        const size_t dims = index->dims;
+
+        auto center = [dims](const Entry& e, size_t d) {
+            if (d >= dims) return 0.0;
+            const MBR& m = e.component->getMBR();
+            return (lowOf(m, d) + highOf(m, d)) * 0.5;
+        };
+
+        auto sortBy = [&](size_t d, size_t first, size_t last) {
+            std::sort(entries.begin() + first, entries.begin() + last,
+                      [&](const Entry& a, const Entry& b) { return center(a, d) < center(b, d); });
+        };
+
+        // Con tiempo, primero franjas temporales: los componentes de tablas
+        // espacio-temporales cubren casi todo el espacio y solo se separan
+        // por tiempo, así que cada nodo debe cubrir un intervalo estrecho
+        size_t leaves = (entries.size() + FANOUT - 1) / FANOUT;
+        size_t slabSize = entries.size();
+        if (dims > 2) {
+            sortBy(2, 0, entries.size());
+            size_t slabs = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(leaves))));
+            slabSize = (leaves + slabs - 1) / slabs * FANOUT;
+        }
+
+        // STR en cada franja: ordenar por x, cortar en slices, ordenar cada slice por y
+        for (size_t s = 0; s < entries.size(); s += slabSize) {
+            size_t slabEnd = std::min(s + slabSize, entries.size());
+            sortBy(0, s, slabEnd);
+            size_t slabLeaves = (slabEnd - s + FANOUT - 1) / FANOUT;
+            size_t slices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(slabLeaves))));
+            size_t sliceSize = slices * FANOUT;
+            for (size_t i = s; i < slabEnd; i += sliceSize) {
+                sortBy(1, i, std::min(i + sliceSize, slabEnd));
+            }
+        }
+        index->entries = std::move(entries);
+
+        auto makeNode = [dims](bool leaf, uint32_t first, uint32_t count) {
+            typename LevelIndex::Node n{};
+            for (size_t d = 0; d < MAX_DIMS; ++d) {
+                n.lo[d] = std::numeric_limits<double>::max();
+                n.hi[d] = std::numeric_limits<double>::lowest();
+            }
+            for (size_t d = dims; d < MAX_DIMS; ++d) {
+                n.lo[d] = std::numeric_limits<double>::lowest();
+                n.hi[d] = std::numeric_limits<double>::max();
+            }
+            n.first = first;
+            n.count = count;
+            n.leaf = leaf;
+            return n;
+        };
+
+        // Hojas
+        std::vector<uint32_t> levelNodes;
+        for (size_t i = 0; i < index->entries.size(); i += FANOUT) {
+            size_t count = std::min(FANOUT, index->entries.size() - i);
+            auto node = makeNode(true, static_cast<uint32_t>(i), static_cast<uint32_t>(count));
+            for (size_t j = i; j < i + count; ++j) {
+                const MBR& m = index->entries[j].component->getMBR();
+                for (size_t d = 0; d < dims; ++d) {
+                    node.lo[d] = std::min(node.lo[d], lowOf(m, d));
+                    node.hi[d] = std::max(node.hi[d], highOf(m, d));
+                }
+            }
+            levelNodes.push_back(static_cast<uint32_t>(index->nodes.size()));
+            index->nodes.push_back(node);
+        }
+
+        // Niveles internos: los hijos de cada nodo son contiguos en nodes
+        while (levelNodes.size() > 1) {
+            std::vector<uint32_t> parents;
+            for (size_t i = 0; i < levelNodes.size(); i += FANOUT) {
+                size_t count = std::min(FANOUT, levelNodes.size() - i);
+                auto node = makeNode(false, levelNodes[i], static_cast<uint32_t>(count));
+                for (size_t j = i; j < i + count; ++j) {
+                    const auto& child = index->nodes[levelNodes[j]];
+                    for (size_t d = 0; d < MAX_DIMS; ++d) {
+                        node.lo[d] = std::min(node.lo[d], child.lo[d]);
+                        node.hi[d] = std::max(node.hi[d], child.hi[d]);
+                    }
+                }
+                parents.push_back(static_cast<uint32_t>(index->nodes.size()));
+                index->nodes.push_back(node);
+            }
+            levelNodes.swap(parents);
+        }
+
+        return index;
+    }
+
+    static bool nodeIntersects(const typename LevelIndex::Node& n, const MBR& box, size_t dims) {
+        for (size_t d = 0; d < dims; ++d) {
+            if (n.hi[d] < lowOf(box, d) || n.lo[d] > highOf(box, d)) return false;
+        }
+        return true;
+    }
+
+    static double nodeMinDist2(const typename LevelIndex::Node& n, const Point& p, size_t dims) {
+        double dist = 0.0;
+        for (size_t d = 0; d < dims; ++d) {
+            double v = p[d];
+            double delta = v < n.lo[d] ? n.lo[d] - v : (v > n.hi[d] ? v - n.hi[d] : 0.0);
+            dist += delta * delta;
+        }
+        return dist;
+    }
+
+    static double mbrMinDist2(const MBR& m, const Point& p) {
+        double dist = 0.0;
+        for (size_t d = 0; d < m.dimensions(); ++d) {
+            double v = p[d];
+            double lo = lowOf(m, d), hi = highOf(m, d);
+            double delta = v < lo ? lo - v : (v > hi ? v - hi : 0.0);
+            dist += delta * delta;
+        }
+        return dist;
+    }
+
+    static void searchLevel(const LevelIndex& index, const MBR& box, std::vector<Entry>& out) {
+        if (index.nodes.empty()) return;
+        std::vector<uint32_t> stack{static_cast<uint32_t>(index.nodes.size() - 1)};
+        while (!stack.empty()) {
+            const auto& node = index.nodes[stack.back()];
+            stack.pop_back();
+            if (!nodeIntersects(node, box, index.dims)) continue;
+            if (node.leaf) {
+                for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                    if (index.entries[i].component->getMBR().intersects(box)) {
+                        out.push_back(index.entries[i]);
+                    }
+                }
+            } else {
+                for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                    stack.push_back(i);
+                }
+            }
+        }
+    }
+
+public:
+    ComponentIndex() = default;
+
+    /**
+     * @brief Nueva versión con componentes añadidos y eliminados
+     * Solo se reconstruyen los niveles tocados por la edición.
+     */
+    std::shared_ptr<const ComponentIndex> apply(const std::vector<Entry>& added,
+                                                const std::vector<ComponentPtr>& removed) const {
+        auto next = std::make_shared<ComponentIndex>(*this);
+
+        std::map<size_t, std::vector<Entry>> touched;
+        for (const auto& e : added) touched[e.component->getLevel()];
+        for (const auto& c : removed) touched[c->getLevel()];
+
+        for (auto& [lvl, entries] : touched) {
+            auto it = levels.find(lvl);
+            if (it != levels.end()) {
+                for (const auto& e : it->second->entries) {
+                    if (std::find(removed.begin(), removed.end(), e.component) == removed.end()) {
+                        entries.push_back(e);
+                    }
+                }
+            }
+            for (const auto& e : added) {
+                if (e.component->getLevel() == lvl) entries.push_back(e);
+            }
+
+            if (entries.empty()) {
+                next->levels.erase(lvl);
+            } else {
+                next->levels[lvl] = buildLevel(std::move(entries));
+            }
+        }
+
+        next->totalEntries = 0;
+        for (const auto& [lvl, index] : next->levels) next->totalEntries += index->entries.size();
+        return next;
+    }
+
+    /**
+     * @brief Componentes cuyo MBR intersecta box, del más reciente al más antiguo
+     */
+    std::vector<ComponentPtr> search(const MBR& box) const {
+        std::vector<Entry> found;
+        for (const auto& [lvl, index] : levels) {
+            searchLevel(*index, box, found);
+        }
+        std::sort(found.begin(), found.end(),
+                  [](const Entry& a, const Entry& b) { return a.sequence > b.sequence; });
+
+        std::vector<ComponentPtr> out;
+        out.reserve(found.size());
+        for (auto& e : found) out.push_back(std::move(e.component));
+        return out;
+    }
+
+    /**
+     * @brief Componentes de un nivel que solapan box (selección de compactación)
+     */
+    std::vector<ComponentPtr> overlappingInLevel(size_t level, const MBR& box) const {
+        std::vector<Entry> found;
+        auto it = levels.find(level);
+        if (it != levels.end()) searchLevel(*it->second, box, found);
+
+        std::vector<ComponentPtr> out;
+        out.reserve(found.size());
+        for (auto& e : found) out.push_back(std::move(e.component));
+        return out;
+    }
+
+    /**
+     * @brief Componentes ordenados por distancia mínima de su MBR a p (kNN)
+     * Recorrido best-first sobre todos los niveles; devuelve pares
+     * (distancia², componente) hasta maxDistance² o todos si es infinita.
+     */
+    std::vector<std::pair<double, ComponentPtr>> byDistance(
+        const Point& p, double maxDistance = std::numeric_limits<double>::infinity()) const {
+
+        struct Item {
+            double dist;
+            const LevelIndex* index;
+            uint32_t id;
+            bool isEntry;
+            bool operator>(const Item& o) const { return dist > o.dist; }
+        };
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+        double limit = maxDistance * maxDistance;
+
+        for (const auto& [lvl, index] : levels) {
+            if (index->nodes.empty()) continue;
+            uint32_t root = static_cast<uint32_t>(index->nodes.size() - 1);
+            heap.push({nodeMinDist2(index->nodes[root], p, index->dims), index.get(), root, false});
+        }
+
+        std::vector<std::pair<double, ComponentPtr>> out;
+        while (!heap.empty()) {
+            Item item = heap.top();
+            heap.pop();
+            if (item.dist > limit) break;
+
+            if (item.isEntry) {
+                out.emplace_back(item.dist, item.index->entries[item.id].component);
+                continue;
+            }
+            const auto& node = item.index->nodes[item.id];
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                if (node.leaf) {
+                    heap.push({mbrMinDist2(item.index->entries[i].component->getMBR(), p),
+                               item.index, i, true});
+                } else {
+                    heap.push({nodeMinDist2(item.index->nodes[i], p, item.index->dims),
+                               item.index, i, false});
+                }
+            }
+        }
+        return out;
+    }
+
+    size_t size() const { return totalEntries; }
+    size_t levelCount() const { return levels.size(); }
+};
+
+} // namespace lsm
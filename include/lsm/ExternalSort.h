@@ -0,0 +1,462 @@
+#pragma once
+
+#include "LSMComponent.h"
+#include "../spatial/SpatialComparators.h"
+#include "../spatial/MBR.h"
+#include <vector>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <queue>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <cstdint>
+#include <type_traits>
+#include <random>
+
+namespace lsm {
+
+using namespace spatial;
+
+/**
+ * @brief Lector por bloques de un CSV de puntos (x,y[,...],data)
+ * Permite alimentar el ordenamiento externo sin cargar el fichero completo.
+ */
+template<typename T>
+class CSVChunkReader {
+private:
+    std::ifstream in;
+    std::string path;
+    size_t dimensions;
+    size_t lineNo;
+
+public:
+    CSVChunkReader(const std::string& filepath, size_t dims = 2)
+        : in(filepath), path(filepath), dimensions(dims), lineNo(0) {
+        if (!in) {
+            throw std::runtime_error("Cannot open dataset: " + filepath);
+        }
+    }
+
+    /**
+     * @brief Lee hasta maxRecords registros en chunk
+     * @return false cuando no quedan registros
+     */
+    bool operator()(std::vector<SpatialRecord<T>>& chunk, size_t maxRecords) {
+        chunk.clear();
+        std::string line;
+        std::vector<double> values;
+
+        while (chunk.size() < maxRecords && std::getline(in, line)) {
+            ++lineNo;
+            if (line.empty() || line[0] == '#') continue;
+
+            values.clear();
+            std::stringstream ss(line);
+            std::string field;
+            while (std::getline(ss, field, ',')) {
+                try {
+                    values.push_back(std::stod(field));
+                } catch (const std::exception&) {
+                    throw std::runtime_error("Invalid number at " + path + ":" +
+                                             std::to_string(lineNo));
+                }
+            }
+
+            if (values.size() < dimensions) {
+                throw std::runtime_error("Too few columns at " + path + ":" +
+                                         std::to_string(lineNo));
+            }
+
+            std::vector<double> coords(values.begin(), values.begin() + dimensions);
+            T data = values.size() > dimensions ? static_cast<T>(values[dimensions]) : T();
+            chunk.emplace_back(Point(coords), data, false);
+        }
+
+        return !chunk.empty();
+    }
+};
+
+/**
+ * @brief Ordenamiento externo por curva de Hilbert para bulk-loading
+ * Pipeline: lectura por bloques → runs ordenados en paralelo por clave
+ * Hilbert → spill a ficheros temporales → merge k-way → componentes
+ * empaquetados. Permite cargar datasets mayores que la RAM.
+ */
+template<typename T>
+class ExternalHilbertSorter {
+public:
+    struct Options {
+        size_t memoryBudgetBytes;     // Memoria para runs y buffers de merge
+        size_t tempSpaceBudgetBytes;  // 0 = sin límite
+        std::string tempDirectory;    // Cada sort() usa un subdirectorio propio
+        size_t sortThreads;
+        size_t dimensions;
+        MBR bounds;                   // Dominio de los datos para la clave Hilbert (ver scanBounds)
+
+        Options() : memoryBudgetBytes(256ull * 1024 * 1024), tempSpaceBudgetBytes(0),
+                    tempDirectory("./data/tmp"),
+                    sortThreads(std::max(1u, std::thread::hardware_concurrency())),
+                    dimensions(2), bounds(Point({0.0, 0.0}), Point({1.0, 1.0})) {}
+    };
+
+    using ChunkReader = std::function<bool(std::vector<SpatialRecord<T>>&, size_t)>;
+    using PackSink = std::function<void(std::vector<SpatialRecord<T>>&&)>;
+
+    struct SortStats {
+        size_t recordsSorted = 0;
+        size_t runsWritten = 0;
+        size_t mergePasses = 0;
+        uint64_t peakTempBytes = 0;
+    };
+
+private:
+    struct KeyedRecord {
+        uint64_t key;
+        SpatialRecord<T> record;
+    };
+
+    /**
+     * @brief Lector secuencial con buffer de un run temporal
+     */
+    class RunReader {
+    private:
+        std::ifstream in;
+        size_t dims;
+        size_t bufferRecords;
+        std::vector<KeyedRecord> buffer;
+        size_t pos;
+
+    public:
+        RunReader(const std::string& path, size_t dimensions, size_t bufRecords)
+            : in(path, std::ios::binary), dims(dimensions),
+              bufferRecords(std::max<size_t>(1, bufRecords)), pos(0) {
+            if (!in) throw std::runtime_error("Cannot open sort run: " + path);
+            refill();
+        }
+
+        bool exhausted() const { return pos >= buffer.size(); }
+        const KeyedRecord& head() const { return buffer[pos]; }
+
+        KeyedRecord take() {
+            KeyedRecord rec = std::move(buffer[pos++]);
+            if (pos >= buffer.size()) refill();
+            return rec;
+        }
+
+    private:
+        void refill() {
+            buffer.clear();
+            pos = 0;
+            KeyedRecord rec;
+            while (buffer.size() < bufferRecords && readRecord(in, dims, rec)) {
+                buffer.push_back(std::move(rec));
+            }
+        }
+    };
+
+    /**
+     * @brief Borra el subdirectorio de trabajo al salir de sort(), también
+     * si una excepción interrumpe el ordenamiento
+     */
+    struct TempDirectoryGuard {
+        std::string path;
+        ~TempDirectoryGuard() {
+            std::error_code ec;
+            std::filesystem::remove_all(path, ec);
+        }
+    };
+
+    Options options;
+    SortStats stats;
+    uint64_t liveTempBytes = 0;
+    size_t nextRunId = 0;
+    std::string workDirectory;
+
+    size_t bytesPerRecord() const {
+        return sizeof(KeyedRecord) + options.dimensions * sizeof(double);
+    }
+
+    size_t serializedBytesPerRecord() const {
+        return sizeof(uint64_t) + options.dimensions * sizeof(double) + sizeof(T) + 1;
+    }
+
+    static void writeRecord(std::ofstream& out, size_t dims, const KeyedRecord& rec) {
+        out.write(reinterpret_cast<const char*>(&rec.key), sizeof(rec.key));
+        for (size_t d = 0; d < dims; ++d) {
+            double c = rec.record.point[d];
+            out.write(reinterpret_cast<const char*>(&c), sizeof(c));
+        }
+        out.write(reinterpret_cast<const char*>(&rec.record.data), sizeof(T));
+        uint8_t tombstone = rec.record.isTombstone ? 1 : 0;
+        out.write(reinterpret_cast<const char*>(&tombstone), sizeof(tombstone));
+    }
+
+    static bool readRecord(std::ifstream& in, size_t dims, KeyedRecord& rec) {
+        if (!in.read(reinterpret_cast<char*>(&rec.key), sizeof(rec.key))) return false;
+        std::vector<double> coords(dims);
+        for (auto& c : coords) {
+            if (!in.read(reinterpret_cast<char*>(&c), sizeof(c))) return false;
+        }
+        T data{};
+        uint8_t tombstone = 0;
+        if (!in.read(reinterpret_cast<char*>(&data), sizeof(T))) return false;
+        if (!in.read(reinterpret_cast<char*>(&tombstone), sizeof(tombstone))) return false;
+        rec.record = SpatialRecord<T>(Point(coords), data, tombstone != 0);
+        return true;
+    }
+
+    /**
+     * @brief Crea un subdirectorio único en tempDirectory
+     * create_directory falla si ya existe, así que dos sorters (o procesos)
+     * con el mismo tempDirectory nunca comparten ficheros de runs.
+     */
+    std::string createWorkDirectory() const {
+        std::error_code ec;
+        std::filesystem::create_directories(options.tempDirectory, ec);
+        if (ec) throw std::runtime_error("Cannot create temp directory: " + options.tempDirectory);
+
+        std::random_device seed;
+        std::mt19937_64 rng((static_cast<uint64_t>(seed()) << 32) ^ seed());
+        for (int attempt = 0; attempt < 100; ++attempt) {
+            auto path = std::filesystem::path(options.tempDirectory) / ("sort_" + std::to_string(rng()));
+            if (std::filesystem::create_directory(path, ec)) return path.string();
+            if (ec) break;
+        }
+        throw std::runtime_error("Cannot create sort directory in " + options.tempDirectory);
+    }
+
+    std::string newRunPath() {
+        return (std::filesystem::path(workDirectory) /
+                ("run_" + std::to_string(nextRunId++) + ".tmp")).string();
+    }
+
+    void chargeTemp(uint64_t bytes) {
+        liveTempBytes += bytes;
+        stats.peakTempBytes = std::max(stats.peakTempBytes, liveTempBytes);
+        if (options.tempSpaceBudgetBytes > 0 && liveTempBytes > options.tempSpaceBudgetBytes) {
+            throw std::runtime_error("External sort exceeded temp space budget");
+        }
+    }
+
+    void releaseTemp(const std::string& path) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        if (!ec) liveTempBytes -= std::min<uint64_t>(liveTempBytes, size);
+        std::filesystem::remove(path, ec);
+    }
+
+    /**
+     * @brief Calcula claves y ordena un run usando sortThreads hilos
+     * Cada hilo ordena una franja; luego se fusionan con inplace_merge.
+     */
+    void parallelSort(std::vector<KeyedRecord>& run) const {
+        size_t threads = std::min(options.sortThreads, std::max<size_t>(1, run.size() / 4096));
+        threads = std::max<size_t>(1, threads);
+
+        auto byKey = [](const KeyedRecord& a, const KeyedRecord& b) { return a.key < b.key; };
+
+        std::vector<size_t> bounds;
+        for (size_t t = 0; t <= threads; ++t) {
+            bounds.push_back(run.size() * t / threads);
+        }
+
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (size_t i = bounds[t]; i < bounds[t + 1]; ++i) {
+                    run[i].key = HilbertCurveComparator::computeHilbertIndex(
+                        run[i].record.point, options.bounds);
+                }
+                std::sort(run.begin() + bounds[t], run.begin() + bounds[t + 1], byKey);
+            });
+        }
+        for (auto& w : workers) w.join();
+
+        // Fusión por pares de las franjas ordenadas
+        for (size_t width = 1; width < threads; width *= 2) {
+            for (size_t t = 0; t + width < threads; t += 2 * width) {
+                size_t hi = std::min(t + 2 * width, threads);
+                std::inplace_merge(run.begin() + bounds[t], run.begin() + bounds[t + width],
+                                   run.begin() + bounds[hi], byKey);
+            }
+        }
+    }
+
+    std::string spillRun(const std::vector<KeyedRecord>& run) {
+        std::string path = newRunPath();
+        std::ofstream out(path, std::ios::binary);
+        if (!out) throw std::runtime_error("Cannot create sort run: " + path);
+        for (const auto& rec : run) {
+            writeRecord(out, options.dimensions, rec);
+        }
+        if (!out) throw std::runtime_error("Failed writing sort run: " + path);
+        chargeTemp(run.size() * serializedBytesPerRecord());
+        ++stats.runsWritten;
+        return path;
+    }
+
+    /**
+     * @brief Merge k-way de runs; emite cada registro a emit()
+     */
+    template<typename Emit>
+    void mergeRuns(const std::vector<std::string>& runs, Emit emit) {
+        size_t bufRecords = options.memoryBudgetBytes / (bytesPerRecord() * (runs.size() + 1));
+
+        std::vector<std::unique_ptr<RunReader>> readers;
+        for (const auto& path : runs) {
+            readers.push_back(std::make_unique<RunReader>(path, options.dimensions, bufRecords));
+        }
+
+        using HeapEntry = std::pair<uint64_t, size_t>;
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+        for (size_t i = 0; i < readers.size(); ++i) {
+            if (!readers[i]->exhausted()) heap.emplace(readers[i]->head().key, i);
+        }
+
+        while (!heap.empty()) {
+            size_t idx = heap.top().second;
+            heap.pop();
+            emit(readers[idx]->take());
+            if (!readers[idx]->exhausted()) heap.emplace(readers[idx]->head().key, idx);
+        }
+
+        readers.clear();
+        for (const auto& path : runs) releaseTemp(path);
+    }
+
+    /**
+     * @brief Número máximo de runs fusionables en una pasada con el presupuesto
+     */
+    size_t maxFanIn() const {
+        const size_t minBufferRecords = 1024;
+        size_t fanIn = options.memoryBudgetBytes / (bytesPerRecord() * minBufferRecords);
+        return std::max<size_t>(2, fanIn > 0 ? fanIn - 1 : 0);
+    }
+
+public:
+    explicit ExternalHilbertSorter(const Options& opts = Options()) : options(opts) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "ExternalHilbertSorter requires a trivially copyable payload");
+    }
+
+    const SortStats& getStats() const { return stats; }
+
+    /**
+     * @brief Primera pasada: MBR de toda la entrada, para Options::bounds
+     * Fuera del dominio la clave Hilbert se satura en el borde y los
+     * registros pierden el orden espacial. Lee por bloques sin retenerlos.
+     */
+    static MBR scanBounds(ChunkReader reader, size_t dimensions, size_t chunkRecords = 65536) {
+        MBR bounds(dimensions);
+        std::vector<SpatialRecord<T>> chunk;
+        while (reader(chunk, std::max<size_t>(1, chunkRecords))) {
+            for (const auto& rec : chunk) bounds.expand(rec.point);
+        }
+        return bounds;
+    }
+
+    /**
+     * @brief Ordena toda la entrada y entrega paquetes de packSize registros
+     * ordenados por clave Hilbert a sink
+     */
+    void sort(ChunkReader reader, size_t packSize, PackSink sink) {
+        stats = SortStats();
+        liveTempBytes = 0;
+        nextRunId = 0;
+        workDirectory = createWorkDirectory();
+        TempDirectoryGuard cleanup{workDirectory};
+
+        // Fase 1: runs ordenados en memoria y volcados a disco. La entrada
+        // llega en bloques de 1/16 del run para que bloque y run juntos no
+        // pasen del presupuesto; reserve solo compromete las páginas usadas.
+        size_t runCapacity = std::max<size_t>(1, options.memoryBudgetBytes / bytesPerRecord());
+        size_t readBatch = std::max<size_t>(1, runCapacity / 16);
+        std::vector<std::string> runs;
+        std::vector<SpatialRecord<T>> chunk;
+        std::vector<KeyedRecord> run;
+        run.reserve(runCapacity);
+
+        bool more = true;
+        while (more) {
+            run.clear();
+            while (run.size() < runCapacity &&
+                   (more = reader(chunk, std::min(readBatch, runCapacity - run.size())))) {
+                for (auto& rec : chunk) {
+                    run.push_back(KeyedRecord{0, std::move(rec)});
+                }
+            }
+            if (run.empty()) break;
+            stats.recordsSorted += run.size();
+            parallelSort(run);
+            runs.push_back(spillRun(run));
+        }
+        run.clear();
+        run.shrink_to_fit();
+        chunk.clear();
+        chunk.shrink_to_fit();
+
+        // Fase 2: pasadas intermedias mientras haya más runs que el fan-in
+        size_t fanIn = maxFanIn();
+        while (runs.size() > fanIn) {
+            ++stats.mergePasses;
+            std::vector<std::string> nextRuns;
+            for (size_t i = 0; i < runs.size(); i += fanIn) {
+                std::vector<std::string> group(runs.begin() + i,
+                                               runs.begin() + std::min(i + fanIn, runs.size()));
+                std::string path = newRunPath();
+                std::ofstream out(path, std::ios::binary);
+                if (!out) throw std::runtime_error("Cannot create sort run: " + path);
+                size_t written = 0;
+                mergeRuns(group, [&](KeyedRecord&& rec) {
+                    writeRecord(out, options.dimensions, rec);
+                    ++written;
+                });
+                chargeTemp(written * serializedBytesPerRecord());
+                nextRuns.push_back(path);
+            }
+            runs.swap(nextRuns);
+        }
+
+        // Fase 3: merge final → paquetes
+        ++stats.mergePasses;
+        std::vector<SpatialRecord<T>> pack;
+        pack.reserve(packSize);
+        mergeRuns(runs, [&](KeyedRecord&& rec) {
+            pack.push_back(std::move(rec.record));
+            if (pack.size() >= packSize) {
+                sink(std::move(pack));
+                pack = std::vector<SpatialRecord<T>>();
+                pack.reserve(packSize);
+            }
+        });
+        if (!pack.empty()) sink(std::move(pack));
+    }
+
+    /**
+     * @brief Ordena la entrada y escribe componentes empaquetados a disco
+     * @return Rutas de los componentes (para LSMTree::ingestComponents)
+     */
+    std::vector<std::string> sortIntoComponents(ChunkReader reader,
+                                                size_t maxComponentSize,
+                                                const std::string& outputDirectory,
+                                                size_t level = 0) {
+        std::vector<std::string> files;
+        sort(reader, maxComponentSize, [&](std::vector<SpatialRecord<T>>&& pack) {
+            LSMComponent<T> component(level, options.dimensions);
+            component.build(std::move(pack));
+            if (!component.saveToDisk(outputDirectory)) {
+                throw std::runtime_error("Failed to write component " + component.getFilename());
+            }
+            files.push_back((std::filesystem::path(outputDirectory) /
+                             component.getFilename()).string());
+        });
+        return files;
+    }
+};
+
+} // namespace lsm
@@ -0,0 +1,634 @@
+#pragma once
+
+#include "../util/ThreadPool.h"
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <condition_variable>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LSM_POSIX_IO 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define LSM_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace lsm {
+
+/**
+ * @brief Buffer alineado para O_DIRECT (dirección y tamaño múltiplos de alignment)
+ */
+class AlignedBuffer {
+private:
+    uint8_t* ptr;
+    size_t length;     // Bytes útiles
+    size_t capacity;   // Bytes reservados (redondeados a alignment)
+
+public:
+    static constexpr size_t ALIGNMENT = 4096;
+
+    static size_t roundUp(size_t n) { return (n + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
+    explicit AlignedBuffer(size_t size = 0) : ptr(nullptr), length(size), capacity(roundUp(size)) {
+        if (capacity < size) throw std::length_error("AlignedBuffer size overflow");
+        if (capacity > 0) {
+            ptr = static_cast<uint8_t*>(::operator new(capacity, std::align_val_t(ALIGNMENT)));
+        }
+    }
+
+    ~AlignedBuffer() {
+        if (ptr) ::operator delete(ptr, std::align_val_t(ALIGNMENT));
+    }
+
+    AlignedBuffer(AlignedBuffer&& other) noexcept
+        : ptr(other.ptr), length(other.length), capacity(other.capacity) {
+        other.ptr = nullptr;
+        other.length = other.capacity = 0;
+    }
+
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+        if (this != &other) {
+            if (ptr) ::operator delete(ptr, std::align_val_t(ALIGNMENT));
+            ptr = other.ptr;
+            length = other.length;
+            capacity = other.capacity;
+            other.ptr = nullptr;
+            other.length = other.capacity = 0;
+        }
+        return *this;
+    }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    uint8_t* data() { return ptr; }
+    const uint8_t* data() const { return ptr; }
+    size_t size() const { return length; }
+    size_t reserved() const { return capacity; }
+    void resize(size_t n) { length = std::min(n, capacity); }
+};
+
+/**
+ * @brief Opciones del backend de E/S
+ */
+struct IOBackendOptions {
+    bool directIO = false;          // O_DIRECT (con fallback si el FS no lo admite)
+    size_t chunkSize = 1 << 20;     // Tamaño de cada petición del lote
+    size_t queueDepth = 32;         // Peticiones en vuelo
+    bool dropCache = true;          // POSIX_FADV_DONTNEED tras la E/S de flush y merge
+};
+
+/**
+ * @brief Backend de E/S intercambiable para ficheros de componentes
+ * Las subclases implementan lotes de lecturas/escrituras posicionales que se
+ * solapan entre sí; la base ofrece lectura y escritura de ficheros completos
+ * troceados en chunks, O_DIRECT opcional y pistas al kernel:
+ * - lectura secuencial (readahead) al cargar un componente completo
+ * - descarte de la page cache tras escribir componentes y tras leer las
+ *   entradas de un merge, para que no expulsen el working set caliente de
+ *   las consultas; las cargas perezosas de las consultas sí se quedan
+ */
+class IOBackend {
+public:
+    using Options = IOBackendOptions;
+
+    struct Request {
+        uint64_t offset = 0;
+        uint8_t* buffer = nullptr;
+        size_t length = 0;
+        int64_t result = 0;             // Bytes transferidos o -errno
+    };
+
+    explicit IOBackend(const Options& opts = Options()) : options(opts) {}
+    virtual ~IOBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Ejecuta un lote de lecturas y espera a que terminen todas
+     */
+    virtual void readBatch(int fd, std::vector<Request>& requests) = 0;
+
+    /**
+     * @brief Ejecuta un lote de escrituras y espera a que terminen todas
+     */
+    virtual void writeBatch(int fd, std::vector<Request>& requests) = 0;
+
+    const Options& getOptions() const { return options; }
+
+    /**
+     * @brief Lee un fichero completo con peticiones solapadas
+     * @param background Lectura de compactación: con dropCache se descarta
+     *        de la page cache al terminar
+     */
+    AlignedBuffer readFile(const std::string& path, bool background = false) {
+#ifdef LSM_POSIX_IO
+        bool direct = false;
+        int fd = openFile(path, O_RDONLY, direct);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat " + path);
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        adviseSequential(fd, size);
+
+        AlignedBuffer buffer(size);
+        auto requests = split(buffer.data(), buffer.reserved(), direct);
+        try {
+            runToCompletion(fd, requests, false, size);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        if (background) dropFromCache(fd, size);
+        ::close(fd);
+        return buffer;
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("Cannot open " + path);
+        std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        AlignedBuffer buffer(data.size());
+        if (!data.empty()) std::memcpy(buffer.data(), data.data(), data.size());
+        return buffer;
+#endif
+    }
+
+    /**
+     * @brief Escribe un fichero completo (crea o trunca) y lo sincroniza
+     * Solo se escriben componentes de flush o merge, que ya están en memoria
+     * como R-tree: con dropCache no se dejan en la page cache.
+     */
+    void writeFile(const std::string& path, const uint8_t* data, size_t size) {
+#ifdef LSM_POSIX_IO
+        bool direct = false;
+        int fd = openFile(path, O_WRONLY | O_CREAT | O_TRUNC, direct);
+
+        // O_DIRECT exige longitudes alineadas: se rellena y luego se trunca
+        AlignedBuffer buffer(size);
+        std::copy(data, data + size, buffer.data());
+        std::fill(buffer.data() + size, buffer.data() + buffer.reserved(), uint8_t(0));
+
+        size_t span = direct ? buffer.reserved() : size;
+        auto requests = split(buffer.data(), span, direct);
+        try {
+            runToCompletion(fd, requests, true, span);
+            if (span != size && ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                throw std::runtime_error("Cannot truncate " + path);
+            }
+            if (::fsync(fd) != 0) throw std::runtime_error("Cannot sync " + path);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        dropFromCache(fd, size);
+        ::close(fd);
+#else
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(data), size);
+        if (!out) throw std::runtime_error("Cannot write " + path);
+#endif
+    }
+
+    /**
+     * @brief Backend por defecto del proceso (io_uring si está disponible)
+     */
+    static std::shared_ptr<IOBackend> getDefault();
+    static void setDefault(std::shared_ptr<IOBackend> backend);
+    static std::shared_ptr<IOBackend> create(const Options& opts = Options());
+
+protected:
+    Options options;
+
+#ifdef LSM_POSIX_IO
+    int openFile(const std::string& path, int flags, bool& direct) const {
+        int fd = -1;
+#ifdef O_DIRECT
+        if (options.directIO) {
+            fd = ::open(path.c_str(), flags | O_DIRECT | O_CLOEXEC, 0644);
+            direct = fd >= 0;
+        }
+#endif
+        if (fd < 0) fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+        if (fd < 0) throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+        return fd;
+    }
+
+    static void adviseSequential(int fd, size_t size) {
+#if defined(POSIX_FADV_SEQUENTIAL)
+        ::posix_fadvise(fd, 0, static_cast<off_t>(size), POSIX_FADV_SEQUENTIAL);
+        ::posix_fadvise(fd, 0, static_cast<off_t>(size), POSIX_FADV_WILLNEED);
+#else
+        (void)fd;
+        (void)size;
+#endif
+    }
+
+    void dropFromCache(int fd, size_t size) const {
+#if defined(POSIX_FADV_DONTNEED)
+        if (options.dropCache) ::posix_fadvise(fd, 0, static_cast<off_t>(size), POSIX_FADV_DONTNEED);
+#else
+        (void)fd;
+        (void)size;
+#endif
+    }
+#endif
+
+    std::vector<Request> split(uint8_t* buffer, size_t span, bool direct) const {
+        size_t chunk = std::max<size_t>(options.chunkSize, AlignedBuffer::ALIGNMENT);
+        if (direct) chunk = AlignedBuffer::roundUp(chunk);
+        std::vector<Request> requests;
+        for (size_t offset = 0; offset < span; offset += chunk) {
+            Request r;
+            r.offset = offset;
+            r.buffer = buffer + offset;
+            r.length = std::min(chunk, span - offset);
+            requests.push_back(r);
+        }
+        return requests;
+    }
+
+    /**
+     * @brief Reintenta transferencias parciales hasta completar el lote
+     * Una lectura corta al final del fichero es normal y se acepta.
+     */
+    void runToCompletion(int fd, std::vector<Request>& requests, bool write, size_t fileSize) {
+        while (!requests.empty()) {
+            if (write) writeBatch(fd, requests);
+            else readBatch(fd, requests);
+
+            std::vector<Request> pending;
+            for (const auto& r : requests) {
+                if (r.result < 0) {
+                    throw std::runtime_error(std::string("I/O error: ") +
+                                             std::strerror(static_cast<int>(-r.result)));
+                }
+                size_t done = static_cast<size_t>(r.result);
+                if (done >= r.length) continue;
+                if (!write && (done == 0 || r.offset + done >= fileSize)) continue;  // EOF
+                Request rest;
+                rest.offset = r.offset + done;
+                rest.buffer = r.buffer + done;
+                rest.length = r.length - done;
+                pending.push_back(rest);
+            }
+            requests.swap(pending);
+        }
+    }
+};
+
+/**
+ * @brief Fallback portable: pread/pwrite repartidos en un pool de hilos
+ */
+class ThreadPoolIOBackend : public IOBackend {
+private:
+    std::shared_ptr<util::ThreadPool> pool;
+
+    template<typename Op>
+    void run(std::vector<Request>& requests, Op op) {
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t done = 0;
+
+        // El llamador ejecuta la primera petición; el resto va al pool
+        for (size_t i = 1; i < requests.size(); ++i) {
+            pool->submit([&, i]() {
+                op(requests[i]);
+                std::lock_guard<std::mutex> lock(mutex);
+                if (++done == requests.size()) finished.notify_one();
+            });
+        }
+        if (!requests.empty()) {
+            op(requests[0]);
+            std::lock_guard<std::mutex> lock(mutex);
+            ++done;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&]() { return done == requests.size(); });
+    }
+
+public:
+    explicit ThreadPoolIOBackend(const Options& opts = Options(),
+                                 std::shared_ptr<util::ThreadPool> threads = nullptr)
+        : IOBackend(opts),
+          pool(threads ? std::move(threads)
+                       : std::make_shared<util::ThreadPool>(std::max<size_t>(1, opts.queueDepth / 4))) {}
+
+    const char* name() const override { return "threadpool"; }
+
+    void readBatch(int fd, std::vector<Request>& requests) override {
+#ifdef LSM_POSIX_IO
+        run(requests, [fd](Request& r) {
+            ssize_t n = ::pread(fd, r.buffer, r.length, static_cast<off_t>(r.offset));
+            r.result = n < 0 ? -errno : n;
+        });
+#else
+        (void)fd;
+        (void)requests;
+        throw std::runtime_error("Positional I/O is not available on this platform");
+#endif
+    }
+
+    void writeBatch(int fd, std::vector<Request>& requests) override {
+#ifdef LSM_POSIX_IO
+        run(requests, [fd](Request& r) {
+            ssize_t n = ::pwrite(fd, r.buffer, r.length, static_cast<off_t>(r.offset));
+            r.result = n < 0 ? -errno : n;
+        });
+#else
+        (void)fd;
+        (void)requests;
+        throw std::runtime_error("Positional I/O is not available on this platform");
+#endif
+    }
+};
+
+#ifdef LSM_HAVE_IO_URING
+/**
+ * @brief Backend io_uring (syscalls directas, sin liburing)
+ * Cada lote toma un anillo libre del pool del backend (o crea uno), así que
+ * los lotes de hilos distintos no se serializan; dentro de un lote hasta
+ * queueDepth peticiones están en vuelo a la vez.
+ */
+class IOUringBackend : public IOBackend {
+private:
+    /**
+     * @brief Un anillo mapeado (SQ, CQ y SQEs); lo usa un solo hilo a la vez
+     */
+    class Ring {
+    private:
+        int ringFd;
+        void* sqRing;
+        void* cqRing;
+        size_t sqRingSize;
+        size_t cqRingSize;
+        io_uring_sqe* sqes;
+        size_t sqesSize;
+        unsigned* sqHead;
+        unsigned* sqTail;
+        unsigned* sqMask;
+        unsigned* sqArray;
+        unsigned* cqHead;
+        unsigned* cqTail;
+        unsigned* cqMask;
+        io_uring_cqe* cqes;
+        unsigned entries;
+
+        void release() {
+            if (sqes) ::munmap(sqes, sqesSize);
+            if (cqRing && cqRing != sqRing) ::munmap(cqRing, cqRingSize);
+            if (sqRing) ::munmap(sqRing, sqRingSize);
+            if (ringFd >= 0) ::close(ringFd);
+        }
+
+    public:
+        explicit Ring(unsigned depth)
+            : ringFd(-1), sqRing(nullptr), cqRing(nullptr), sqRingSize(0),
+              cqRingSize(0), sqes(nullptr), sqesSize(0), entries(0) {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            ringFd = static_cast<int>(::syscall(__NR_io_uring_setup, depth, &params));
+            if (ringFd < 0) throw std::runtime_error("io_uring is not available");
+
+            sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+            sqRing = ::mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ringFd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED) {
+                sqRing = nullptr;
+                release();
+                throw std::runtime_error("io_uring: cannot map SQ ring");
+            }
+            cqRing = single ? sqRing
+                            : ::mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                     ringFd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) {
+                cqRing = nullptr;
+                release();
+                throw std::runtime_error("io_uring: cannot map CQ ring");
+            }
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            void* sq = ::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              ringFd, IORING_OFF_SQES);
+            if (sq == MAP_FAILED) {
+                release();
+                throw std::runtime_error("io_uring: cannot map SQEs");
+            }
+            sqes = static_cast<io_uring_sqe*>(sq);
+
+            auto* s = static_cast<uint8_t*>(sqRing);
+            auto* c = static_cast<uint8_t*>(cqRing);
+            sqHead = reinterpret_cast<unsigned*>(s + params.sq_off.head);
+            sqTail = reinterpret_cast<unsigned*>(s + params.sq_off.tail);
+            sqMask = reinterpret_cast<unsigned*>(s + params.sq_off.ring_mask);
+            sqArray = reinterpret_cast<unsigned*>(s + params.sq_off.array);
+            cqHead = reinterpret_cast<unsigned*>(c + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(c + params.cq_off.tail);
+            cqMask = reinterpret_cast<unsigned*>(c + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(c + params.cq_off.cqes);
+            entries = params.sq_entries;
+        }
+
+        ~Ring() { release(); }
+
+        Ring(const Ring&) = delete;
+        Ring& operator=(const Ring&) = delete;
+
+        /**
+         * @brief ¿Soporta el kernel IORING_OP_READ/WRITE?
+         * Los kernels 5.1-5.5 crean el anillo pero esas operaciones devuelven
+         * -EINVAL; tampoco conocen IORING_REGISTER_PROBE, así que un fallo del
+         * probe equivale a no soportarlas.
+         */
+        bool supportsReadWrite() const {
+            constexpr unsigned maxOps = 256;
+            std::vector<uint8_t> storage(sizeof(io_uring_probe) + maxOps * sizeof(io_uring_probe_op), 0);
+            auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+            if (::syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, maxOps) < 0) {
+                return false;
+            }
+            auto supported = [probe](unsigned op) {
+                return op < probe->ops_len && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+            };
+            return supported(IORING_OP_READ) && supported(IORING_OP_WRITE);
+        }
+
+        void submitAndWait(int fd, std::vector<Request>& requests, uint8_t opcode) {
+            for (size_t base = 0; base < requests.size(); base += entries) {
+                size_t wave = std::min<size_t>(entries, requests.size() - base);
+
+                unsigned tail = *sqTail;
+                for (size_t i = 0; i < wave; ++i) {
+                    Request& r = requests[base + i];
+                    unsigned index = tail & *sqMask;
+                    io_uring_sqe* sqe = &sqes[index];
+                    std::memset(sqe, 0, sizeof(*sqe));
+                    sqe->opcode = opcode;
+                    sqe->fd = fd;
+                    sqe->off = r.offset;
+                    sqe->addr = reinterpret_cast<uint64_t>(r.buffer);
+                    sqe->len = static_cast<uint32_t>(r.length);
+                    sqe->user_data = base + i;
+                    sqArray[index] = index;
+                    ++tail;
+                }
+                __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+                size_t completed = 0;
+                size_t toSubmit = wave;
+                while (completed < wave) {
+                    long ret = ::syscall(__NR_io_uring_enter, ringFd, toSubmit, 1,
+                                         IORING_ENTER_GETEVENTS, nullptr, 0);
+                    if (ret < 0) {
+                        if (errno == EINTR) continue;
+                        throw std::runtime_error(std::string("io_uring_enter: ") + std::strerror(errno));
+                    }
+                    toSubmit -= std::min<size_t>(toSubmit, static_cast<size_t>(ret));
+
+                    unsigned head = *cqHead;
+                    unsigned cqTailNow = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+                    for (; head != cqTailNow; ++head) {
+                        const io_uring_cqe& cqe = cqes[head & *cqMask];
+                        requests[cqe.user_data].result = cqe.res;
+                        ++completed;
+                    }
+                    __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+                }
+            }
+        }
+    };
+
+    unsigned depth;
+    std::vector<std::unique_ptr<Ring>> idleRings;
+    size_t liveRings;
+    std::mutex poolMutex;
+    std::condition_variable ringReleased;
+
+    /**
+     * @brief Toma un anillo libre o crea otro
+     * Si el kernel no deja crear más (RLIMIT_MEMLOCK), espera a uno libre.
+     */
+    std::unique_ptr<Ring> acquireRing() {
+        std::unique_lock<std::mutex> lock(poolMutex);
+        if (idleRings.empty()) {
+            ++liveRings;
+            lock.unlock();
+            try {
+                return std::make_unique<Ring>(depth);
+            } catch (const std::runtime_error&) {
+                lock.lock();
+                if (--liveRings == 0) throw;
+            }
+            ringReleased.wait(lock, [this]() { return !idleRings.empty(); });
+        }
+        auto ring = std::move(idleRings.back());
+        idleRings.pop_back();
+        return ring;
+    }
+
+    void releaseRing(std::unique_ptr<Ring> ring) {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            if (ring) {
+                idleRings.push_back(std::move(ring));
+            } else {
+                --liveRings;
+            }
+        }
+        ringReleased.notify_one();
+    }
+
+    void submitAndWait(int fd, std::vector<Request>& requests, uint8_t opcode) {
+        auto ring = acquireRing();
+        try {
+            ring->submitAndWait(fd, requests, opcode);
+        } catch (...) {
+            // Tras un error el anillo puede tener peticiones a medias: se descarta
+            ring.reset();
+            releaseRing(nullptr);
+            throw;
+        }
+        releaseRing(std::move(ring));
+    }
+
+public:
+    explicit IOUringBackend(const Options& opts = Options())
+        : IOBackend(opts), depth(static_cast<unsigned>(std::max<size_t>(1, opts.queueDepth))),
+          liveRings(1) {
+        auto ring = std::make_unique<Ring>(depth);
+        if (!ring->supportsReadWrite()) {
+            throw std::runtime_error("io_uring: IORING_OP_READ/WRITE not supported");
+        }
+        idleRings.push_back(std::move(ring));
+    }
+
+    const char* name() const override { return "io_uring"; }
+
+    void readBatch(int fd, std::vector<Request>& requests) override {
+        submitAndWait(fd, requests, IORING_OP_READ);
+    }
+
+    void writeBatch(int fd, std::vector<Request>& requests) override {
+        submitAndWait(fd, requests, IORING_OP_WRITE);
+    }
+};
+#endif
+
+inline std::shared_ptr<IOBackend> IOBackend::create(const Options& opts) {
+#ifdef LSM_HAVE_IO_URING
+    try {
+        return std::make_shared<IOUringBackend>(opts);
+    } catch (const std::runtime_error&) {
+        // Kernel antiguo, sin READ/WRITE o io_uring deshabilitado: usar el pool
+    }
+#endif
+    return std::make_shared<ThreadPoolIOBackend>(opts);
+}
+
+namespace detail {
+inline std::mutex& defaultIOBackendMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+inline std::shared_ptr<IOBackend>& defaultIOBackendSlot() {
+    static std::shared_ptr<IOBackend> backend;
+    return backend;
+}
+} // namespace detail
+
+inline std::shared_ptr<IOBackend> IOBackend::getDefault() {
+    std::lock_guard<std::mutex> lock(detail::defaultIOBackendMutex());
+    auto& slot = detail::defaultIOBackendSlot();
+    if (!slot) slot = create();
+    return slot;
+}
+
+inline void IOBackend::setDefault(std::shared_ptr<IOBackend> backend) {
+    std::lock_guard<std::mutex> lock(detail::defaultIOBackendMutex());
+    detail::defaultIOBackendSlot() = std::move(backend);
+}
+
+} // namespace lsm
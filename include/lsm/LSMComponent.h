@@ -4,16 +4,38 @@
 #include "../spatial/MBR.h"
 #include "../spatial/Point.h"
 #include "../spatial/SpatialComparators.h"
+#include "BlockEncoding.h"
+#include "IOBackend.h"
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include <string>
 #include <fstream>
+#include <cstring>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
 
 namespace lsm {
 
 using namespace spatial;
 
+/**
+ * @brief Traza de la búsqueda en un componente (EXPLAIN ANALYZE)
+ */
+struct ComponentSearchTrace {
+    RTreeSearchTrace rtree;
+    bool loadedFromDisk = false;   // Apertura perezosa en esta búsqueda (miss)
+    uint64_t bytesRead = 0;
+};
+
 /**
  * @brief Componente de disco del LSM-tree
  * Contiene un R-tree local y su MBR total para filtrado
@@ -22,44 +44,141 @@ using namespace spatial;
 template<typename T>
 class LSMComponent {
 private:
-    RTree<T> rtree;
+    mutable RTree<T> rtree;            // Se materializa en el primer acceso si es perezoso
     MBR totalMBR;
     size_t level;
     uint64_t timestamp;
     std::string filename;
     size_t recordCount;
+    mutable std::atomic<size_t> tombstoneCount{0};  // Se conoce al construir o cargar
+    BlockEncodingOptions encoding;
+    uint64_t minSequence;
+    uint64_t maxSequence;
+    std::string sourcePath;            // Fichero del que cargar (apertura perezosa)
+    std::shared_ptr<IOBackend> io;     // nullptr = IOBackend::getDefault()
+    mutable std::atomic<bool> loaded;
+    mutable std::mutex loadMutex;
+    mutable std::atomic<uint64_t> diskBytes{0};  // Tamaño del fichero (0 = desconocido)
+    
+    /**
+     * @brief Carga el R-tree desde sourcePath si aún no está en memoria
+     * @return Bytes leídos de disco (0 si ya estaba cargado)
+     */
+    static size_t countTombstones(const std::vector<SpatialRecord<T>>& records) {
+        return static_cast<size_t>(std::count_if(records.begin(), records.end(),
+            [](const SpatialRecord<T>& r) { return r.isTombstone; }));
+    }
+    
+    uint64_t ensureLoaded() const {
+        if (loaded.load(std::memory_order_acquire)) return 0;
+        std::lock_guard<std::mutex> lock(loadMutex);
+        if (loaded.load(std::memory_order_relaxed)) return 0;
+        
+        FileHeader header;
+        std::vector<SpatialRecord<T>> records;
+        if (!readFile(backend(), sourcePath, header, records, false)) {
+            throw std::runtime_error("Cannot open component file: " + sourcePath);
+        }
+        tombstoneCount.store(countTombstones(records), std::memory_order_relaxed);
+        rtree = RTree<T>(header.dims);
+        rtree.build(std::move(records));
+        diskBytes.store(header.fileBytes, std::memory_order_relaxed);
+        loaded.store(true, std::memory_order_release);
+        return header.fileBytes;
+    }
     
 public:
     LSMComponent(size_t lvl = 0, size_t dims = 2) 
         : rtree(dims), totalMBR(dims), level(lvl), 
-          timestamp(0), recordCount(0) {
+          timestamp(0), recordCount(0), minSequence(0), maxSequence(0), loaded(true) {
         // Generar nombre único basado en timestamp
         auto now = std::chrono::system_clock::now();
         auto duration = now.time_since_epoch();
         timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-        filename = "component_L" + std::to_string(level) + "_" + std::to_string(timestamp) + ".dat";
+        // El contador evita colisiones entre componentes creados en el mismo ms
+        static std::atomic<uint64_t> sequence{0};
+        filename = "component_L" + std::to_string(level) + "_" + std::to_string(timestamp) +
+                   "_" + std::to_string(sequence.fetch_add(1)) + ".dat";
+    }
+    
+    /**
+     * @brief Componente conocido solo por sus metadatos (recuperación)
+     * MBR, nivel y tamaño vienen del MANIFEST; el fichero se lee en la
+     * primera búsqueda.
+     */
+    static std::shared_ptr<LSMComponent> openLazy(const std::string& filepath, size_t lvl,
+                                                  const MBR& mbr, size_t count,
+                                                  uint64_t minSeq, uint64_t maxSeq) {
+        auto component = std::make_shared<LSMComponent>(lvl, mbr.dimensions());
+        component->totalMBR = mbr;
+        component->recordCount = count;
+        component->minSequence = minSeq;
+        component->maxSequence = maxSeq;
+        component->filename = std::filesystem::path(filepath).filename().string();
+        component->sourcePath = filepath;
+        component->loaded.store(false, std::memory_order_release);
+        return component;
     }
     
     /**
      * @brief Construye el componente desde registros ordenados
      */
     void build(std::vector<SpatialRecord<T>> records) {
-        // TODO: Construir componente LSM
-        // 1. Actualizar recordCount
-        // 2. Construir R-tree usando rtree.build()
-        // 3. Actualizar totalMBR desde rtree.getTotalMBR()
-        recordCount = 0;
+        recordCount = records.size();
+        tombstoneCount.store(countTombstones(records), std::memory_order_relaxed);
+        rtree.build(std::move(records));
+        totalMBR = rtree.getTotalMBR();
     }
     
     /**
      * @brief Búsqueda por rango espacial
      * Primero filtra por MBR, luego busca en R-tree
      */
-    std::vector<SpatialRecord<T>> rangeSearch(const MBR& queryBox) const {
-        // TODO: Implementar range search con filtrado MBR
-        // 1. Verificar totalMBR.intersects(queryBox) - si no, retornar vacío
-        // 2. Si intersecta, buscar en rtree.rangeSearch(queryBox)
-        return {};
+    std::vector<SpatialRecord<T>> rangeSearch(const MBR& queryBox,
+                                              ComponentSearchTrace* trace = nullptr) const {
+        if (!totalMBR.intersects(queryBox)) {
+            return {};
+        }
+        uint64_t bytesRead = ensureLoaded();
+        if (trace) {
+            trace->loadedFromDisk = bytesRead > 0;
+            trace->bytesRead += bytesRead;
+        }
+        return rtree.rangeSearch(queryBox, trace ? &trace->rtree : nullptr);
+    }
+    
+    /**
+     * @brief Búsqueda por rango incremental: el consumidor decide cuándo parar
+     * Carga el componente si es perezoso; el iterador es válido mientras
+     * el componente viva.
+     */
+    RTreeRangeIterator<T> rangeIterator(
+        const MBR& queryBox,
+        std::function<bool(const RTreeNode<T>&)> prune = nullptr) const {
+        if (!totalMBR.intersects(queryBox)) {
+            return RTreeRangeIterator<T>();
+        }
+        ensureLoaded();
+        return rtree.rangeIterator(queryBox, std::move(prune));
+    }
+    
+    /**
+     * @brief Zone map del componente (el de la raíz de su R-tree)
+     * @return false si es perezoso y aún no se ha leído: no se sabe
+     */
+    bool getValueBounds(double& min, double& max) const {
+        return isLoaded() && rtree.valueBounds(min, max);
+    }
+    
+    /**
+     * @brief Búsqueda por rango con agregados por nodo (RTree::aggregateSearch)
+     */
+    template<typename CanCredit, typename Credit, typename Visit>
+    void aggregateSearch(const MBR& queryBox, CanCredit&& canCredit, Credit&& credit,
+                         Visit&& visit) const {
+        if (!totalMBR.intersects(queryBox)) return;
+        ensureLoaded();
+        rtree.aggregateSearch(queryBox, canCredit, credit, visit);
     }
     
     // Getters
@@ -68,27 +187,299 @@ public:
     uint64_t getTimestamp() const { return timestamp; }
     size_t size() const { return recordCount; }
     const std::string& getFilename() const { return filename; }
+    size_t dimensions() const { return totalMBR.dimensions(); }
+    uint64_t getMinSequence() const { return minSequence; }
+    uint64_t getMaxSequence() const { return maxSequence; }
+    bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief Tombstones del componente (0 si es perezoso y aún no se ha leído)
+     */
+    size_t getTombstoneCount() const { return tombstoneCount.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Instantes mínimo y máximo de sus registros
+     * La coordenada timeDimension del MBR total (en el MANIFEST, así que se
+     * conoce sin cargar el componente).
+     * @return false si el componente no tiene esa dimensión o está vacío
+     */
+    bool getTimeRange(size_t timeDimension, double& minTime, double& maxTime) const {
+        if (timeDimension >= totalMBR.dimensions() || recordCount == 0) return false;
+        minTime = totalMBR.getLower()[timeDimension];
+        maxTime = totalMBR.getUpper()[timeDimension];
+        return minTime <= maxTime;
+    }
+    
+    /**
+     * @brief Bytes del fichero del componente (0 si no se ha persistido)
+     * En componentes perezosos aún no cargados consulta el sistema de ficheros.
+     */
+    uint64_t getDiskBytes() const {
+        uint64_t bytes = diskBytes.load(std::memory_order_relaxed);
+        if (bytes == 0 && !sourcePath.empty()) {
+            std::error_code ec;
+            auto size = std::filesystem::file_size(sourcePath, ec);
+            if (!ec) {
+                bytes = static_cast<uint64_t>(size);
+                diskBytes.store(bytes, std::memory_order_relaxed);
+            }
+        }
+        return bytes;
+    }
+    
+    /**
+     * @brief Rango de secuencias de escritura que contiene el componente
+     */
+    void setSequenceRange(uint64_t minSeq, uint64_t maxSeq) {
+        minSequence = minSeq;
+        maxSequence = maxSeq;
+    }
+    
+    /**
+     * @brief Nombre de fichero asignado por el MANIFEST
+     */
+    void setFilename(const std::string& name) { filename = name; }
+    
+    /**
+     * @brief Configura la codificación de bloques usada por saveToDisk()
+     */
+    void setBlockEncoding(const BlockEncodingOptions& opts) { encoding = opts; }
+    const BlockEncodingOptions& getBlockEncoding() const { return encoding; }
+    
+    /**
+     * @brief Backend de E/S para leer y escribir este componente
+     */
+    void setIOBackend(std::shared_ptr<IOBackend> backend) { io = std::move(backend); }
+    
+    /**
+     * @brief Reubica el componente en otro nivel (ingesta directa)
+     */
+    void setLevel(size_t lvl) { level = lvl; }
+    
+    /**
+     * @brief Obtiene todos los registros del componente (incluye tombstones)
+     */
+    std::vector<SpatialRecord<T>> getAllRecords() const {
+        ensureLoaded();
+        return rtree.getAllRecords();
+    }
+    
+    /**
+     * @brief Registros para un merge
+     * Un componente perezoso se lee del fichero sin quedarse cargado ni en
+     * la page cache: sus entradas se borran en cuanto termina el merge.
+     */
+    std::vector<SpatialRecord<T>> scanRecords() const {
+        if (loaded.load(std::memory_order_acquire)) return rtree.getAllRecords();
+        
+        FileHeader header;
+        std::vector<SpatialRecord<T>> records;
+        if (!readFile(backend(), sourcePath, header, records, true)) {
+            throw std::runtime_error("Cannot open component file: " + sourcePath);
+        }
+        return records;
+    }
     
     /**
      * @brief Serializa el componente a disco
+     * Formato: magic, version, metadata, MBR total y bloques codificados
+     * (ver BlockEncoder): registros ordenados por clave Hilbert relativa al
+     * MBR total, coordenadas cuantizadas y compresión opcional.
+     * El R-tree se reconstruye con bulk-loading al cargar.
+     * La imagen se compone en memoria y se escribe con el IOBackend en
+     * peticiones solapadas, sin pasar por la page cache si es O_DIRECT.
      */
     bool saveToDisk(const std::string& directory = "./data") const {
-        // TODO: Implementar serialización
-        // 1. Crear archivo binario en directory/filename
-        // 2. Escribir metadata (level, timestamp, recordCount)
-        // 3. Serializar R-tree y MBR
-        return false;
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "LSMComponent::saveToDisk requires a trivially copyable payload");
+        
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec) return false;
+        
+        std::vector<uint8_t> out;
+        auto records = getAllRecords();
+        const uint64_t dims = totalMBR.dimensions();
+        
+        writePod(out, FILE_MAGIC);
+        writePod(out, FILE_VERSION);
+        writePod(out, static_cast<uint64_t>(level));
+        writePod(out, timestamp);
+        writePod(out, static_cast<uint64_t>(records.size()));
+        writePod(out, dims);
+        
+        for (uint64_t d = 0; d < dims; ++d) writePod(out, totalMBR.getLower()[d]);
+        for (uint64_t d = 0; d < dims; ++d) writePod(out, totalMBR.getUpper()[d]);
+        
+        // Ordenar por clave de curva para que los deltas sean pequeños
+        std::vector<uint64_t> keys(records.size());
+        for (size_t i = 0; i < records.size(); ++i) {
+            keys[i] = HilbertCurveComparator::computeHilbertIndex(records[i].point, totalMBR);
+        }
+        std::vector<size_t> order(records.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+        
+        const size_t perBlock = std::max<size_t>(1, encoding.recordsPerBlock);
+        const uint64_t blockCount = (records.size() + perBlock - 1) / perBlock;
+        writePod(out, blockCount);
+        
+        std::vector<SpatialRecord<T>> blockRecords;
+        std::vector<uint64_t> blockKeys;
+        for (size_t start = 0; start < order.size(); start += perBlock) {
+            size_t end = std::min(start + perBlock, order.size());
+            blockRecords.clear();
+            blockKeys.clear();
+            for (size_t i = start; i < end; ++i) {
+                blockRecords.push_back(records[order[i]]);
+                blockKeys.push_back(keys[order[i]]);
+            }
+            auto block = BlockEncoder<T>::encode(blockRecords, blockKeys, totalMBR, encoding);
+            out.insert(out.end(), block.begin(), block.end());
+        }
+        
+        try {
+            backend()->writeFile((std::filesystem::path(directory) / filename).string(),
+                                 out.data(), out.size());
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+        diskBytes.store(out.size(), std::memory_order_relaxed);
+        return true;
     }
     
     /**
      * @brief Carga el componente desde disco
      */
     bool loadFromDisk(const std::string& filepath) {
-        // TODO: Implementar deserialización
-        // 1. Abrir archivo binario
-        // 2. Leer metadata
-        // 3. Deserializar R-tree y MBR
-        return false;
+        FileHeader header;
+        std::vector<SpatialRecord<T>> records;
+        if (!readFile(backend(), filepath, header, records, false)) return false;
+        
+        level = header.level;
+        timestamp = header.timestamp;
+        filename = std::filesystem::path(filepath).filename().string();
+        sourcePath = filepath;
+        rtree = RTree<T>(header.dims);
+        build(std::move(records));
+        diskBytes.store(header.fileBytes, std::memory_order_relaxed);
+        loaded.store(true, std::memory_order_release);
+        return true;
+    }
+    
+private:
+    struct FileHeader {
+        uint64_t level = 0;
+        uint64_t timestamp = 0;
+        uint64_t dims = 0;
+        uint64_t fileBytes = 0;
+    };
+    
+    /**
+     * @brief Lee cabecera y registros de un fichero de componente
+     * @param background Lectura de compactación (ver IOBackend::readFile)
+     */
+    static bool readFile(const std::shared_ptr<IOBackend>& io, const std::string& filepath,
+                         FileHeader& header, std::vector<SpatialRecord<T>>& records,
+                         bool background) {
+        AlignedBuffer file;
+        try {
+            file = io->readFile(filepath, background);
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+        const uint8_t* in = file.data();
+        const uint8_t* end = in + file.size();
+        
+        uint32_t magic = 0, version = 0;
+        uint64_t lvl = 0, ts = 0, count = 0, dims = 0;
+        if (!readPod(in, end, magic) || magic != FILE_MAGIC) return false;
+        if (!readPod(in, end, version) || (version != FILE_VERSION && version != 1)) return false;
+        if (!readPod(in, end, lvl) || !readPod(in, end, ts) ||
+            !readPod(in, end, count) || !readPod(in, end, dims) || dims == 0) {
+            return false;
+        }
+        // Cabecera corrupta: dims y count no pueden pedir más de lo que
+        // queda en el fichero (MBR de 2·dims doubles; cada registro ocupa al
+        // menos su payload y un byte, o las coordenadas en el formato plano)
+        if (dims > static_cast<uint64_t>(end - in) / (2 * sizeof(double))) return false;
+        
+        // El MBR almacenado es la referencia de cuantización de los bloques
+        std::vector<double> lower(dims), upper(dims);
+        for (auto& b : lower) {
+            if (!readPod(in, end, b)) return false;
+        }
+        for (auto& b : upper) {
+            if (!readPod(in, end, b)) return false;
+        }
+        MBR storedMBR{Point(lower), Point(upper)};
+        
+        uint64_t minRecordBytes = 1 + sizeof(T) + (version == 1 ? dims * sizeof(double) : 0);
+        if (count > static_cast<uint64_t>(end - in) / minRecordBytes) return false;
+        
+        records.clear();
+        records.reserve(count);
+        
+        if (version == 1) {
+            // Formato original: registros planos sin codificar
+            std::vector<double> coords(dims);
+            for (uint64_t i = 0; i < count; ++i) {
+                for (auto& c : coords) {
+                    if (!readPod(in, end, c)) return false;
+                }
+                T data{};
+                uint8_t tombstone = 0;
+                if (!readPod(in, end, data) || !readPod(in, end, tombstone)) return false;
+                records.emplace_back(Point(coords), data, tombstone != 0);
+            }
+        } else {
+            uint64_t blockCount = 0;
+            if (!readPod(in, end, blockCount)) return false;
+            
+            try {
+                size_t offset = 0;
+                const size_t bodySize = static_cast<size_t>(end - in);
+                for (uint64_t b = 0; b < blockCount; ++b) {
+                    size_t consumed = 0;
+                    auto raw = BlockEncoder<T>::unwrap(in + offset, bodySize - offset, consumed);
+                    offset += consumed;
+                    auto decoded = BlockEncoder<T>::decode(raw, storedMBR);
+                    records.insert(records.end(), std::make_move_iterator(decoded.begin()),
+                                   std::make_move_iterator(decoded.end()));
+                }
+            } catch (const std::runtime_error&) {
+                return false;
+            }
+            if (records.size() != count) return false;
+        }
+        
+        header.level = lvl;
+        header.timestamp = ts;
+        header.dims = dims;
+        header.fileBytes = file.size();
+        return true;
+    }
+    
+    static constexpr uint32_t FILE_MAGIC = 0x4C534D43;  // "LSMC"
+    static constexpr uint32_t FILE_VERSION = 2;
+    
+    std::shared_ptr<IOBackend> backend() const {
+        return io ? io : IOBackend::getDefault();
+    }
+    
+    template<typename V>
+    static void writePod(std::vector<uint8_t>& out, const V& value) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(V));
+    }
+    
+    template<typename V>
+    static bool readPod(const uint8_t*& in, const uint8_t* end, V& value) {
+        if (static_cast<size_t>(end - in) < sizeof(V)) return false;
+        std::memcpy(&value, in, sizeof(V));
+        in += sizeof(V);
+        return true;
     }
 };
 
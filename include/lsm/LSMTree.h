@@ -3,11 +3,36 @@
 #include "../spatial/RTree.h"
 #include "../spatial/SpatialComparators.h"
 #include "LSMComponent.h"
+#include "WriteController.h"
+#include "WriteBufferManager.h"
+#include "ResultCache.h"
+#include "ComponentIndex.h"
+#include "Manifest.h"
+#include "LevelStats.h"
+#include "ValueRange.h"
+#include "MergePolicy.h"
+#include "PartitioningStrategy.h"
+#include "../util/Arena.h"
+#include "../util/ThreadPool.h"
+#include "../util/Histogram.h"
 #include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <memory>
 #include <vector>
 #include <algorithm>
+#include <string>
+#include <stdexcept>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 
 namespace lsm {
 
@@ -21,68 +46,213 @@ using namespace spatial;
 template<typename T>
 class MemTable {
 private:
-    std::map<Point, SpatialRecord<T>, SimpleComparator> data;
-    size_t maxSize;
+    using Entry = std::pair<const Point, SpatialRecord<T>>;
+    using RecordMap = std::map<Point, SpatialRecord<T>, SimpleComparator, util::ArenaAllocator<Entry>>;
+    
+    // Nodos del map en un arena propio; se libera completo en clear() tras el flush
+    util::Arena arena;
+    RecordMap data;
+    const size_t maxSize;
     size_t currentSize;
+    size_t heapBytes = 0;       // Coordenadas de claves y registros (fuera del arena)
+    size_t tombstones = 0;
     mutable std::mutex mutex;
+    std::function<void(int64_t)> memoryObserver;  // Notifica deltas de memoria
+    
+    // Sobrecarga de un nodo de std::map (color + 3 punteros) con alineación
+    static constexpr size_t MAP_NODE_OVERHEAD = 4 * sizeof(void*);
+    
+    /**
+     * @brief Estimación de una entrada nueva (nodo del map, clave Point,
+     * SpatialRecord y los dos vectores de coordenadas en el heap)
+     * Solo decide si cabe antes de insertarla; el uso contabilizado es el
+     * real (ver upsertLocked).
+     */
+    static size_t entryBytes(const SpatialRecord<T>& record) {
+        return MAP_NODE_OVERHEAD + sizeof(Point) + sizeof(SpatialRecord<T>) +
+               2 * record.point.getCoords().capacity() * sizeof(double);
+    }
+    
+    static size_t coordBytes(const Point& point) {
+        return point.getCoords().capacity() * sizeof(double);
+    }
+    
+    /**
+     * @brief Inserta o reemplaza un registro contabilizando memoria. Requiere mutex.
+     * El uso es el real: bloques reservados por el arena (nodos del map) más
+     * las coordenadas de claves y registros en el heap.
+     */
+    bool upsertLocked(const SpatialRecord<T>& record, int64_t& delta, bool force = false) {
+        auto it = data.find(record.point);
+        if (!force && it == data.end() && currentSize + entryBytes(record) > maxSize) {
+            return false;
+        }
+        
+        if (it != data.end()) {
+            tombstones -= it->second.isTombstone ? 1 : 0;
+            heapBytes -= coordBytes(it->second.point);
+            it->second = record;
+            heapBytes += coordBytes(it->second.point);
+        } else {
+            it = data.emplace(record.point, record).first;
+            heapBytes += coordBytes(it->first) + coordBytes(it->second.point);
+        }
+        tombstones += record.isTombstone ? 1 : 0;
+        
+        size_t usage = arena.memoryUsage() + heapBytes;
+        delta = static_cast<int64_t>(usage) - static_cast<int64_t>(currentSize);
+        currentSize = usage;
+        return true;
+    }
+    
+    void notify(int64_t delta) {
+        if (delta != 0 && memoryObserver) {
+            memoryObserver(delta);
+        }
+    }
     
 public:
     explicit MemTable(size_t maxSizeBytes = 64 * 1024 * 1024) // 64MB por defecto
-        : maxSize(maxSizeBytes), currentSize(0) {}
+        : arena(), data(SimpleComparator(), util::ArenaAllocator<Entry>(&arena)),
+          maxSize(maxSizeBytes), currentSize(0) {}
+    
+    /**
+     * @brief Registra el observador de memoria (WriteBufferManager)
+     */
+    void setMemoryObserver(std::function<void(int64_t)> observer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        memoryObserver = std::move(observer);
+    }
     
     /**
      * @brief Inserta un registro en la MemTable
      */
     bool insert(const SpatialRecord<T>& record) {
-        // TODO: Implementar inserción
-        // 1. Estimar tamaño del record
-        // 2. Verificar si cabe (currentSize + recordSize <= maxSize)
-        // 3. Si no cabe, retornar false
-        // 4. Insertar en map data[record.point] = record
-        // 5. Actualizar currentSize
-        return false;
+        int64_t delta = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!upsertLocked(record, delta)) {
+                return false;
+            }
+        }
+        notify(delta);
+        return true;
+    }
+    
+    /**
+     * @brief Inserta registros desde records[begin] bajo un único lock
+     * @return Índice del primer registro que no cabe (records.size() si caben todos)
+     */
+    size_t insertBatch(const std::vector<SpatialRecord<T>>& records, size_t begin) {
+        int64_t total = 0;
+        size_t next = begin;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (; next < records.size(); ++next) {
+                int64_t delta = 0;
+                if (!upsertLocked(records[next], delta)) break;
+                total += delta;
+            }
+        }
+        notify(total);
+        return next;
+    }
+    
+    /**
+     * @brief Copia encima los registros de una MemTable más reciente
+     * Ignora el límite de tamaño: deshace el cambio de MemTable de un
+     * flush fallido sin perder escrituras.
+     */
+    void absorb(const MemTable& newer) {
+        auto records = newer.getAllRecords();
+        int64_t total = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& record : records) {
+                int64_t delta = 0;
+                upsertLocked(record, delta, true);
+                total += delta;
+            }
+        }
+        notify(total);
     }
     
     /**
      * @brief Marca un registro como borrado (Tombstone)
      */
     bool remove(const Point& point) {
-        // TODO: Implementar remoción
-        // Crear SpatialRecord con isTombstone = true
-        // Insertar en map
-        return false;
+        SpatialRecord<T> tombstone(point, T(), true);
+        return insert(tombstone);
     }
     
     /**
      * @brief Búsqueda en MemTable
+     * Incluye tombstones: en la reconciliación ocultan las versiones más
+     * antiguas de los componentes de disco.
      */
     std::vector<SpatialRecord<T>> rangeSearch(const MBR& queryBox) const {
-        // TODO: Implementar búsqueda en MemTable
-        // Iterar sobre data, agregar records que queryBox.contains(point) y no son tombstone
-        return {};
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<SpatialRecord<T>> results;
+        for (const auto& [point, record] : data) {
+            if (queryBox.contains(point)) results.push_back(record);
+        }
+        return results;
+    }
+    
+    /**
+     * @brief Verifica si algún registro (incluidos tombstones) cae en el MBR
+     */
+    bool overlaps(const MBR& box) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& [point, record] : data) {
+            if (box.contains(point)) return true;
+        }
+        return false;
     }
     
     /**
      * @brief Obtiene todos los registros (para flush)
      */
     std::vector<SpatialRecord<T>> getAllRecords() const {
-        // TODO: Copiar todos los records de data a un vector
-        return {};
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<SpatialRecord<T>> records;
+        records.reserve(data.size());
+        for (const auto& [point, record] : data) {
+            records.push_back(record);
+        }
+        return records;
     }
     
     /**
      * @brief Limpia la MemTable después del flush
      */
     void clear() {
-        // TODO: Limpiar data y resetear currentSize
+        int64_t freed = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            data.clear();
+            arena.reset();
+            freed = -static_cast<int64_t>(currentSize);
+            currentSize = 0;
+            heapBytes = 0;
+            tombstones = 0;
+        }
+        notify(freed);
     }
     
     // Getters
+    size_t memoryUsage() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return currentSize;
+    }
+    
     bool isFull() const {
         std::lock_guard<std::mutex> lock(mutex);
         return currentSize >= maxSize;
     }
     
+    size_t capacity() const { return maxSize; }
+    
     size_t size() const {
         std::lock_guard<std::mutex> lock(mutex);
         return data.size();
@@ -92,30 +262,97 @@ public:
         std::lock_guard<std::mutex> lock(mutex);
         return data.empty();
     }
+    
+    size_t tombstoneCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return tombstones;
+    }
 };
 
 /**
  * @brief Métricas de rendimiento del LSM-tree
  */
 struct LSMMetrics {
-    uint64_t writeAmplification;   // Write Amplification (WA)
-    uint64_t readAmplification;    // Read Amplification (RA) - componentes escaneados
-    uint64_t totalWrites;
-    uint64_t totalReads;
-    uint64_t totalMerges;
-    double avgQueryLatency;        // Latencia promedio de queries (ms)
+    // Contadores repartidos por hilo: se pueden actualizar sin treeMutex
+    util::ShardedCounter writeAmplification;   // Write Amplification (WA)
+    util::ShardedCounter readAmplification;    // Read Amplification (RA) - componentes escaneados
+    util::ShardedCounter totalWrites;
+    util::ShardedCounter totalReads;
+    util::ShardedCounter totalMerges;
     
-    LSMMetrics() : writeAmplification(0), readAmplification(0),
-                   totalWrites(0), totalReads(0), totalMerges(0),
-                   avgQueryLatency(0.0) {}
+    // Latencias (ns): la media oculta los picos de p99 que provoca el flush
+    util::LatencyHistogram insertLatency;
+    util::LatencyHistogram pointQueryLatency;
+    util::LatencyHistogram rangeQueryLatency;
+    util::LatencyHistogram flushLatency;
+    util::LatencyHistogram mergeLatency;
+    
+    /**
+     * @brief Latencia promedio de consultas por rango (ms)
+     */
+    double avgQueryLatency() const {
+        return rangeQueryLatency.snapshot().mean() / 1e6;
+    }
     
     void reset() {
-        writeAmplification = 0;
-        readAmplification = 0;
-        totalWrites = 0;
-        totalReads = 0;
-        totalMerges = 0;
-        avgQueryLatency = 0.0;
+        writeAmplification.reset();
+        readAmplification.reset();
+        totalWrites.reset();
+        totalReads.reset();
+        totalMerges.reset();
+        insertLatency.reset();
+        pointQueryLatency.reset();
+        rangeQueryLatency.reset();
+        flushLatency.reset();
+        mergeLatency.reset();
+    }
+};
+
+/**
+ * @brief Plan/traza de una consulta por rango (EXPLAIN [ANALYZE])
+ */
+struct QueryTrace {
+    struct Component {
+        std::string filename;
+        size_t level = 0;
+        MBR mbr;
+        size_t records = 0;
+        bool pruned = false;           // Descartado por el filtrado MBR
+        ComponentSearchTrace search;   // Solo con ANALYZE
+        size_t matches = 0;
+        double millis = 0.0;
+    };
+    
+    MBR queryBox;
+    bool analyzed = false;
+    size_t memTableRecords = 0;
+    size_t memTableMatches = 0;
+    double memTableMillis = 0.0;
+    std::vector<Component> components;  // Del más reciente al más antiguo
+    size_t candidateRows = 0;           // Antes de reconciliar
+    size_t resultRows = 0;
+    double reconcileMillis = 0.0;
+    double totalMillis = 0.0;
+};
+
+/**
+ * @brief Resultado de una agregación por rejilla (GROUP BY grid)
+ */
+struct GridAggregate {
+    struct Cell {
+        uint64_t count = 0;
+        double sum = 0.0;
+    };
+    
+    double cellSize = 0.0;
+    std::map<std::pair<int64_t, int64_t>, Cell> cells;   // (columna, fila) → agregados
+    size_t nodesCredited = 0;       // Nodos sumados con su agregado, sin visitar sus hojas
+    size_t nodesPruned = 0;         // Nodos descartados por su zone map
+    uint64_t recordsCredited = 0;
+    uint64_t recordsVisited = 0;    // Registros leídos uno a uno (MemTable y hojas)
+    
+    static int64_t cellOf(double coordinate, double size) {
+        return static_cast<int64_t>(std::floor(coordinate / size));
     }
 };
 
@@ -126,30 +363,524 @@ struct LSMMetrics {
 template<typename T>
 class LSMTree {
 private:
-    MemTable<T> memTable;
+    std::shared_ptr<MemTable<T>> memTable;           // Activa: recibe las escrituras
+    std::shared_ptr<MemTable<T>> immutableMemTable;  // En flush: sigue visible para lecturas
+    mutable std::shared_mutex memTableSwitch;        // Escrituras (shared) frente al cambio (unique)
+    std::mutex flushMutex;                           // Un flush a la vez
+    std::function<void(int64_t)> memTableObserver;   // Observador de memoria de las MemTables
     std::vector<std::shared_ptr<LSMComponent<T>>> diskComponents;
     size_t dimensions;
     mutable std::mutex treeMutex;
     LSMMetrics metrics;
+    CompactionStats compactionStats;             // Por nivel: bytes, merges, lecturas
+    WriteController writeController;
+    size_t immutableMemTables;  // MemTables en proceso de flush
+    std::shared_ptr<WriteBufferManager> writeBufferManager;
+    WriteBufferManager::BufferId bufferId;
+    std::shared_ptr<util::ThreadPool> queryPool;  // Compartido entre tablas
+    std::unique_ptr<SpatialResultCache<T>> resultCache;  // Opcional
+    size_t maxQueryParallelism;                   // Tareas por consulta (incluye al llamador)
+    std::shared_ptr<const ComponentIndex<T>> componentIndex;  // Versión actual; se reemplaza entera
+    std::shared_ptr<Manifest> manifest;           // Opcional: metadatos persistentes
+    std::string manifestTable;
+    std::atomic<uint64_t> lastSequence;           // Secuencia de la última escritura
+    uint64_t flushedSequence;                     // Última secuencia ya en disco
+    std::shared_ptr<MergePolicy<T>> mergePolicy;  // nullptr = sin compactación
+    std::shared_ptr<PartitioningStrategy<T>> outputPartitioner;  // Opcional: parte la salida
+    size_t maxOutputComponentSize;
+    std::mutex compactionMutex;                   // Un merge a la vez
+    bool compactionEnabled;                       // Hay política instalada (bajo treeMutex)
     
     // Parámetros de configuración
     size_t maxComponentsBeforeMerge;
     
+    /**
+     * @brief Tamaño aproximado de un registro (para token bucket y deuda)
+     */
+    uint64_t estimateRecordBytes() const {
+        return sizeof(SpatialRecord<T>) + dimensions * sizeof(double);
+    }
+    
+    /**
+     * @brief Bytes de un componente: los del fichero, o estimados si solo está en memoria
+     */
+    uint64_t componentBytes(const LSMComponent<T>& component) const {
+        uint64_t bytes = component.getDiskBytes();
+        return bytes ? bytes : component.size() * estimateRecordBytes();
+    }
+    
+    /**
+     * @brief Estima los bytes pendientes de compactación
+     * Niveles con maxComponentsBeforeMerge o más componentes deben fusionarse
+     * completos. Requiere treeMutex.
+     */
+    uint64_t estimatePendingCompactionBytesLocked() const {
+        std::map<size_t, std::pair<size_t, uint64_t>> perLevel;  // nivel → (componentes, registros)
+        for (const auto& comp : diskComponents) {
+            auto& entry = perLevel[comp->getLevel()];
+            entry.first++;
+            entry.second += comp->size();
+        }
+        
+        uint64_t pendingRecords = 0;
+        for (const auto& [lvl, entry] : perLevel) {
+            if (entry.first >= maxComponentsBeforeMerge) {
+                pendingRecords += entry.second;
+            }
+        }
+        return pendingRecords * estimateRecordBytes();
+    }
+    
+    /**
+     * @brief Estado compartido de una consulta repartida en el pool
+     * Los ayudantes retienen el estado por shared_ptr: si arrancan después
+     * de que el llamador haya terminado, no encuentran trabajo y salen.
+     */
+    struct FanOutState {
+        std::vector<std::shared_ptr<LSMComponent<T>>> components;
+        MBR queryBox;
+        std::vector<std::vector<SpatialRecord<T>>> partial;
+        std::atomic<size_t> next{0};
+        size_t done = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable finished;
+        
+        void work() {
+            const size_t n = components.size();
+            for (size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+                std::vector<SpatialRecord<T>> found;
+                std::exception_ptr failure;
+                try {
+                    found = components[i]->rangeSearch(queryBox);
+                } catch (...) {
+                    failure = std::current_exception();
+                }
+                
+                std::lock_guard<std::mutex> lock(mutex);
+                partial[i] = std::move(found);
+                if (failure && !error) error = failure;
+                if (++done == n) finished.notify_all();
+            }
+        }
+    };
+    
+    /**
+     * @brief Busca en los componentes candidatos, en paralelo si hay pool
+     * Devuelve un vector de resultados por componente, en el mismo orden.
+     */
+    std::vector<std::vector<SpatialRecord<T>>> searchComponents(
+        const std::vector<std::shared_ptr<LSMComponent<T>>>& candidates,
+        const MBR& queryBox) const {
+        
+        if (!queryPool || maxQueryParallelism <= 1 || candidates.size() <= 1) {
+            std::vector<std::vector<SpatialRecord<T>>> partial;
+            partial.reserve(candidates.size());
+            for (const auto& comp : candidates) {
+                partial.push_back(comp->rangeSearch(queryBox));
+            }
+            return partial;
+        }
+        
+        auto state = std::make_shared<FanOutState>();
+        state->components = candidates;
+        state->queryBox = queryBox;
+        state->partial.resize(candidates.size());
+        
+        // El llamador también trabaja: una consulta nunca espera solo al pool
+        size_t helpers = std::min(maxQueryParallelism, candidates.size()) - 1;
+        for (size_t h = 0; h < helpers; ++h) {
+            queryPool->submit([state]() { state->work(); });
+        }
+        state->work();
+        
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&state]() { return state->done == state->components.size(); });
+        if (state->error) std::rethrow_exception(state->error);
+        return std::move(state->partial);
+    }
+    
+    /**
+     * @brief Añade un componente y publica una nueva versión del índice
+     * El índice ordena por la secuencia de escritura más alta del
+     * componente: la salida de un merge conserva la de sus entradas y no
+     * pasa por delante de flushes posteriores. Requiere treeMutex.
+     */
+    void addComponentLocked(const std::shared_ptr<LSMComponent<T>>& component) {
+        diskComponents.push_back(component);
+        componentIndex = componentIndex->apply({{component, component->getMaxSequence()}}, {});
+    }
+    
+    /**
+     * @brief Metadatos del MANIFEST para un componente ya escrito
+     */
+    static ComponentMeta describe(const LSMComponent<T>& component, uint64_t fileNumber) {
+        ComponentMeta meta;
+        meta.fileNumber = fileNumber;
+        meta.level = component.getLevel();
+        meta.mbr = component.getMBR();
+        meta.recordCount = component.size();
+        meta.minSequence = component.getMinSequence();
+        meta.maxSequence = component.getMaxSequence();
+        return meta;
+    }
+    
+    /**
+     * @brief Fusiona inputs en el nivel que indique la política
+     * Las salidas heredan el rango de secuencias de las entradas. Con
+     * MANIFEST, altas y bajas se registran en una sola edición y los
+     * ficheros de entrada se borran después. Requiere compactionMutex.
+     * @return false si la política no produjo salida
+     */
+    bool mergeLocked(const std::vector<std::shared_ptr<LSMComponent<T>>>& inputs) {
+        auto start = std::chrono::steady_clock::now();
+        
+        size_t targetLevel = mergePolicy->outputLevel(inputs);
+        uint64_t bytesRead = 0;
+        uint64_t minSeq = std::numeric_limits<uint64_t>::max(), maxSeq = 0;
+        for (const auto& in : inputs) {
+            bytesRead += componentBytes(*in);
+            minSeq = std::min(minSeq, in->getMinSequence());
+            maxSeq = std::max(maxSeq, in->getMaxSequence());
+        }
+        
+        // Los tombstones solo se purgan si ningún componente más antiguo
+        // fuera del merge solapa las entradas: podría guardar el punto borrado
+        bool purgeTombstones = true;
+        {
+            std::lock_guard<std::mutex> lock(treeMutex);
+            for (const auto& comp : diskComponents) {
+                if (!purgeTombstones) break;
+                if (comp->getMinSequence() > maxSeq ||
+                    std::find(inputs.begin(), inputs.end(), comp) != inputs.end()) continue;
+                for (const auto& in : inputs) {
+                    if (comp->getMBR().intersects(in->getMBR())) {
+                        purgeTombstones = false;
+                        break;
+                    }
+                }
+            }
+        }
+        
+        auto merged = mergePolicy->mergeComponents(inputs, targetLevel, dimensions, purgeTombstones);
+        if (!merged) return false;
+        
+        std::vector<std::shared_ptr<LSMComponent<T>>> outputs;
+        if (outputPartitioner && merged->size() > maxOutputComponentSize) {
+            outputs = outputPartitioner->partition(merged->getAllRecords(), targetLevel,
+                                                   dimensions, maxOutputComponentSize);
+        }
+        // Sin salida si todo eran tombstones purgados: las entradas solo se borran
+        if (outputs.empty() && merged->size() > 0) outputs.push_back(merged);
+        
+        std::vector<VersionEdit> edits;
+        uint64_t recordsWritten = 0;
+        for (auto& out : outputs) {
+            out->setLevel(targetLevel);
+            out->setSequenceRange(minSeq, maxSeq);
+            recordsWritten += out->size();
+            if (manifest) {
+                uint64_t fileNumber = manifest->newFileNumber();
+                out->setFilename(ComponentMeta::fileName(fileNumber));
+                if (!out->saveToDisk(manifest->tableDirectory(manifestTable))) {
+                    throw std::runtime_error("Cannot write component " + out->getFilename());
+                }
+                edits.push_back(VersionEdit::addComponent(manifestTable, describe(*out, fileNumber)));
+            }
+        }
+        std::vector<std::string> obsolete;
+        if (manifest) {
+            for (const auto& in : inputs) {
+                uint64_t fileNumber = 0;
+                if (ComponentMeta::parseFileName(in->getFilename(), fileNumber)) {
+                    edits.push_back(VersionEdit::removeComponent(manifestTable, fileNumber));
+                    obsolete.push_back((std::filesystem::path(manifest->tableDirectory(manifestTable)) /
+                                        in->getFilename()).string());
+                }
+            }
+            manifest->logAndApply(edits);
+        }
+        
+        uint64_t bytesWritten = 0;
+        for (const auto& out : outputs) bytesWritten += componentBytes(*out);
+        
+        {
+            std::lock_guard<std::mutex> lock(treeMutex);
+            diskComponents.erase(
+                std::remove_if(diskComponents.begin(), diskComponents.end(),
+                               [&inputs](const std::shared_ptr<LSMComponent<T>>& c) {
+                                   return std::find(inputs.begin(), inputs.end(), c) != inputs.end();
+                               }),
+                diskComponents.end());
+            std::vector<typename ComponentIndex<T>::Entry> added;
+            for (const auto& out : outputs) {
+                diskComponents.push_back(out);
+                added.push_back({out, out->getMaxSequence()});
+            }
+            componentIndex = componentIndex->apply(added, inputs);
+            metrics.writeAmplification += recordsWritten;
+            refreshWriteControllerLocked();
+        }
+        
+        // Las entradas ya están en memoria (el merge las leyó): las
+        // consultas en curso no vuelven a abrir sus ficheros
+        for (const auto& path : obsolete) {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+        
+        recordCompaction(targetLevel, bytesRead, bytesWritten, std::chrono::steady_clock::now() - start);
+        return true;
+    }
+    
+    /**
+     * @brief Registros de las MemTables en el box: activa y luego inmutable
+     * Debe llamarse antes de tomar el índice de componentes: el flush
+     * publica el componente antes de soltar la MemTable inmutable, así que
+     * cada registro se ve al menos en una de las dos fuentes.
+     */
+    std::vector<SpatialRecord<T>> memTableSearch(const MBR& queryBox) const {
+        std::shared_ptr<MemTable<T>> active, frozen;
+        {
+            std::shared_lock<std::shared_mutex> lock(memTableSwitch);
+            active = memTable;
+            frozen = immutableMemTable;
+        }
+        auto results = active->rangeSearch(queryBox);
+        if (frozen) {
+            auto older = frozen->rangeSearch(queryBox);
+            results.insert(results.end(), std::make_move_iterator(older.begin()),
+                           std::make_move_iterator(older.end()));
+        }
+        return results;
+    }
+    
+    /**
+     * @brief Escribe en la MemTable activa y avanza la secuencia
+     * Con memTableSwitch compartido: el flush no puede congelar la MemTable
+     * entre la escritura y el incremento de lastSequence.
+     * @return false si el registro no cabe
+     */
+    bool writeRecord(const SpatialRecord<T>& record) {
+        std::shared_lock<std::shared_mutex> lock(memTableSwitch);
+        if (!memTable->insert(record)) return false;
+        lastSequence++;
+        return true;
+    }
+    
+    /**
+     * @brief Como writeRecord para records[begin..]
+     * @return Índice del primer registro que no cabe
+     */
+    size_t writeBatch(const std::vector<SpatialRecord<T>>& records, size_t begin) {
+        std::shared_lock<std::shared_mutex> lock(memTableSwitch);
+        size_t next = memTable->insertBatch(records, begin);
+        lastSequence += next - begin;
+        return next;
+    }
+    
+    /**
+     * @brief Aplica fn a la MemTable activa y, si hay flush en curso, a la inmutable
+     */
+    template<typename Fn>
+    void forEachMemTable(Fn fn) const {
+        std::shared_lock<std::shared_mutex> lock(memTableSwitch);
+        fn(*memTable);
+        if (immutableMemTable) fn(*immutableMemTable);
+    }
+    
+    /**
+     * @brief Publica L0, MemTables inmutables y deuda al WriteController
+     * Sin política de compactación nada reduce L0 ni la deuda: solo se
+     * publican las MemTables inmutables, o cada tabla sin merges acabaría
+     * parada para siempre al llegar a l0StopTrigger. Requiere treeMutex.
+     */
+    void refreshWriteControllerLocked() {
+        if (!compactionEnabled) {
+            writeController.update(0, immutableMemTables, 0);
+            return;
+        }
+        size_t l0 = 0;
+        for (const auto& comp : diskComponents) {
+            if (comp->getLevel() == 0) ++l0;
+        }
+        writeController.update(l0, immutableMemTables, estimatePendingCompactionBytesLocked());
+    }
+    
+    /**
+     * @brief Drenaje de una parada de escrituras, ejecutado por el escritor
+     * Primero compacta según la política; si esta no ve nada que fusionar,
+     * fuerza el merge que propone para la deuda. Sin esto una parada sin
+     * plazo (maxStopWait = 0) esperaría a un merge que nadie lanza.
+     * @return false si no quedaba nada que fusionar
+     */
+    bool drainWriteStall() {
+        if (writeController.getState() != WriteController::State::STOPPED) return true;
+        if (compact() > 0) return true;
+        
+        std::lock_guard<std::mutex> guard(compactionMutex);
+        if (!mergePolicy) return false;
+        std::vector<std::shared_ptr<LSMComponent<T>>> components;
+        {
+            std::lock_guard<std::mutex> lock(treeMutex);
+            components = diskComponents;
+        }
+        auto inputs = mergePolicy->selectForcedMerge(components);
+        return !inputs.empty() && mergeLocked(inputs);
+    }
+    
 public:
-    explicit LSMTree(size_t dims = 2, size_t maxComponents = 10)
-        : memTable(), dimensions(dims), maxComponentsBeforeMerge(maxComponents) {}
+    explicit LSMTree(size_t dims = 2, size_t maxComponents = 10,
+                     size_t memTableBytes = 64 * 1024 * 1024)
+        : memTable(std::make_shared<MemTable<T>>(memTableBytes)), dimensions(dims), immutableMemTables(0), bufferId(0),
+          maxQueryParallelism(1), componentIndex(std::make_shared<ComponentIndex<T>>()),
+          lastSequence(0), flushedSequence(0), maxOutputComponentSize(100000),
+          compactionEnabled(false), maxComponentsBeforeMerge(maxComponents) {}
+    
+    ~LSMTree() {
+        detachWriteBufferManager();
+    }
+    
+    LSMTree(const LSMTree&) = delete;
+    LSMTree& operator=(const LSMTree&) = delete;
+    
+    /**
+     * @brief Comparte el presupuesto de memoria global con otras tablas
+     * La MemTable reporta su uso al gestor, que puede forzar su flush.
+     */
+    void attachWriteBufferManager(std::shared_ptr<WriteBufferManager> manager,
+                                  const std::string& name) {
+        detachWriteBufferManager();
+        if (!manager) return;
+        
+        writeBufferManager = manager;
+        bufferId = manager->registerBuffer(name, [this]() { flush(); });
+        
+        // Cargar el uso previo de las MemTables al presupuesto global
+        std::unique_lock<std::shared_mutex> lock(memTableSwitch);
+        memTableObserver = [manager, id = bufferId](int64_t delta) {
+            manager->charge(id, delta);
+        };
+        int64_t usage = static_cast<int64_t>(memTable->memoryUsage());
+        memTable->setMemoryObserver(memTableObserver);
+        if (immutableMemTable) {
+            usage += static_cast<int64_t>(immutableMemTable->memoryUsage());
+            immutableMemTable->setMemoryObserver(memTableObserver);
+        }
+        manager->charge(bufferId, usage);
+    }
+    
+    /**
+     * @brief Persiste los componentes de la tabla en un MANIFEST compartido
+     * Si el MANIFEST ya conoce la tabla, recupera sus componentes desde los
+     * metadatos (nivel, MBR, tamaño) sin abrir ficheros: cada uno se carga
+     * en su primera búsqueda. Debe llamarse antes de escribir.
+     */
+    void attachManifest(std::shared_ptr<Manifest> m, const std::string& table) {
+        manifest = std::move(m);
+        manifestTable = table;
+        if (!manifest) return;
+        
+        auto directory = manifest->tableDirectory(table);
+        std::filesystem::create_directories(directory);
+        
+        auto state = manifest->getTable(table);
+        std::vector<ComponentMeta> metas;
+        for (const auto& [num, meta] : state.components) metas.push_back(meta);
+        std::sort(metas.begin(), metas.end(), [](const ComponentMeta& a, const ComponentMeta& b) {
+            return a.maxSequence < b.maxSequence;
+        });
+        
+        std::lock_guard<std::mutex> lock(treeMutex);
+        for (const auto& meta : metas) {
+            auto path = (std::filesystem::path(directory) / meta.filename()).string();
+            addComponentLocked(LSMComponent<T>::openLazy(path, meta.level, meta.mbr,
+                                                         meta.recordCount, meta.minSequence,
+                                                         meta.maxSequence));
+        }
+        lastSequence = std::max<uint64_t>(lastSequence, state.lastSequence);
+        flushedSequence = std::max(flushedSequence, state.lastSequence);
+        refreshWriteControllerLocked();
+    }
+    
+    void detachWriteBufferManager() {
+        if (!writeBufferManager) return;
+        {
+            std::unique_lock<std::shared_mutex> lock(memTableSwitch);
+            memTableObserver = nullptr;
+            memTable->setMemoryObserver(nullptr);
+            if (immutableMemTable) immutableMemTable->setMemoryObserver(nullptr);
+        }
+        writeBufferManager->unregisterBuffer(bufferId);
+        writeBufferManager.reset();
+        bufferId = 0;
+    }
     
     /**
      * @brief Inserta un registro espacial
      */
     bool insert(const Point& point, const T& data) {
-        // TODO: Implementar inserción en LSM-tree
-        // 1. Crear SpatialRecord
-        // 2. Intentar insertar en memTable
-        // 3. Si memTable.insert() retorna false (llena), ejecutar flush()
-        // 4. Reintentar inserción
-        // 5. Actualizar metrics.totalWrites
-        return false;
+        util::ScopedLatency timer(metrics.insertLatency);
+        
+        // Backpressure: retardo gradual o parada según la deuda de compactación
+        writeController.throttle(estimateRecordBytes(), [this]() { return drainWriteStall(); });
+        
+        SpatialRecord<T> record(point, data, false);
+        bool inserted = writeRecord(record);
+        if (!inserted) {
+            flush();
+            inserted = writeRecord(record);
+        }
+        
+        if (inserted) {
+            // Tras escribir: una consulta que leyó antes de la escritura ya
+            // no puede guardar su resultado con la generación vigente
+            if (resultCache) {
+                resultCache->invalidatePoint(point);
+            }
+            metrics.totalWrites++;
+            if (writeBufferManager && writeBufferManager->shouldFlush()) {
+                writeBufferManager->enforceBudget();
+            }
+        }
+        return inserted;
+    }
+    
+    /**
+     * @brief Inserta un lote de registros (puntos o tombstones) en orden
+     * Backpressure, lock de la MemTable y comprobación del presupuesto
+     * global se pagan una vez por lote y no por registro; si la MemTable se
+     * llena a mitad se hace flush y se continúa. insertLatency solo mide
+     * inserts individuales.
+     * @return Registros escritos: menos que records.size() solo si un
+     *         registro no cabe ni en una MemTable vacía
+     */
+    size_t insertBatch(const std::vector<SpatialRecord<T>>& records) {
+        if (records.empty()) {
+            return 0;
+        }
+        writeController.throttle(records.size() * estimateRecordBytes(),
+                                 [this]() { return drainWriteStall(); });
+        
+        size_t written = 0;
+        while (written < records.size()) {
+            size_t next = writeBatch(records, written);
+            if (next == written) {
+                flush();
+                next = writeBatch(records, written);
+                if (next == written) break;
+            }
+            written = next;
+        }
+        
+        if (resultCache) {
+            for (size_t i = 0; i < written; ++i) resultCache->invalidatePoint(records[i].point);
+        }
+        metrics.totalWrites += written;
+        if (writeBufferManager && writeBufferManager->shouldFlush()) {
+            writeBufferManager->enforceBudget();
+        }
+        return written;
     }
     
     /**
@@ -157,24 +888,227 @@ public:
      * Referencia: Antimatter records del paper
      */
     bool remove(const Point& point) {
-        // TODO: Llamar memTable.remove(point)
-        // Actualizar metrics.totalWrites
-        return false;
+        // Un tombstone ocupa la MemTable igual que un insert
+        writeController.throttle(estimateRecordBytes(), [this]() { return drainWriteStall(); });
+        
+        SpatialRecord<T> tombstone(point, T(), true);
+        bool removed = writeRecord(tombstone);
+        if (!removed) {
+            flush();
+            removed = writeRecord(tombstone);
+        }
+        
+        if (removed) {
+            if (resultCache) {
+                resultCache->invalidatePoint(point);
+            }
+            metrics.totalWrites++;
+            if (writeBufferManager && writeBufferManager->shouldFlush()) {
+                writeBufferManager->enforceBudget();
+            }
+        }
+        return removed;
     }
     
     /**
      * @brief Flush: MemTable → Disco
+     * La MemTable activa se cambia por una vacía bajo memTableSwitch, así
+     * que las escrituras concurrentes siguen en la nueva y no se pierden.
+     * La congelada sigue visible para lecturas hasta que su componente
+     * está publicado.
      * Referencia: Operación Flush del paper
      */
     void flush() {
-        // TODO: Implementar flush
-        // 1. Verificar si memTable está vacía
-        // 2. Obtener records con memTable.getAllRecords()
-        // 3. Crear LSMComponent, llamar component->build(records)
-        // 4. Agregar component a diskComponents
-        // 5. Limpiar memTable con memTable.clear()
-        // 6. Actualizar metrics.writeAmplification
-        // 7. Verificar si necesita merge (diskComponents.size >= maxComponentsBeforeMerge)
+        std::unique_lock<std::mutex> flushLock(flushMutex);
+        
+        std::shared_ptr<MemTable<T>> frozen;
+        uint64_t maxSeq = 0;
+        {
+            std::unique_lock<std::shared_mutex> lock(memTableSwitch);
+            if (memTable->isEmpty()) {
+                return;
+            }
+            frozen = memTable;
+            memTable = std::make_shared<MemTable<T>>(frozen->capacity());
+            memTable->setMemoryObserver(memTableObserver);
+            immutableMemTable = frozen;
+            maxSeq = lastSequence;
+        }
+        util::ScopedLatency timer(metrics.flushLatency);
+        
+        {
+            std::lock_guard<std::mutex> lock(treeMutex);
+            immutableMemTables++;
+            refreshWriteControllerLocked();
+        }
+        
+        auto records = frozen->getAllRecords();
+        auto component = std::make_shared<LSMComponent<T>>(0, dimensions);
+        try {
+            component->build(records);
+            
+            component->setSequenceRange(flushedSequence + 1, maxSeq);
+            if (manifest) {
+                // El componente solo existe una vez escrito y registrado
+                uint64_t fileNumber = manifest->newFileNumber();
+                component->setFilename(ComponentMeta::fileName(fileNumber));
+                if (!component->saveToDisk(manifest->tableDirectory(manifestTable))) {
+                    throw std::runtime_error("Cannot write component " + component->getFilename());
+                }
+                manifest->logAndApply({VersionEdit::addComponent(manifestTable,
+                                                                 describe(*component, fileNumber))});
+            }
+        } catch (...) {
+            // Deshacer el cambio: la congelada vuelve a ser la activa con
+            // las escrituras posteriores encima
+            {
+                std::unique_lock<std::shared_mutex> lock(memTableSwitch);
+                frozen->absorb(*memTable);
+                memTable->clear();
+                memTable = frozen;
+                immutableMemTable.reset();
+            }
+            std::lock_guard<std::mutex> lock(treeMutex);
+            immutableMemTables--;
+            refreshWriteControllerLocked();
+            throw;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(treeMutex);
+            flushedSequence = maxSeq;
+            addComponentLocked(component);
+            immutableMemTables--;
+            metrics.writeAmplification += records.size();
+            refreshWriteControllerLocked();
+        }
+        {
+            std::unique_lock<std::shared_mutex> lock(memTableSwitch);
+            immutableMemTable.reset();
+        }
+        frozen->clear();
+        compactionStats.recordWrite(0, componentBytes(*component));
+        flushLock.unlock();
+        
+        compact();
+    }
+    
+    /**
+     * @brief Configura la compactación
+     * Sin política (por defecto) el árbol nunca fusiona componentes.
+     * @param partitioner Si se indica, la salida de cada merge se parte en
+     * componentes de hasta maxComponentSize registros
+     */
+    void setCompactionPolicy(std::shared_ptr<MergePolicy<T>> policy,
+                             std::shared_ptr<PartitioningStrategy<T>> partitioner = nullptr,
+                             size_t maxComponentSize = 100000) {
+        std::lock_guard<std::mutex> guard(compactionMutex);
+        mergePolicy = std::move(policy);
+        outputPartitioner = std::move(partitioner);
+        maxOutputComponentSize = std::max<size_t>(1, maxComponentSize);
+        
+        std::lock_guard<std::mutex> lock(treeMutex);
+        compactionEnabled = mergePolicy != nullptr;
+        refreshWriteControllerLocked();
+    }
+    
+    /**
+     * @brief Ejecuta merges mientras la política lo pida
+     * Referencia: Merge/Compaction del paper
+     * @return Número de merges realizados
+     */
+    size_t compact() {
+        std::lock_guard<std::mutex> guard(compactionMutex);
+        if (!mergePolicy) return 0;
+        
+        size_t merges = 0;
+        while (true) {
+            std::vector<std::shared_ptr<LSMComponent<T>>> components;
+            {
+                std::lock_guard<std::mutex> lock(treeMutex);
+                components = diskComponents;
+            }
+            if (!mergePolicy->shouldMerge(components)) break;
+            auto inputs = mergePolicy->selectComponentsToMerge(components);
+            if (inputs.empty() || !mergeLocked(inputs)) break;
+            ++merges;
+        }
+        return merges;
+    }
+    
+    /**
+     * @brief Ingesta directa de componentes pre-construidos (ComponentBuilder)
+     * Cada fichero se coloca en el nivel más bajo posible sin quedar por
+     * debajo de un componente solapado (que contendría datos más antiguos
+     * y lo ocultaría). Si la MemTable solapa, se hace flush antes.
+     * @return Número de componentes ingeridos
+     */
+    size_t ingestComponents(const std::vector<std::string>& files) {
+        std::vector<std::shared_ptr<LSMComponent<T>>> loaded;
+        std::map<const LSMComponent<T>*, std::string> sourceFiles;
+        loaded.reserve(files.size());
+        
+        for (const auto& file : files) {
+            auto component = std::make_shared<LSMComponent<T>>(0, dimensions);
+            if (!component->loadFromDisk(file)) {
+                throw std::runtime_error("Cannot ingest component file: " + file);
+            }
+            if (component->dimensions() != dimensions) {
+                throw std::runtime_error("Dimension mismatch in component file: " + file);
+            }
+            loaded.push_back(component);
+            sourceFiles[component.get()] = file;
+        }
+        
+        bool memTableOverlaps = false;
+        for (const auto& component : loaded) {
+            forEachMemTable([&](const MemTable<T>& table) {
+                memTableOverlaps = memTableOverlaps || table.overlaps(component->getMBR());
+            });
+            if (memTableOverlaps) break;
+        }
+        if (memTableOverlaps) {
+            flush();
+        }
+        
+        std::lock_guard<std::mutex> lock(treeMutex);
+        
+        size_t bottomLevel = 0;
+        for (const auto& comp : diskComponents) {
+            bottomLevel = std::max(bottomLevel, comp->getLevel());
+        }
+        
+        for (auto& component : loaded) {
+            size_t targetLevel = bottomLevel;
+            for (const auto& comp : componentIndex->search(component->getMBR())) {
+                targetLevel = std::min(targetLevel,
+                                       comp->getLevel() > 0 ? comp->getLevel() - 1 : 0);
+            }
+            
+            component->setLevel(targetLevel);
+            uint64_t seq = ++lastSequence;
+            component->setSequenceRange(seq, seq);
+            if (manifest) {
+                // Copia al directorio de la tabla con un nombre del MANIFEST
+                uint64_t fileNumber = manifest->newFileNumber();
+                auto target = std::filesystem::path(manifest->tableDirectory(manifestTable)) /
+                              ComponentMeta::fileName(fileNumber);
+                std::filesystem::copy_file(sourceFiles[component.get()], target,
+                                           std::filesystem::copy_options::overwrite_existing);
+                component->setFilename(target.filename().string());
+                manifest->logAndApply({VersionEdit::addComponent(manifestTable,
+                                                                 describe(*component, fileNumber))});
+            }
+            addComponentLocked(component);
+            if (resultCache) {
+                resultCache->invalidateRange(component->getMBR());
+            }
+            metrics.writeAmplification += component->size();
+            compactionStats.recordWrite(targetLevel, componentBytes(*component));
+        }
+        
+        refreshWriteControllerLocked();
+        return loaded.size();
     }
     
     /**
@@ -182,36 +1116,557 @@ public:
      * Referencia: SPATIALSEARCH (Algoritmo 3) del paper
      */
     std::vector<SpatialRecord<T>> spatialRangeQuery(const MBR& queryBox) {
-        // TODO: Implementar SPATIALSEARCH
-        // 1. Buscar en memTable.rangeSearch(queryBox)
-        // 2. Iterar diskComponents, llamar component->rangeSearch(queryBox)
-        // 3. Combinar resultados
-        // 4. Eliminar duplicados/tombstones con removeDuplicatesAndTombstones()
-        // 5. Actualizar métricas (totalReads, readAmplification, avgQueryLatency)
-        return {};
+        util::ScopedLatency timer(metrics.rangeQueryLatency);
+        return cachedRangeQuery(queryBox);
+    }
+    
+    /**
+     * @brief Cursor de una consulta por rango con OFFSET y LIMIT
+     * Reconcilia en streaming: fuentes de la más reciente a la más antigua
+     * (MemTable y luego componentes candidatos) y un registro sale si su
+     * punto no apareció en una fuente más reciente y no es tombstone. Cada
+     * componente se recorre con un RTreeRangeIterator y solo se abre al
+     * agotar el anterior, así que al alcanzar el LIMIT no se visitan más
+     * nodos ni componentes. Un acierto de la caché de resultados se sirve
+     * sin tocar el árbol. El LSM-tree debe sobrevivir al cursor.
+     *
+     * Con un ValueRange solo salen filas cuyo payload lo cumple, y los
+     * nodos o componentes cuyo zone map no lo intersecta se saltan si
+     * ningún componente más antiguo solapa su MBR (si lo hiciera, sus
+     * versiones podrían estar ocultando otras que sí lo cumplen).
+     */
+    class RangeCursor {
+    private:
+        LSMTree* tree;
+        MBR queryBox;
+        std::vector<SpatialRecord<T>> rows;     // MemTable, o resultado ya reconciliado de la caché
+        size_t rowPos = 0;
+        bool reconciled = false;
+        std::vector<std::shared_ptr<LSMComponent<T>>> components;  // Del más reciente al más antiguo
+        size_t opened = 0;
+        RTreeRangeIterator<T> current;
+        std::map<Point, bool, SimpleComparator> seen;
+        ValueRange values;
+        size_t toSkip;
+        size_t remaining;
+        size_t produced = 0;
+        size_t nodesPruned = 0;
+        size_t componentsPruned = 0;
+        bool finished = false;
+        
+        /**
+         * @brief ¿Algún componente más antiguo que el index-ésimo solapa box?
+         */
+        bool olderOverlaps(size_t index, const MBR& box) const {
+            for (size_t j = index + 1; j < components.size(); ++j) {
+                if (components[j]->getMBR().intersects(box)) return true;
+            }
+            return false;
+        }
+        
+        void open(size_t index) {
+            const auto& comp = components[index];
+            if (values.unbounded()) {
+                current = comp->rangeIterator(queryBox);
+            } else {
+                double min = 0.0, max = 0.0;
+                if (comp->getValueBounds(min, max) && !values.overlaps(min, max) &&
+                    !olderOverlaps(index, comp->getMBR())) {
+                    ++componentsPruned;
+                    current = RTreeRangeIterator<T>();
+                    return;
+                }
+                current = comp->rangeIterator(queryBox, [this, index](const RTreeNode<T>& node) {
+                    if (values.overlaps(node.minValue, node.maxValue) || olderOverlaps(index, node.mbr)) {
+                        return false;
+                    }
+                    ++nodesPruned;
+                    return true;
+                });
+            }
+            tree->compactionStats.recordScan(comp->getLevel());
+        }
+        
+        /**
+         * @brief Siguiente candidato sin reconciliar
+         * @param last true si viene de la última fuente: no hace falta recordarlo
+         */
+        const SpatialRecord<T>* nextCandidate(bool& last) {
+            if (rowPos < rows.size()) {
+                last = reconciled || components.empty();
+                return &rows[rowPos++];
+            }
+            for (;;) {
+                if (opened > 0) {
+                    if (const auto* rec = current.next()) {
+                        last = opened == components.size();
+                        return rec;
+                    }
+                }
+                if (opened == components.size()) return nullptr;
+                open(opened++);
+            }
+        }
+        
+        void finish() {
+            if (finished) return;
+            finished = true;
+            tree->metrics.totalReads++;
+            tree->metrics.readAmplification += opened - componentsPruned;
+            tree->compactionStats.recordQuery();
+            current = RTreeRangeIterator<T>();
+            components.clear();
+            seen.clear();
+        }
+        
+    public:
+        RangeCursor(LSMTree* owner, const MBR& box, size_t offset, size_t limit,
+                    const ValueRange& range = ValueRange())
+            : tree(owner), queryBox(box), values(range), toSkip(offset), remaining(limit) {
+            if (limit == 0) {
+                finish();
+                return;
+            }
+            if (tree->resultCache && tree->resultCache->getRows(queryBox, rows)) {
+                reconciled = true;
+                return;
+            }
+            rows = tree->memTableSearch(queryBox);
+            std::shared_ptr<const ComponentIndex<T>> index;
+            {
+                std::lock_guard<std::mutex> lock(tree->treeMutex);
+                index = tree->componentIndex;
+            }
+            components = index->search(queryBox);
+        }
+        
+        RangeCursor(const RangeCursor&) = delete;
+        RangeCursor& operator=(const RangeCursor&) = delete;
+        
+        ~RangeCursor() { finish(); }
+        
+        /**
+         * @brief Hasta maxRows filas reconciliadas; vacío cuando termina
+         */
+        std::vector<SpatialRecord<T>> next(size_t maxRows) {
+            std::vector<SpatialRecord<T>> batch;
+            while (!finished && batch.size() < maxRows) {
+                bool last = false;
+                const SpatialRecord<T>* rec = nextCandidate(last);
+                if (!rec) {
+                    finish();
+                    break;
+                }
+                bool newest = last ? seen.find(rec->point) == seen.end()
+                                   : seen.emplace(rec->point, rec->isTombstone).second;
+                if (!newest || rec->isTombstone) continue;
+                if (!values.contains(payloadValue(rec->data))) continue;
+                if (toSkip > 0) {
+                    --toSkip;
+                    continue;
+                }
+                batch.push_back(*rec);
+                ++produced;
+                if (--remaining == 0) finish();
+            }
+            return batch;
+        }
+        
+        bool done() const { return finished; }
+        size_t rowsProduced() const { return produced; }
+        size_t componentsOpened() const { return opened - componentsPruned; }
+        size_t componentsSkipped() const { return componentsPruned; }
+        size_t nodesSkipped() const { return nodesPruned; }
+    };
+    
+    /**
+     * @brief Abre un cursor sobre queryBox
+     * @param limit Filas máximas tras saltar offset (SIZE_MAX = sin límite)
+     * @param values Predicado conjuntivo sobre el payload
+     */
+    std::unique_ptr<RangeCursor> openRangeCursor(const MBR& queryBox, size_t offset = 0,
+                                                 size_t limit = std::numeric_limits<size_t>::max(),
+                                                 const ValueRange& values = ValueRange()) {
+        return std::make_unique<RangeCursor>(this, queryBox, offset, limit, values);
+    }
+    
+    /**
+     * @brief COUNT y SUM del payload por celda de lado cellSize dentro de queryBox
+     * La agregación baja al recorrido de los R-trees: un nodo contenido en
+     * el box y en una sola celda aporta su liveCount/valueSum sin visitar
+     * sus hojas, si ninguna otra fuente (MemTable u otro componente
+     * candidato) tiene registros en su MBR; si los tiene, alguna versión
+     * podría estar oculta. El resto de registros se reconcilia como en
+     * SPATIALSEARCH, del más reciente al más antiguo. Con un ValueRange,
+     * los nodos aislados cuyo zone map no lo intersecta se descartan y
+     * solo se acreditan los que lo cumplen enteros.
+     */
+    GridAggregate gridAggregate(const MBR& queryBox, double cellSize,
+                                const ValueRange& values = ValueRange()) {
+        if (!(cellSize > 0.0)) {
+            throw std::invalid_argument("Grid cell size must be positive");
+        }
+        util::ScopedLatency timer(metrics.rangeQueryLatency);
+        
+        GridAggregate out;
+        out.cellSize = cellSize;
+        auto cellOf = [cellSize](const Point& p) {
+            return std::make_pair(GridAggregate::cellOf(p[0], cellSize),
+                                  GridAggregate::cellOf(p[1], cellSize));
+        };
+        
+        // MemTables antes que el índice (ver memTableSearch)
+        auto memRows = memTableSearch(queryBox);
+        std::shared_ptr<const ComponentIndex<T>> index;
+        {
+            std::lock_guard<std::mutex> lock(treeMutex);
+            index = componentIndex;
+        }
+        auto candidates = index->search(queryBox);
+        
+        std::map<Point, bool, SimpleComparator> seen;
+        auto accept = [&](const SpatialRecord<T>& rec, bool last) {
+            ++out.recordsVisited;
+            bool newest = last ? seen.find(rec.point) == seen.end()
+                               : seen.emplace(rec.point, rec.isTombstone).second;
+            if (!newest || rec.isTombstone) return;
+            double value = payloadValue(rec.data);
+            if (!values.contains(value)) return;
+            auto& cell = out.cells[cellOf(rec.point)];
+            ++cell.count;
+            cell.sum += value;
+        };
+        
+        // MBR de las filas de MemTable en el box, calculado una vez: un nodo
+        // que no lo toca no puede tener versiones ocultas por la MemTable
+        MBR memTableBox(dimensions);
+        for (const auto& rec : memRows) {
+            accept(rec, candidates.empty());
+            memTableBox.expand(rec.point);
+        }
+        
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            bool last = i + 1 == candidates.size();
+            auto canCredit = [&](const RTreeNode<T>& node) {
+                const MBR& m = node.mbr;
+                if (values.overlaps(node.minValue, node.maxValue)) {
+                    if (!queryBox.contains(m.getLower()) || !queryBox.contains(m.getUpper())) return false;
+                    if (cellOf(m.getLower()) != cellOf(m.getUpper())) return false;
+                    if (!values.covers(node.minValue, node.maxValue)) return false;
+                }
+                for (size_t j = 0; j < candidates.size(); ++j) {
+                    if (j != i && candidates[j]->getMBR().intersects(m)) return false;
+                }
+                return memRows.empty() || !memTableBox.intersects(m);
+            };
+            auto credit = [&](const RTreeNode<T>& node) {
+                if (!values.overlaps(node.minValue, node.maxValue)) {
+                    ++out.nodesPruned;
+                    return;
+                }
+                ++out.nodesCredited;
+                if (node.liveCount == 0) return;
+                auto& cell = out.cells[cellOf(node.mbr.getLower())];
+                cell.count += node.liveCount;
+                cell.sum += node.valueSum;
+                out.recordsCredited += node.liveCount;
+            };
+            candidates[i]->aggregateSearch(queryBox, canCredit, credit,
+                                           [&](const SpatialRecord<T>& rec) { accept(rec, last); });
+            compactionStats.recordScan(candidates[i]->getLevel());
+        }
+        
+        metrics.totalReads++;
+        metrics.readAmplification += candidates.size();
+        compactionStats.recordQuery();
+        return out;
+    }
+    
+    /**
+     * @brief COUNT(*) sobre un rango espacial (cacheable por separado)
+     */
+    size_t spatialCount(const MBR& queryBox) {
+        util::ScopedLatency timer(metrics.rangeQueryLatency);
+        size_t count = 0;
+        if (resultCache && resultCache->getCount(queryBox, count)) {
+            metrics.totalReads++;
+            return count;
+        }
+        
+        uint64_t generation = resultCache ? resultCache->currentGeneration() : 0;
+        count = executeRangeQuery(queryBox).size();
+        if (resultCache) {
+            resultCache->putCount(queryBox, count, generation);
+        }
+        return count;
+    }
+    
+    /**
+     * @brief Activa la caché de resultados con un presupuesto en bytes
+     * @param cellSize Lado de la celda de la rejilla de invalidación
+     */
+    void enableResultCache(size_t budgetBytes, double cellSize = 0.01) {
+        resultCache = std::make_unique<SpatialResultCache<T>>(budgetBytes, cellSize);
+    }
+    
+    void disableResultCache() { resultCache.reset(); }
+    
+    bool hasResultCache() const { return resultCache != nullptr; }
+    
+    typename SpatialResultCache<T>::Stats getResultCacheStats() const {
+        return resultCache ? resultCache->getStats() : typename SpatialResultCache<T>::Stats();
+    }
+    
+private:
+    /**
+     * @brief SPATIALSEARCH pasando por la caché de resultados
+     */
+    std::vector<SpatialRecord<T>> cachedRangeQuery(const MBR& queryBox) {
+        std::vector<SpatialRecord<T>> cached;
+        if (resultCache && resultCache->getRows(queryBox, cached)) {
+            metrics.totalReads++;
+            return cached;
+        }
+        
+        uint64_t generation = resultCache ? resultCache->currentGeneration() : 0;
+        auto results = executeRangeQuery(queryBox);
+        if (resultCache) {
+            resultCache->putRows(queryBox, results, generation);
+        }
+        return results;
+    }
+    
+    /**
+     * @brief SPATIALSEARCH sin caché
+     */
+    std::vector<SpatialRecord<T>> executeRangeQuery(const MBR& queryBox) {
+        // MemTables antes que el índice (ver memTableSearch)
+        auto results = memTableSearch(queryBox);
+        
+        // Filtrado MBR con el índice global; del más reciente al más antiguo
+        std::shared_ptr<const ComponentIndex<T>> index;
+        {
+            std::lock_guard<std::mutex> lock(treeMutex);
+            index = componentIndex;
+        }
+        auto candidates = index->search(queryBox);
+        auto partial = searchComponents(candidates, queryBox);
+        for (auto& part : partial) {
+            results.insert(results.end(), std::make_move_iterator(part.begin()),
+                           std::make_move_iterator(part.end()));
+        }
+        
+        removeDuplicatesAndTombstones(results);
+        
+        metrics.totalReads++;
+        metrics.readAmplification += candidates.size();
+        compactionStats.recordQuery();
+        for (const auto& comp : candidates) {
+            compactionStats.recordScan(comp->getLevel());
+        }
+        
+        return results;
+    }
+    
+public:
+    /**
+     * @brief EXPLAIN [ANALYZE] de una consulta por rango
+     * Sin analyze solo describe el plan: qué componentes pasan el filtrado
+     * MBR. Con analyze la ejecuta en secuencia, sin caché de resultados,
+     * midiendo MemTable, cada componente y la reconciliación.
+     */
+    QueryTrace explainRangeQuery(const MBR& queryBox, bool analyze) {
+        using Clock = std::chrono::steady_clock;
+        auto millisSince = [](Clock::time_point t) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+        };
+        auto start = Clock::now();
+        
+        QueryTrace trace;
+        trace.queryBox = queryBox;
+        trace.analyzed = analyze;
+        forEachMemTable([&trace](const MemTable<T>& table) { trace.memTableRecords += table.size(); });
+        
+        // MemTables antes que el índice (ver memTableSearch)
+        auto t = Clock::now();
+        std::vector<SpatialRecord<T>> results;
+        if (analyze) {
+            results = memTableSearch(queryBox);
+            trace.memTableMillis = millisSince(t);
+            trace.memTableMatches = results.size();
+        }
+        
+        std::vector<std::shared_ptr<LSMComponent<T>>> all;
+        std::shared_ptr<const ComponentIndex<T>> index;
+        {
+            std::lock_guard<std::mutex> lock(treeMutex);
+            all.assign(diskComponents.rbegin(), diskComponents.rend());
+            index = componentIndex;
+        }
+        auto candidates = index->search(queryBox);
+        
+        for (const auto& comp : all) {
+            QueryTrace::Component c;
+            c.filename = comp->getFilename();
+            c.level = comp->getLevel();
+            c.mbr = comp->getMBR();
+            c.records = comp->size();
+            c.pruned = std::find(candidates.begin(), candidates.end(), comp) == candidates.end();
+            trace.components.push_back(c);
+        }
+        if (!analyze) return trace;
+        
+        // Mismo orden que la ejecución normal: candidatos del más reciente al más antiguo
+        for (const auto& comp : candidates) {
+            auto pos = std::find(all.begin(), all.end(), comp) - all.begin();
+            auto& c = trace.components[pos];
+            t = Clock::now();
+            auto part = comp->rangeSearch(queryBox, &c.search);
+            c.millis = millisSince(t);
+            c.matches = part.size();
+            results.insert(results.end(), std::make_move_iterator(part.begin()),
+                           std::make_move_iterator(part.end()));
+        }
+        
+        trace.candidateRows = results.size();
+        t = Clock::now();
+        removeDuplicatesAndTombstones(results);
+        trace.reconcileMillis = millisSince(t);
+        trace.resultRows = results.size();
+        trace.totalMillis = millisSince(start);
+        return trace;
+    }
+    
+    /**
+     * @brief Comparte un pool de consultas entre tablas
+     * @param maxParallelism Tareas máximas por consulta (1 = secuencial)
+     */
+    void setQueryThreadPool(std::shared_ptr<util::ThreadPool> pool, size_t maxParallelism) {
+        queryPool = std::move(pool);
+        maxQueryParallelism = std::max<size_t>(1, maxParallelism);
     }
     
     /**
      * @brief Búsqueda de punto exacto
      */
     std::vector<SpatialRecord<T>> pointQuery(const Point& point) {
-        // TODO: Crear MBR pequeño alrededor del punto
-        // Llamar spatialRangeQuery(queryBox)
-        return {};
+        util::ScopedLatency timer(metrics.pointQueryLatency);
+        return cachedRangeQuery(MBR(point, point));
     }
     
     /**
      * @brief Elimina duplicados y registros tombstone
      */
     void removeDuplicatesAndTombstones(std::vector<SpatialRecord<T>>& results) const {
-        // TODO: Usar map para mantener versión única de cada punto
-        // Filtrar tombstones
-        // Reconstruir vector results sin duplicados ni tombstones
+        // results llega ordenado del más reciente al más antiguo: gana la
+        // primera versión de cada punto, y un tombstone oculta las anteriores
+        std::map<Point, bool, SimpleComparator> seen;
+        std::vector<SpatialRecord<T>> unique;
+        unique.reserve(results.size());
+        
+        for (auto& rec : results) {
+            if (seen.emplace(rec.point, rec.isTombstone).second && !rec.isTombstone) {
+                unique.push_back(std::move(rec));
+            }
+        }
+        
+        results.swap(unique);
     }
     
     // Getters de métricas
     const LSMMetrics& getMetrics() const { return metrics; }
-    void resetMetrics() { metrics.reset(); }
+    WriteController::Stats getWriteStallStats() const { return writeController.getStats(); }
+    WriteControllerOptions getWriteControllerOptions() const { return writeController.getOptions(); }
+    
+    /**
+     * @brief Configura los umbrales de backpressure
+     */
+    void setWriteControllerOptions(const WriteControllerOptions& opts) {
+        writeController.setOptions(opts);
+    }
+    
+    void resetMetrics() {
+        metrics.reset();
+        compactionStats.reset();
+    }
+    
+    /**
+     * @brief Registra un merge terminado (bytes leídos/escritos y duración)
+     * Punto de entrada para el camino de compactación: alimenta las
+     * estadísticas del nivel destino, totalMerges y el histograma de merge.
+     */
+    void recordCompaction(size_t targetLevel, uint64_t bytesRead, uint64_t bytesWritten,
+                          std::chrono::steady_clock::duration elapsed) {
+        compactionStats.recordCompaction(targetLevel, bytesRead, bytesWritten, elapsed);
+        metrics.totalMerges++;
+        metrics.mergeLatency.record(elapsed);
+    }
+    
+    /**
+     * @brief Estadísticas por nivel: forma del árbol y actividad acumulada
+     * El solape de un nivel es la fracción de pares de componentes cuyos
+     * MBRs se intersectan (0 = particionado, 1 = todos solapan); se calcula
+     * con el índice de componentes. RA/query es la media de componentes del
+     * nivel leídos por consulta no cacheada.
+     */
+    std::vector<LevelStats> getLevelStats() const {
+        std::vector<std::shared_ptr<LSMComponent<T>>> components;
+        std::shared_ptr<const ComponentIndex<T>> index;
+        {
+            std::lock_guard<std::mutex> lock(treeMutex);
+            components = diskComponents;
+            index = componentIndex;
+        }
+        
+        std::map<size_t, LevelStats> perLevel;
+        std::map<size_t, uint64_t> overlappingPairs;
+        for (const auto& comp : components) {
+            auto& s = perLevel[comp->getLevel()];
+            s.components++;
+            s.records += comp->size();
+            s.tombstones += comp->getTombstoneCount();
+            s.bytes += componentBytes(*comp);
+            // Cada par solapado aparece dos veces (una por cada extremo)
+            size_t hits = index->overlappingInLevel(comp->getLevel(), comp->getMBR()).size();
+            overlappingPairs[comp->getLevel()] += hits > 0 ? hits - 1 : 0;
+        }
+        for (size_t lvl = 0; lvl < compactionStats.activeLevels(); ++lvl) {
+            perLevel[lvl];
+        }
+        
+        uint64_t queries = compactionStats.getQueries();
+        std::vector<LevelStats> out;
+        for (auto& [lvl, s] : perLevel) {
+            s.level = lvl;
+            auto counters = compactionStats.get(lvl);
+            s.compactionBytesRead = counters.bytesRead;
+            s.compactionBytesWritten = counters.bytesWritten;
+            s.merges = counters.merges;
+            s.mergeSeconds = static_cast<double>(counters.mergeNanos) / 1e9;
+            s.readAmplification = queries ? static_cast<double>(counters.componentsScanned) / queries : 0.0;
+            if (s.components > 1) {
+                double pairs = static_cast<double>(s.components) * (s.components - 1);
+                s.overlapRatio = static_cast<double>(overlappingPairs[lvl]) / pairs;
+            }
+            out.push_back(s);
+        }
+        return out;
+    }
+    
+    size_t getMemTableMemoryUsage() const {
+        size_t total = 0;
+        forEachMemTable([&total](const MemTable<T>& table) { total += table.memoryUsage(); });
+        return total;
+    }
+    
+    /**
+     * @brief Versión actual del índice de componentes
+     * Inmutable: sirve para kNN y selección de compactación sin bloquear.
+     */
+    std::shared_ptr<const ComponentIndex<T>> getComponentIndex() const {
+        std::lock_guard<std::mutex> lock(treeMutex);
+        return componentIndex;
+    }
     
     size_t getComponentCount() const {
         std::lock_guard<std::mutex> lock(treeMutex);
@@ -220,12 +1675,28 @@ public:
     
     size_t getTotalRecords() const {
         std::lock_guard<std::mutex> lock(treeMutex);
-        size_t total = memTable.size();
+        size_t total = 0;
+        forEachMemTable([&total](const MemTable<T>& table) { total += table.size(); });
         for (const auto& comp : diskComponents) {
             total += comp->size();
         }
         return total;
     }
+    
+    /**
+     * @brief Tombstones aún presentes (MemTable + componentes cargados)
+     * Cada borrado deja uno hasta que un merge lo purga: con churn de
+     * actualizaciones su crecimiento mide la deuda de compactación.
+     */
+    size_t getTombstoneCount() const {
+        std::lock_guard<std::mutex> lock(treeMutex);
+        size_t total = 0;
+        forEachMemTable([&total](const MemTable<T>& table) { total += table.tombstoneCount(); });
+        for (const auto& comp : diskComponents) {
+            total += comp->getTombstoneCount();
+        }
+        return total;
+    }
 };
 
 } // namespace lsm
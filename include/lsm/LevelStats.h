@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lsm {
+
+/**
+ * @brief Estadísticas de un nivel del LSM-tree (comando stats)
+ */
+struct LevelStats {
+    size_t level = 0;
+    size_t components = 0;
+    uint64_t records = 0;
+    uint64_t tombstones = 0;               // Incluidos en records
+    uint64_t bytes = 0;                    // En disco, o estimado si no se ha persistido
+    uint64_t compactionBytesRead = 0;      // Leídos por merges cuyo destino es este nivel
+    uint64_t compactionBytesWritten = 0;   // Escritos en el nivel (flush, ingesta, merge)
+    uint64_t merges = 0;
+    double mergeSeconds = 0.0;
+    double readAmplification = 0.0;        // Componentes del nivel leídos por consulta
+    double overlapRatio = 0.0;             // Fracción de pares de componentes con MBR solapado
+};
+
+/**
+ * @brief Contadores acumulados por nivel de destino
+ * Flush, ingesta y merge registran lo que escriben en cada nivel; las
+ * consultas, cuántos componentes de cada nivel tuvieron que leer. Los
+ * niveles a partir de MAX_LEVELS - 1 se acumulan en el último.
+ */
+class CompactionStats {
+public:
+    static constexpr size_t MAX_LEVELS = 16;
+
+    struct Level {
+        uint64_t bytesRead = 0;
+        uint64_t bytesWritten = 0;
+        uint64_t merges = 0;
+        uint64_t mergeNanos = 0;
+        uint64_t componentsScanned = 0;
+    };
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> bytesRead{0};
+        std::atomic<uint64_t> bytesWritten{0};
+        std::atomic<uint64_t> merges{0};
+        std::atomic<uint64_t> mergeNanos{0};
+        std::atomic<uint64_t> componentsScanned{0};
+    };
+
+    std::array<Counters, MAX_LEVELS> levels;
+    std::atomic<uint64_t> queries{0};
+
+    Counters& at(size_t level) { return levels[std::min(level, MAX_LEVELS - 1)]; }
+
+public:
+    /**
+     * @brief Bytes escritos en un nivel por flush o ingesta directa
+     */
+    void recordWrite(size_t level, uint64_t bytes) {
+        at(level).bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Merge terminado con salida en targetLevel
+     */
+    void recordCompaction(size_t targetLevel, uint64_t bytesRead, uint64_t bytesWritten,
+                          std::chrono::steady_clock::duration elapsed) {
+        auto& c = at(targetLevel);
+        c.bytesRead.fetch_add(bytesRead, std::memory_order_relaxed);
+        c.bytesWritten.fetch_add(bytesWritten, std::memory_order_relaxed);
+        c.merges.fetch_add(1, std::memory_order_relaxed);
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        c.mergeNanos.fetch_add(static_cast<uint64_t>(std::max<int64_t>(0, ns)),
+                               std::memory_order_relaxed);
+    }
+
+    void recordScan(size_t level) {
+        at(level).componentsScanned.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void recordQuery() { queries.fetch_add(1, std::memory_order_relaxed); }
+
+    uint64_t getQueries() const { return queries.load(std::memory_order_relaxed); }
+
+    Level get(size_t level) const {
+        const auto& c = levels[std::min(level, MAX_LEVELS - 1)];
+        Level l;
+        l.bytesRead = c.bytesRead.load(std::memory_order_relaxed);
+        l.bytesWritten = c.bytesWritten.load(std::memory_order_relaxed);
+        l.merges = c.merges.load(std::memory_order_relaxed);
+        l.mergeNanos = c.mergeNanos.load(std::memory_order_relaxed);
+        l.componentsScanned = c.componentsScanned.load(std::memory_order_relaxed);
+        return l;
+    }
+
+    /**
+     * @brief Niveles con actividad registrada (escrituras, merges o lecturas)
+     */
+    size_t activeLevels() const {
+        size_t n = 0;
+        for (size_t i = 0; i < MAX_LEVELS; ++i) {
+            const auto& c = levels[i];
+            if (c.bytesWritten.load(std::memory_order_relaxed) ||
+                c.componentsScanned.load(std::memory_order_relaxed)) {
+                n = i + 1;
+            }
+        }
+        return n;
+    }
+
+    void reset() {
+        for (auto& c : levels) {
+            c.bytesRead.store(0, std::memory_order_relaxed);
+            c.bytesWritten.store(0, std::memory_order_relaxed);
+            c.merges.store(0, std::memory_order_relaxed);
+            c.mergeNanos.store(0, std::memory_order_relaxed);
+            c.componentsScanned.store(0, std::memory_order_relaxed);
+        }
+        queries.store(0, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Tabla de estadísticas por nivel, una fila por nivel más el total
+ */
+inline std::string formatLevelStats(const std::vector<LevelStats>& stats) {
+    auto mb = [](uint64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "Level  Files     Records  Tombstones    Size(MB)  Read(MB)  Write(MB)  Merges  Merge(s)"
+           "  RA/query  Overlap\n";
+
+    LevelStats total;
+    for (const auto& s : stats) {
+        out << "  L" << std::left << std::setw(3) << s.level << std::right
+            << std::setw(6) << s.components
+            << std::setw(12) << s.records
+            << std::setw(12) << s.tombstones
+            << std::setw(12) << mb(s.bytes)
+            << std::setw(10) << mb(s.compactionBytesRead)
+            << std::setw(11) << mb(s.compactionBytesWritten)
+            << std::setw(8) << s.merges
+            << std::setw(10) << s.mergeSeconds
+            << std::setw(10) << s.readAmplification
+            << std::setw(9) << s.overlapRatio << "\n";
+
+        total.components += s.components;
+        total.records += s.records;
+        total.tombstones += s.tombstones;
+        total.bytes += s.bytes;
+        total.compactionBytesRead += s.compactionBytesRead;
+        total.compactionBytesWritten += s.compactionBytesWritten;
+        total.merges += s.merges;
+        total.mergeSeconds += s.mergeSeconds;
+        total.readAmplification += s.readAmplification;
+    }
+
+    out << "  Sum " << std::setw(6) << total.components
+        << std::setw(12) << total.records
+        << std::setw(12) << total.tombstones
+        << std::setw(12) << mb(total.bytes)
+        << std::setw(10) << mb(total.compactionBytesRead)
+        << std::setw(11) << mb(total.compactionBytesWritten)
+        << std::setw(8) << total.merges
+        << std::setw(10) << total.mergeSeconds
+        << std::setw(10) << total.readAmplification << "\n";
+    return out.str();
+}
+
+/**
+ * @brief Vuelca periódicamente un informe a un fichero (modo append)
+ * Un hilo propio llama a producer() cada intervalo y escribe el resultado
+ * con una cabecera de fecha. stop() (o el destructor) hace un último
+ * volcado y espera al hilo.
+ */
+class StatsDumper {
+private:
+    std::string path;
+    std::chrono::milliseconds interval;
+    std::function<std::string()> producer;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+    std::thread worker;
+
+    void dump() {
+        std::ofstream file(path, std::ios::app);
+        if (!file) return;
+
+        std::time_t now = std::time(nullptr);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+        file << "** STATS " << stamp << " **\n" << producer() << "\n";
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (wakeup.wait_for(lock, interval, [this]() { return stopping; })) break;
+            lock.unlock();
+            dump();
+            lock.lock();
+        }
+    }
+
+public:
+    StatsDumper(std::string file, std::chrono::milliseconds period,
+                std::function<std::string()> report)
+        : path(std::move(file)),
+          interval(std::max(period, std::chrono::milliseconds(1))),
+          producer(std::move(report)) {
+        worker = std::thread([this]() { run(); });
+    }
+
+    ~StatsDumper() { stop(); }
+
+    StatsDumper(const StatsDumper&) = delete;
+    StatsDumper& operator=(const StatsDumper&) = delete;
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) return;
+            stopping = true;
+        }
+        wakeup.notify_all();
+        if (worker.joinable()) worker.join();
+        dump();
+    }
+
+    const std::string& getPath() const { return path; }
+    std::chrono::milliseconds getInterval() const { return interval; }
+};
+
+} // namespace lsm
@@ -0,0 +1,483 @@
+#pragma once
+
+#include "BlockEncoding.h"
+#include "../spatial/MBR.h"
+#include "../spatial/Point.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <filesystem>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace lsm {
+
+using namespace spatial;
+
+/**
+ * @brief Metadatos persistentes de un componente de disco
+ * Suficientes para reconstruir el índice de componentes sin abrir ficheros.
+ */
+struct ComponentMeta {
+    uint64_t fileNumber = 0;
+    size_t level = 0;
+    MBR mbr;
+    uint64_t recordCount = 0;
+    uint64_t minSequence = 0;
+    uint64_t maxSequence = 0;
+
+    static std::string fileName(uint64_t number) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%06llu.cmp", static_cast<unsigned long long>(number));
+        return buf;
+    }
+
+    /**
+     * @brief Número de fichero de un nombre "NNNNNN.cmp"; false si no lo es
+     */
+    static bool parseFileName(const std::string& name, uint64_t& number) {
+        size_t dot = name.find('.');
+        if (dot == 0 || dot == std::string::npos || name.substr(dot) != ".cmp") return false;
+        number = 0;
+        for (size_t i = 0; i < dot; ++i) {
+            if (name[i] < '0' || name[i] > '9') return false;
+            number = number * 10 + static_cast<uint64_t>(name[i] - '0');
+        }
+        return true;
+    }
+
+    std::string filename() const { return fileName(fileNumber); }
+};
+
+/**
+ * @brief Cambio atómico de versión (uno de varios en un registro del MANIFEST)
+ */
+struct VersionEdit {
+    enum class Kind : uint8_t {
+        ADD_COMPONENT = 1,
+        REMOVE_COMPONENT = 2,
+        PUT_TABLE = 3,
+        DROP_TABLE = 4,
+        NEXT_FILE_NUMBER = 5
+    };
+
+    Kind kind = Kind::ADD_COMPONENT;
+    std::string table;
+    ComponentMeta component;   // ADD_COMPONENT; REMOVE_COMPONENT solo usa fileNumber
+    std::string schema;        // PUT_TABLE: esquema serializado por la capa SQL
+    uint64_t nextFileNumber = 0;
+
+    static VersionEdit addComponent(const std::string& table, const ComponentMeta& meta) {
+        VersionEdit e;
+        e.kind = Kind::ADD_COMPONENT;
+        e.table = table;
+        e.component = meta;
+        return e;
+    }
+
+    static VersionEdit removeComponent(const std::string& table, uint64_t fileNumber) {
+        VersionEdit e;
+        e.kind = Kind::REMOVE_COMPONENT;
+        e.table = table;
+        e.component.fileNumber = fileNumber;
+        return e;
+    }
+
+    static VersionEdit putTable(const std::string& table, const std::string& schema) {
+        VersionEdit e;
+        e.kind = Kind::PUT_TABLE;
+        e.table = table;
+        e.schema = schema;
+        return e;
+    }
+
+    static VersionEdit dropTable(const std::string& table) {
+        VersionEdit e;
+        e.kind = Kind::DROP_TABLE;
+        e.table = table;
+        return e;
+    }
+};
+
+/**
+ * @brief MANIFEST de solo-append con puntero CURRENT
+ * Cada registro agrupa las ediciones de un cambio (flush, ingesta, merge,
+ * DDL) y se aplica entero o no se aplica: [u32 longitud][u32 crc32][datos].
+ * Un registro final truncado (caída a mitad de escritura) se ignora al
+ * recuperar. Al superar maxManifestBytes se reescribe como instantánea en
+ * un MANIFEST nuevo y CURRENT se actualiza con rename atómico.
+ *
+ * Disposición: <dir>/CURRENT, <dir>/MANIFEST-NNNNNN, <dir>/<tabla>/NNNNNN.cmp
+ */
+class Manifest {
+public:
+    struct TableState {
+        bool hasSchema = false;
+        std::string schema;
+        std::map<uint64_t, ComponentMeta> components;   // fileNumber → metadatos
+        uint64_t lastSequence = 0;
+    };
+
+private:
+    std::filesystem::path directory;
+    uint64_t maxManifestBytes;
+    std::map<std::string, TableState> tables;
+    uint64_t nextFileNumber;
+    uint64_t manifestNumber;
+    uint64_t manifestBytes;
+    std::FILE* log;
+    mutable std::mutex mutex;
+
+    static uint32_t crc32(const uint8_t* data, size_t size) {
+        static const auto table = []() {
+            std::vector<uint32_t> t(256);
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[i] = c;
+            }
+            return t;
+        }();
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    static std::string manifestName(uint64_t number) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "MANIFEST-%06llu", static_cast<unsigned long long>(number));
+        return buf;
+    }
+
+    static void putString(std::vector<uint8_t>& out, const std::string& s) {
+        varint::put(out, s.size());
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    static std::string getString(const uint8_t*& p, const uint8_t* end) {
+        uint64_t len = varint::get(p, end);
+        if (len > static_cast<uint64_t>(end - p)) throw std::runtime_error("Corrupt manifest: string");
+        std::string s(reinterpret_cast<const char*>(p), len);
+        p += len;
+        return s;
+    }
+
+    static void putDouble(std::vector<uint8_t>& out, double v) {
+        uint8_t raw[sizeof(double)];
+        std::memcpy(raw, &v, sizeof(v));
+        out.insert(out.end(), raw, raw + sizeof(raw));
+    }
+
+    static double getDouble(const uint8_t*& p, const uint8_t* end) {
+        if (end - p < static_cast<std::ptrdiff_t>(sizeof(double))) {
+            throw std::runtime_error("Corrupt manifest: double");
+        }
+        double v;
+        std::memcpy(&v, p, sizeof(v));
+        p += sizeof(v);
+        return v;
+    }
+
+    static std::vector<uint8_t> encode(const std::vector<VersionEdit>& edits) {
+        std::vector<uint8_t> out;
+        varint::put(out, edits.size());
+        for (const auto& e : edits) {
+            out.push_back(static_cast<uint8_t>(e.kind));
+            putString(out, e.table);
+            switch (e.kind) {
+                case VersionEdit::Kind::ADD_COMPONENT: {
+                    const auto& m = e.component;
+                    varint::put(out, m.fileNumber);
+                    varint::put(out, m.level);
+                    varint::put(out, m.recordCount);
+                    varint::put(out, m.minSequence);
+                    varint::put(out, m.maxSequence);
+                    varint::put(out, m.mbr.dimensions());
+                    for (size_t d = 0; d < m.mbr.dimensions(); ++d) putDouble(out, m.mbr.getLower()[d]);
+                    for (size_t d = 0; d < m.mbr.dimensions(); ++d) putDouble(out, m.mbr.getUpper()[d]);
+                    break;
+                }
+                case VersionEdit::Kind::REMOVE_COMPONENT:
+                    varint::put(out, e.component.fileNumber);
+                    break;
+                case VersionEdit::Kind::PUT_TABLE:
+                    putString(out, e.schema);
+                    break;
+                case VersionEdit::Kind::DROP_TABLE:
+                    break;
+                case VersionEdit::Kind::NEXT_FILE_NUMBER:
+                    varint::put(out, e.nextFileNumber);
+                    break;
+            }
+        }
+        return out;
+    }
+
+    static std::vector<VersionEdit> decode(const uint8_t* p, const uint8_t* end) {
+        std::vector<VersionEdit> edits(varint::get(p, end));
+        for (auto& e : edits) {
+            if (p >= end) throw std::runtime_error("Corrupt manifest: truncated edit");
+            e.kind = static_cast<VersionEdit::Kind>(*p++);
+            e.table = getString(p, end);
+            switch (e.kind) {
+                case VersionEdit::Kind::ADD_COMPONENT: {
+                    auto& m = e.component;
+                    m.fileNumber = varint::get(p, end);
+                    m.level = varint::get(p, end);
+                    m.recordCount = varint::get(p, end);
+                    m.minSequence = varint::get(p, end);
+                    m.maxSequence = varint::get(p, end);
+                    size_t dims = varint::get(p, end);
+                    std::vector<double> lower(dims), upper(dims);
+                    for (auto& v : lower) v = getDouble(p, end);
+                    for (auto& v : upper) v = getDouble(p, end);
+                    m.mbr = MBR(Point(lower), Point(upper));
+                    break;
+                }
+                case VersionEdit::Kind::REMOVE_COMPONENT:
+                    e.component.fileNumber = varint::get(p, end);
+                    break;
+                case VersionEdit::Kind::PUT_TABLE:
+                    e.schema = getString(p, end);
+                    break;
+                case VersionEdit::Kind::DROP_TABLE:
+                    break;
+                case VersionEdit::Kind::NEXT_FILE_NUMBER:
+                    e.nextFileNumber = varint::get(p, end);
+                    break;
+                default:
+                    throw std::runtime_error("Corrupt manifest: unknown edit kind");
+            }
+        }
+        return edits;
+    }
+
+    void applyLocked(const VersionEdit& e) {
+        switch (e.kind) {
+            case VersionEdit::Kind::ADD_COMPONENT: {
+                auto& t = tables[e.table];
+                t.components[e.component.fileNumber] = e.component;
+                t.lastSequence = std::max(t.lastSequence, e.component.maxSequence);
+                nextFileNumber = std::max(nextFileNumber, e.component.fileNumber + 1);
+                break;
+            }
+            case VersionEdit::Kind::REMOVE_COMPONENT: {
+                auto it = tables.find(e.table);
+                if (it != tables.end()) it->second.components.erase(e.component.fileNumber);
+                break;
+            }
+            case VersionEdit::Kind::PUT_TABLE: {
+                auto& t = tables[e.table];
+                t.hasSchema = true;
+                t.schema = e.schema;
+                break;
+            }
+            case VersionEdit::Kind::DROP_TABLE:
+                tables.erase(e.table);
+                break;
+            case VersionEdit::Kind::NEXT_FILE_NUMBER:
+                nextFileNumber = std::max(nextFileNumber, e.nextFileNumber);
+                break;
+        }
+    }
+
+    static void syncFile(std::FILE* f) {
+        std::fflush(f);
+#if defined(__unix__) || defined(__APPLE__)
+        ::fsync(::fileno(f));
+#endif
+    }
+
+    void appendRecordLocked(std::FILE* f, const std::vector<VersionEdit>& edits) {
+        auto payload = encode(edits);
+        uint32_t header[2] = {static_cast<uint32_t>(payload.size()),
+                              crc32(payload.data(), payload.size())};
+        if (std::fwrite(header, sizeof(header), 1, f) != 1 ||
+            (!payload.empty() && std::fwrite(payload.data(), payload.size(), 1, f) != 1)) {
+            throw std::runtime_error("Cannot append to manifest");
+        }
+        syncFile(f);
+        manifestBytes += sizeof(header) + payload.size();
+    }
+
+    /**
+     * @brief Ediciones que reproducen el estado actual (instantánea)
+     */
+    std::vector<VersionEdit> snapshotEditsLocked() const {
+        std::vector<VersionEdit> edits;
+        for (const auto& [name, t] : tables) {
+            if (t.hasSchema) edits.push_back(VersionEdit::putTable(name, t.schema));
+            for (const auto& [num, meta] : t.components) {
+                edits.push_back(VersionEdit::addComponent(name, meta));
+            }
+        }
+        VersionEdit next;
+        next.kind = VersionEdit::Kind::NEXT_FILE_NUMBER;
+        next.nextFileNumber = nextFileNumber;
+        edits.push_back(next);
+        return edits;
+    }
+
+    /**
+     * @brief Escribe un MANIFEST nuevo con la instantánea y mueve CURRENT
+     */
+    void rotateLocked() {
+        uint64_t number = nextFileNumber++;
+        auto path = directory / manifestName(number);
+        std::FILE* f = std::fopen(path.string().c_str(), "wb");
+        if (!f) throw std::runtime_error("Cannot create manifest: " + path.string());
+
+        uint64_t previousNumber = manifestNumber;
+        manifestBytes = 0;
+        try {
+            appendRecordLocked(f, snapshotEditsLocked());
+        } catch (...) {
+            std::fclose(f);
+            throw;
+        }
+
+        // CURRENT se sustituye con rename: nunca queda a medio escribir
+        auto tmp = directory / "CURRENT.tmp";
+        {
+            std::FILE* c = std::fopen(tmp.string().c_str(), "wb");
+            if (!c) {
+                std::fclose(f);
+                throw std::runtime_error("Cannot write CURRENT");
+            }
+            std::string name = manifestName(number) + "\n";
+            std::fwrite(name.data(), name.size(), 1, c);
+            syncFile(c);
+            std::fclose(c);
+        }
+        std::filesystem::rename(tmp, directory / "CURRENT");
+
+        if (log) std::fclose(log);
+        log = f;
+        manifestNumber = number;
+
+        if (previousNumber != 0) {
+            std::error_code ec;
+            std::filesystem::remove(directory / manifestName(previousNumber), ec);
+        }
+    }
+
+    /**
+     * @brief Reproduce un MANIFEST; se detiene en el primer registro incompleto
+     */
+    void replayLocked(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("Cannot open manifest: " + path.string());
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)),
+                                  std::istreambuf_iterator<char>());
+
+        size_t offset = 0;
+        while (data.size() - offset >= 2 * sizeof(uint32_t)) {
+            uint32_t header[2];
+            std::memcpy(header, data.data() + offset, sizeof(header));
+            size_t start = offset + sizeof(header);
+            if (header[0] > data.size() - start) break;
+            if (crc32(data.data() + start, header[0]) != header[1]) break;
+
+            for (const auto& e : decode(data.data() + start, data.data() + start + header[0])) {
+                applyLocked(e);
+            }
+            offset = start + header[0];
+        }
+        manifestBytes = offset;
+    }
+
+public:
+    explicit Manifest(const std::string& dir, uint64_t maxBytes = 64ull * 1024 * 1024)
+        : directory(dir), maxManifestBytes(maxBytes), nextFileNumber(1),
+          manifestNumber(0), manifestBytes(0), log(nullptr) {}
+
+    ~Manifest() {
+        if (log) std::fclose(log);
+    }
+
+    Manifest(const Manifest&) = delete;
+    Manifest& operator=(const Manifest&) = delete;
+
+    /**
+     * @brief Abre o crea la base de datos
+     * Recupera el estado reproduciendo el MANIFEST apuntado por CURRENT y
+     * empieza uno nuevo compactado; no abre ficheros de componentes.
+     */
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::filesystem::create_directories(directory);
+
+        auto current = directory / "CURRENT";
+        if (std::filesystem::exists(current)) {
+            std::ifstream in(current);
+            std::string name;
+            std::getline(in, name);
+            if (name.rfind("MANIFEST-", 0) != 0) {
+                throw std::runtime_error("Corrupt CURRENT in " + directory.string());
+            }
+            replayLocked(directory / name);
+            manifestNumber = std::stoull(name.substr(9));
+            nextFileNumber = std::max(nextFileNumber, manifestNumber + 1);
+        }
+        rotateLocked();
+    }
+
+    /**
+     * @brief Reserva un número de fichero único (nunca se reutiliza)
+     */
+    uint64_t newFileNumber() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nextFileNumber++;
+    }
+
+    /**
+     * @brief Registra un cambio de versión de forma atómica y lo aplica
+     */
+    void logAndApply(const std::vector<VersionEdit>& edits) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!log) throw std::runtime_error("Manifest is not open");
+
+        // El número de fichero siguiente viaja con el registro: tras
+        // recuperar nunca se reutiliza uno ya entregado
+        std::vector<VersionEdit> record = edits;
+        VersionEdit next;
+        next.kind = VersionEdit::Kind::NEXT_FILE_NUMBER;
+        next.nextFileNumber = nextFileNumber;
+        record.push_back(next);
+
+        appendRecordLocked(log, record);
+        for (const auto& e : record) applyLocked(e);
+
+        if (manifestBytes > maxManifestBytes) rotateLocked();
+    }
+
+    std::map<std::string, TableState> getTables() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return tables;
+    }
+
+    TableState getTable(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = tables.find(name);
+        return it == tables.end() ? TableState() : it->second;
+    }
+
+    /**
+     * @brief Directorio de los ficheros de componentes de una tabla
+     */
+    std::string tableDirectory(const std::string& table) const {
+        return (directory / table).string();
+    }
+
+    const std::filesystem::path& getDirectory() const { return directory; }
+};
+
+} // namespace lsm
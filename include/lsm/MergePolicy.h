@@ -1,11 +1,17 @@
 #pragma once
 
 #include "LSMComponent.h"
+#include "PartitioningStrategy.h"
 #include "../spatial/SpatialComparators.h"
 #include <vector>
+#include <map>
 #include <memory>
 #include <queue>
 #include <algorithm>
+#include <string>
+#include <stdexcept>
+#include <limits>
+#include <cstdint>
 
 namespace lsm {
 
@@ -33,21 +39,161 @@ public:
     
     /**
      * @brief Ejecuta el merge de componentes
-     * Escanea registros, usa cola de prioridad para ordenar,
-     * elimina obsoletos/antimateria y escribe nuevos componentes
+     * Recorre las entradas de la más reciente a la más antigua (secuencia
+     * máxima) y se queda con la primera versión de cada punto; la salida
+     * queda ordenada por SimpleComparator.
+     * @param purgeTombstones Descarta los tombstones. Solo es seguro si
+     * ningún componente más antiguo fuera del merge puede contener el punto.
      */
     std::shared_ptr<LSMComponent<T>> mergeComponents(
         const std::vector<std::shared_ptr<LSMComponent<T>>>& components,
         size_t targetLevel,
-        size_t dimensions) const {
+        size_t dimensions,
+        bool purgeTombstones = true) const {
         
-        // TODO: Implementar merge de componentes
-        // 1. Recolectar registros de todos los componentes
-        // 2. Ordenar registros (SimpleComparator)
-        // 3. Eliminar duplicados (mantener más reciente)
-        // 4. Filtrar tombstones
-        // 5. Crear nuevo componente con build(mergedRecords)
-        return nullptr;
+        std::vector<std::shared_ptr<LSMComponent<T>>> newestFirst(components);
+        std::stable_sort(newestFirst.begin(), newestFirst.end(),
+                         [](const std::shared_ptr<LSMComponent<T>>& a,
+                            const std::shared_ptr<LSMComponent<T>>& b) {
+                             return a->getMaxSequence() > b->getMaxSequence();
+                         });
+        
+        std::map<Point, SpatialRecord<T>, SimpleComparator> latest;
+        for (const auto& comp : newestFirst) {
+            for (auto& record : comp->scanRecords()) {
+                latest.emplace(record.point, std::move(record));  // No pisa una versión más reciente
+            }
+        }
+        
+        std::vector<SpatialRecord<T>> merged;
+        merged.reserve(latest.size());
+        for (auto& [point, record] : latest) {
+            if (purgeTombstones && record.isTombstone) continue;
+            merged.push_back(std::move(record));
+        }
+        
+        auto output = std::make_shared<LSMComponent<T>>(targetLevel, dimensions);
+        output->build(std::move(merged));
+        return output;
+    }
+    
+    /**
+     * @brief Selección forzada para drenar una parada de escrituras
+     * Se usa cuando la política no ve nada que fusionar pero la deuda sigue
+     * parando las escrituras: el nivel con más componentes (al menos dos;
+     * a igualdad, el menos profundo).
+     */
+    virtual std::vector<std::shared_ptr<LSMComponent<T>>> selectForcedMerge(
+        const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const {
+        std::map<size_t, std::vector<std::shared_ptr<LSMComponent<T>>>> levels;
+        for (const auto& c : components) levels[c->getLevel()].push_back(c);
+        
+        const std::vector<std::shared_ptr<LSMComponent<T>>>* fullest = nullptr;
+        for (const auto& [level, group] : levels) {
+            if (group.size() >= 2 && (!fullest || group.size() > fullest->size())) fullest = &group;
+        }
+        if (!fullest) return {};
+        return withInterleaved(*fullest, components);
+    }
+    
+    /**
+     * @brief Nivel en el que se escribe la salida del merge
+     * Por defecto, uno por debajo de la entrada más profunda (stack-based).
+     */
+    virtual size_t outputLevel(const std::vector<std::shared_ptr<LSMComponent<T>>>& inputs) const {
+        size_t level = 0;
+        for (const auto& in : inputs) level = std::max(level, in->getLevel() + 1);
+        return level;
+    }
+    
+protected:
+    /**
+     * @brief Componentes ordenados del más antiguo al más reciente
+     */
+    static std::vector<std::shared_ptr<LSMComponent<T>>> oldestFirst(
+        const std::vector<std::shared_ptr<LSMComponent<T>>>& components) {
+        std::vector<std::shared_ptr<LSMComponent<T>>> ordered(components);
+        std::stable_sort(ordered.begin(), ordered.end(),
+                         [](const std::shared_ptr<LSMComponent<T>>& a,
+                            const std::shared_ptr<LSMComponent<T>>& b) {
+                             if (a->getMaxSequence() != b->getMaxSequence()) {
+                                 return a->getMaxSequence() < b->getMaxSequence();
+                             }
+                             return a->getMinSequence() < b->getMinSequence();
+                         });
+        return ordered;
+    }
+    
+    /**
+     * @brief Agrupa en runs los componentes con el mismo rango de secuencias
+     * Un merge particionado deja varios componentes con el mismo rango; las
+     * políticas stack-based los tratan como uno solo para que el
+     * particionado no vuelva a disparar el merge. Del más antiguo al más
+     * reciente.
+     */
+    static std::vector<std::vector<std::shared_ptr<LSMComponent<T>>>> runsOldestFirst(
+        const std::vector<std::shared_ptr<LSMComponent<T>>>& components) {
+        std::vector<std::vector<std::shared_ptr<LSMComponent<T>>>> runs;
+        for (const auto& c : oldestFirst(components)) {
+            if (!runs.empty() &&
+                runs.back().front()->getMinSequence() == c->getMinSequence() &&
+                runs.back().front()->getMaxSequence() == c->getMaxSequence()) {
+                runs.back().push_back(c);
+            } else {
+                runs.push_back({c});
+            }
+        }
+        return runs;
+    }
+    
+    static size_t runRecords(const std::vector<std::shared_ptr<LSMComponent<T>>>& run) {
+        size_t records = 0;
+        for (const auto& c : run) records += c->size();
+        return records;
+    }
+    
+    static std::vector<std::shared_ptr<LSMComponent<T>>> flatten(
+        typename std::vector<std::vector<std::shared_ptr<LSMComponent<T>>>>::const_iterator first,
+        typename std::vector<std::vector<std::shared_ptr<LSMComponent<T>>>>::const_iterator last) {
+        std::vector<std::shared_ptr<LSMComponent<T>>> components;
+        for (; first != last; ++first) components.insert(components.end(), first->begin(), first->end());
+        return components;
+    }
+    
+    /**
+     * @brief Completa una selección para que el merge no reordene versiones
+     * La salida hereda el rango de secuencias de sus entradas: un componente
+     * que quede fuera, se solape en el espacio y tenga un rango entrelazado
+     * pasaría a parecer más antiguo (o más reciente) de lo que es, así que
+     * se incorpora hasta llegar a un punto fijo.
+     */
+    static std::vector<std::shared_ptr<LSMComponent<T>>> withInterleaved(
+        std::vector<std::shared_ptr<LSMComponent<T>>> selected,
+        const std::vector<std::shared_ptr<LSMComponent<T>>>& components) {
+        if (selected.empty()) return selected;
+        
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            uint64_t minSeq = std::numeric_limits<uint64_t>::max(), maxSeq = 0;
+            for (const auto& s : selected) {
+                minSeq = std::min(minSeq, s->getMinSequence());
+                maxSeq = std::max(maxSeq, s->getMaxSequence());
+            }
+            for (const auto& c : components) {
+                if (std::find(selected.begin(), selected.end(), c) != selected.end()) continue;
+                if (c->getMaxSequence() < minSeq || c->getMinSequence() > maxSeq) continue;
+                bool overlaps = std::any_of(selected.begin(), selected.end(),
+                    [&](const std::shared_ptr<LSMComponent<T>>& s) {
+                        return s->getMBR().intersects(c->getMBR());
+                    });
+                if (overlaps) {
+                    selected.push_back(c);
+                    changed = true;
+                }
+            }
+        }
+        return selected;
     }
 };
 
@@ -55,26 +201,41 @@ public:
  * @brief Política Binomial
  * Stack-based con ratio k (típicamente 4 o 10)
  * Referencia: Binomial policy del paper
+ * Cuando un nivel acumula k runs, los k más antiguos se fusionan en uno del
+ * nivel siguiente, como el acarreo de un contador en base k.
  */
 template<typename T>
 class BinomialMergePolicy : public MergePolicy<T> {
 private:
     size_t k;  // Ratio de merge (4 o 10 típicamente)
     
+    static std::map<size_t, std::vector<std::vector<std::shared_ptr<LSMComponent<T>>>>> groupByLevel(
+        const std::vector<std::shared_ptr<LSMComponent<T>>>& components) {
+        std::map<size_t, std::vector<std::vector<std::shared_ptr<LSMComponent<T>>>>> levels;
+        for (auto& run : MergePolicy<T>::runsOldestFirst(components)) {
+            size_t level = run.front()->getLevel();
+            levels[level].push_back(std::move(run));
+        }
+        return levels;
+    }
+    
 public:
-    explicit BinomialMergePolicy(size_t ratio = 4) : k(ratio) {}
+    explicit BinomialMergePolicy(size_t ratio = 4) : k(std::max<size_t>(2, ratio)) {}
     
     bool shouldMerge(const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const override {
-        // TODO: Implementar lógica Binomial
-        // Verificar si hay >= k componentes en algún nivel
-        // Agrupar por nivel, retornar true si count >= k
+        for (const auto& [level, runs] : groupByLevel(components)) {
+            if (runs.size() >= k) return true;
+        }
         return false;
     }
     
     std::vector<std::shared_ptr<LSMComponent<T>>> selectComponentsToMerge(
         const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const override {
-        // TODO: Seleccionar k componentes del mismo nivel
-        // Agrupar por nivel, ordenar por timestamp, retornar primeros k
+        for (const auto& [level, runs] : groupByLevel(components)) {
+            if (runs.size() < k) continue;
+            return MergePolicy<T>::withInterleaved(
+                MergePolicy<T>::flatten(runs.begin(), runs.begin() + k), components);
+        }
         return {};
     }
 };
@@ -83,27 +244,51 @@ public:
  * @brief Política Tiered (SizeTiered)
  * Stack-based con agrupación por tamaño
  * Referencia: Tiered policy del paper
+ * Busca B runs consecutivos en el tiempo cuyo tamaño no difiera en un
+ * factor B o más y fusiona el grupo más pequeño.
  */
 template<typename T>
 class TieredMergePolicy : public MergePolicy<T> {
 private:
     size_t B;  // Factor de branching (4 o 10 típicamente)
     
+    std::vector<std::shared_ptr<LSMComponent<T>>> smallestTier(
+        const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const {
+        auto runs = MergePolicy<T>::runsOldestFirst(components);
+        
+        size_t bestStart = runs.size();
+        size_t bestRecords = std::numeric_limits<size_t>::max();
+        for (size_t i = 0; i + B <= runs.size(); ++i) {
+            size_t smallest = std::max<size_t>(1, MergePolicy<T>::runRecords(runs[i]));
+            size_t largest = smallest;
+            size_t records = 0;
+            size_t j = i;
+            for (; j < i + B; ++j) {
+                size_t n = std::max<size_t>(1, MergePolicy<T>::runRecords(runs[j]));
+                smallest = std::min(smallest, n);
+                largest = std::max(largest, n);
+                if (largest >= smallest * B) break;
+                records += n;
+            }
+            if (j == i + B && records < bestRecords) {
+                bestStart = i;
+                bestRecords = records;
+            }
+        }
+        if (bestStart == runs.size()) return {};
+        return MergePolicy<T>::flatten(runs.begin() + bestStart, runs.begin() + bestStart + B);
+    }
+    
 public:
-    explicit TieredMergePolicy(size_t branchingFactor = 4) : B(branchingFactor) {}
+    explicit TieredMergePolicy(size_t branchingFactor = 4) : B(std::max<size_t>(2, branchingFactor)) {}
     
     bool shouldMerge(const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const override {
-        // TODO: Implementar lógica Tiered
-        // 1. Agrupar componentes por tamaño similar (factor B)
-        // 2. Retornar true si algún grupo tiene >= B componentes
-        return false;
+        return !smallestTier(components).empty();
     }
     
     std::vector<std::shared_ptr<LSMComponent<T>>> selectComponentsToMerge(
         const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const override {
-        // TODO: Seleccionar primer grupo con B componentes
-        // Agrupar por tamaño, retornar primeros B del grupo
-        return {};
+        return MergePolicy<T>::withInterleaved(smallestTier(components), components);
     }
 };
 
@@ -111,26 +296,46 @@ public:
  * @brief Política Concurrent (Default Stack-based)
  * Merge continuo de componentes adyacentes
  * Referencia: Concurrent policy del paper
+ * Recorre la pila desde el run más antiguo y fusiona el primero que no
+ * supere sizeRatio veces la suma de los más recientes junto con todos
+ * ellos, siempre que sean al menos minComponents.
  */
 template<typename T>
 class ConcurrentMergePolicy : public MergePolicy<T> {
 private:
     size_t minComponents;
+    double sizeRatio;
+    
+    std::vector<std::shared_ptr<LSMComponent<T>>> mergeableSuffix(
+        const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const {
+        auto runs = MergePolicy<T>::runsOldestFirst(components);
+        if (runs.size() < minComponents) return {};
+        
+        std::vector<double> newerRecords(runs.size() + 1, 0.0);
+        for (size_t i = runs.size(); i-- > 0;) {
+            newerRecords[i] = newerRecords[i + 1] +
+                static_cast<double>(MergePolicy<T>::runRecords(runs[i]));
+        }
+        for (size_t i = 0; i + minComponents <= runs.size(); ++i) {
+            double records = static_cast<double>(MergePolicy<T>::runRecords(runs[i]));
+            if (records <= sizeRatio * newerRecords[i + 1]) {
+                return MergePolicy<T>::flatten(runs.begin() + i, runs.end());
+            }
+        }
+        return {};
+    }
     
 public:
-    explicit ConcurrentMergePolicy(size_t minComps = 2) : minComponents(minComps) {}
+    explicit ConcurrentMergePolicy(size_t minComps = 2, double ratio = 1.2)
+        : minComponents(std::max<size_t>(2, minComps)), sizeRatio(ratio) {}
     
     bool shouldMerge(const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const override {
-        // TODO: Implementar lógica Concurrent
-        // Permitir merge si components >= minComponents
-        return false;
+        return !mergeableSuffix(components).empty();
     }
     
     std::vector<std::shared_ptr<LSMComponent<T>>> selectComponentsToMerge(
         const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const override {
-        // TODO: Seleccionar componentes para merge concurrente
-        // Ordenar por timestamp, retornar los 2 más antiguos
-        return {};
+        return MergePolicy<T>::withInterleaved(mergeableSuffix(components), components);
     }
 };
 
@@ -138,6 +343,9 @@ public:
  * @brief Política Leveled
  * Arquitectura de niveles con merge selectivo
  * Referencia: Leveled Architecture del paper
+ * Cuando un nivel supera su capacidad (en registros), su componente más
+ * antiguo se fusiona con los del nivel siguiente que solapan su MBR y la
+ * salida queda en ese nivel siguiente.
  */
 template<typename T>
 class LeveledMergePolicy : public MergePolicy<T> {
@@ -145,31 +353,140 @@ private:
     size_t sizeRatio;  // Ratio de crecimiento entre niveles (típicamente 10)
     size_t baseSize;   // Tamaño base del nivel 0
     
+    /**
+     * @brief Primer nivel que excede su capacidad (o SIZE_MAX si ninguno)
+     */
+    size_t overflowingLevel(const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const {
+        std::map<size_t, size_t> records;
+        for (const auto& c : components) records[c->getLevel()] += c->size();
+        for (const auto& [level, total] : records) {
+            if (total > getMaxSizeForLevel(level)) return level;
+        }
+        return std::numeric_limits<size_t>::max();
+    }
+    
 public:
     explicit LeveledMergePolicy(size_t ratio = 10, size_t base = 1000)
-        : sizeRatio(ratio), baseSize(base) {}
+        : sizeRatio(std::max<size_t>(2, ratio)), baseSize(std::max<size_t>(1, base)) {}
     
     /**
      * @brief Calcula el tamaño máximo permitido para un nivel
      */
     size_t getMaxSizeForLevel(size_t level) const {
-        // TODO: Implementar cálculo de tamaño máximo
-        // baseSize * (sizeRatio ^ level)
-        return 0;
+        size_t limit = baseSize;
+        for (size_t i = 0; i < level; ++i) {
+            if (limit > std::numeric_limits<size_t>::max() / sizeRatio) {
+                return std::numeric_limits<size_t>::max();
+            }
+            limit *= sizeRatio;
+        }
+        return limit;
     }
     
     bool shouldMerge(const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const override {
-        // TODO: Implementar lógica Leveled
-        // Agrupar por nivel, sumar tamaños, verificar si excede getMaxSizeForLevel()
+        return overflowingLevel(components) != std::numeric_limits<size_t>::max();
+    }
+    
+    std::vector<std::shared_ptr<LSMComponent<T>>> selectComponentsToMerge(
+        const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const override {
+        size_t level = overflowingLevel(components);
+        if (level == std::numeric_limits<size_t>::max()) return {};
+        
+        std::shared_ptr<LSMComponent<T>> victim;
+        for (const auto& c : MergePolicy<T>::oldestFirst(components)) {
+            if (c->getLevel() == level) {
+                victim = c;
+                break;
+            }
+        }
+        
+        std::vector<std::shared_ptr<LSMComponent<T>>> selected{victim};
+        for (const auto& c : components) {
+            if (c->getLevel() == level + 1 && c->getMBR().intersects(victim->getMBR())) {
+                selected.push_back(c);
+            }
+        }
+        return MergePolicy<T>::withInterleaved(std::move(selected), components);
+    }
+    
+    size_t outputLevel(const std::vector<std::shared_ptr<LSMComponent<T>>>& inputs) const override {
+        size_t level = std::numeric_limits<size_t>::max();
+        for (const auto& in : inputs) level = std::min(level, in->getLevel());
+        return inputs.empty() ? 0 : level + 1;
+    }
+};
+
+/**
+ * @brief Política por ventanas de tiempo (tablas espacio-temporales)
+ * Agrupa los componentes por la ventana de su instante más reciente y solo
+ * fusiona dentro de una misma ventana, así que los componentes siguen
+ * disjuntos en el tiempo y una consulta por intervalo descarta los demás.
+ * Se compacta primero la ventana más reciente con minComponents flushes
+ * (nivel 0) y se fusiona con lo que ya tuviera: la salida, ya por encima
+ * del nivel 0, no vuelve a disparar el merge aunque el particionado la
+ * deje en varios componentes. Las ventanas antiguas no se vuelven a tocar.
+ */
+template<typename T>
+class TimeWindowMergePolicy : public MergePolicy<T> {
+private:
+    size_t timeDimension;
+    double window;
+    size_t minComponents;
+    
+    std::map<int64_t, std::vector<std::shared_ptr<LSMComponent<T>>>> groupByWindow(
+        const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const {
+        std::map<int64_t, std::vector<std::shared_ptr<LSMComponent<T>>>> windows;
+        for (const auto& c : components) {
+            double minTime, maxTime;
+            if (!c->getTimeRange(timeDimension, minTime, maxTime)) continue;
+            windows[TimePartitioning<T>::windowOf(maxTime, window)].push_back(c);
+        }
+        return windows;
+    }
+    
+    static size_t flushedCount(const std::vector<std::shared_ptr<LSMComponent<T>>>& group) {
+        return static_cast<size_t>(std::count_if(group.begin(), group.end(),
+            [](const std::shared_ptr<LSMComponent<T>>& c) { return c->getLevel() == 0; }));
+    }
+    
+public:
+    TimeWindowMergePolicy(size_t timeDim, double windowSize, size_t minComps = 4)
+        : timeDimension(timeDim), window(windowSize), minComponents(std::max<size_t>(2, minComps)) {}
+    
+    bool shouldMerge(const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const override {
+        for (const auto& [w, group] : groupByWindow(components)) {
+            if (flushedCount(group) >= minComponents) return true;
+        }
         return false;
     }
     
     std::vector<std::shared_ptr<LSMComponent<T>>> selectComponentsToMerge(
         const std::vector<std::shared_ptr<LSMComponent<T>>>& components) const override {
-        // TODO: Seleccionar componentes del nivel que excede
-        // Incluir componentes solapados del siguiente nivel (intersección MBR)
+        auto windows = groupByWindow(components);
+        for (auto it = windows.rbegin(); it != windows.rend(); ++it) {
+            if (flushedCount(it->second) >= minComponents) return it->second;
+        }
         return {};
     }
 };
 
+/**
+ * @brief Crea una política de merge por nombre (configuraciones del benchmark)
+ * @param parameter k (Binomial), B (Tiered), mínimo de componentes
+ * (Concurrent) o ratio entre niveles (Leveled)
+ */
+template<typename T>
+std::shared_ptr<MergePolicy<T>> makeMergePolicy(const std::string& name, size_t parameter) {
+    if (name == "Binomial") {
+        return std::make_shared<BinomialMergePolicy<T>>(parameter);
+    } else if (name == "Tiered") {
+        return std::make_shared<TieredMergePolicy<T>>(parameter);
+    } else if (name == "Concurrent") {
+        return std::make_shared<ConcurrentMergePolicy<T>>(parameter);
+    } else if (name == "Leveled") {
+        return std::make_shared<LeveledMergePolicy<T>>(parameter);
+    }
+    throw std::invalid_argument("Unknown merge policy: " + name);
+}
+
 } // namespace lsm
@@ -7,6 +7,13 @@
 #include <memory>
 #include <algorithm>
 #include <cmath>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <iterator>
+#include <utility>
 
 namespace lsm {
 
@@ -51,11 +58,36 @@ public:
         size_t dimensions,
         size_t maxComponentSize) const override {
         
-        // TODO: Implementar Size Partitioning
-        // 1. Ordenar records (SimpleComparator o HilbertCurveComparator según comparatorType)
-        // 2. Particionar en chunks de maxComponentSize
-        // 3. Crear LSMComponent para cada chunk con build()
-        return {};
+        if (records.empty() || dimensions == 0) return {};
+        
+        std::vector<SpatialRecord<T>> sorted;
+        if (comparatorType == HILBERT) {
+            MBR bounds(dimensions);
+            for (const auto& r : records) bounds.expand(r.point);
+            
+            // Una clave por registro en vez de recalcularla en cada comparación
+            std::vector<std::pair<uint64_t, size_t>> keys;
+            keys.reserve(records.size());
+            for (size_t i = 0; i < records.size(); ++i) {
+                keys.emplace_back(HilbertCurveComparator::computeHilbertIndex(records[i].point, bounds), i);
+            }
+            std::sort(keys.begin(), keys.end());
+            sorted.reserve(records.size());
+            for (const auto& key : keys) sorted.push_back(records[key.second]);
+        } else {
+            sorted = records;
+            std::stable_sort(sorted.begin(), sorted.end(), SimpleComparator());
+        }
+        
+        std::vector<std::shared_ptr<LSMComponent<T>>> components;
+        size_t maxSize = std::max<size_t>(1, maxComponentSize);
+        for (size_t i = 0; i < sorted.size(); i += maxSize) {
+            size_t end = std::min(i + maxSize, sorted.size());
+            auto component = std::make_shared<LSMComponent<T>>(targetLevel, dimensions);
+            component->build(std::vector<SpatialRecord<T>>(sorted.begin() + i, sorted.begin() + end));
+            components.push_back(component);
+        }
+        return components;
     }
 };
 
@@ -73,9 +105,9 @@ public:
         size_t dimensions,
         size_t maxComponentSize) const override {
         
-        // TODO: Implementar STR partitioning
-        // Llamar strPartitionRecursive
-        return {};
+        if (records.empty() || dimensions == 0) return {};
+        return strPartitionRecursive(records, targetLevel, dimensions,
+                                     std::max<size_t>(1, maxComponentSize), 0);
     }
     
 private:
@@ -89,13 +121,39 @@ private:
         size_t maxComponentSize,
         size_t currentDim) const {
         
-        // TODO: Implementar STR recursivo
-        // 1. Caso base: si records <= maxComponentSize, crear un componente
-        // 2. Calcular numSlices = ceil((N/M)^(1/D))
-        // 3. Ordenar por dimensión actual
-        // 4. Dividir en slices
-        // 5. Recursión con siguiente dimensión para cada slice
-        return {};
+        std::vector<std::shared_ptr<LSMComponent<T>>> components;
+        
+        // Caso base: cabe en un componente (o no quedan dimensiones: trozos de M)
+        if (records.size() <= maxComponentSize || currentDim >= dimensions) {
+            for (size_t i = 0; i < records.size(); i += maxComponentSize) {
+                size_t end = std::min(i + maxComponentSize, records.size());
+                auto component = std::make_shared<LSMComponent<T>>(targetLevel, dimensions);
+                component->build(std::vector<SpatialRecord<T>>(records.begin() + i, records.begin() + end));
+                components.push_back(component);
+            }
+            return components;
+        }
+        
+        std::vector<SpatialRecord<T>> sorted(records);
+        std::sort(sorted.begin(), sorted.end(),
+                  [currentDim](const SpatialRecord<T>& a, const SpatialRecord<T>& b) {
+                      return a.point[currentDim] < b.point[currentDim];
+                  });
+        
+        // numSlices = ceil((N/M)^(1/D)) con las dimensiones que quedan
+        double pages = std::ceil(static_cast<double>(sorted.size()) / maxComponentSize);
+        size_t slices = static_cast<size_t>(
+            std::ceil(std::pow(pages, 1.0 / static_cast<double>(dimensions - currentDim))));
+        size_t sliceSize = (sorted.size() + slices - 1) / std::max<size_t>(1, slices);
+        
+        for (size_t i = 0; i < sorted.size(); i += sliceSize) {
+            size_t end = std::min(i + sliceSize, sorted.size());
+            auto part = strPartitionRecursive(
+                std::vector<SpatialRecord<T>>(sorted.begin() + i, sorted.begin() + end),
+                targetLevel, dimensions, maxComponentSize, currentDim + 1);
+            components.insert(components.end(), part.begin(), part.end());
+        }
+        return components;
     }
 };
 
@@ -119,49 +177,255 @@ public:
         size_t dimensions,
         size_t maxComponentSize) const override {
         
-        // TODO: Implementar R*-Grove 3-phase algorithm
-        // Caso base: si records <= maxComponentSize, crear 1 componente
-        // Fase 1: selectSample() - muestreo
-        // Fase 2: computeBoundaries() - calcular MBRs
-        // Fase 3: assignToComponents() - asignar records
-        return {};
+        if (records.empty() || dimensions == 0) return {};
+        size_t maxSize = std::max<size_t>(1, maxComponentSize);
+        if (records.size() <= maxSize) {
+            auto component = std::make_shared<LSMComponent<T>>(targetLevel, dimensions);
+            component->build(std::vector<SpatialRecord<T>>(records));
+            return {component};
+        }
+        
+        // La muestra se parte en tantos grupos como componentes hagan falta
+        size_t partitions = (records.size() + maxSize - 1) / maxSize;
+        auto sample = selectSample(records);
+        size_t sampleCapacity = std::max<size_t>(1, (sample.size() + partitions - 1) / partitions);
+        auto boundaries = computeBoundaries(sample, dimensions, sampleCapacity);
+        return assignToComponents(records, boundaries, targetLevel, dimensions, maxSize);
     }
     
 private:
     /**
      * @brief Fase 1: Seleccionar muestra aleatoria
+     * Semilla fija: el mismo merge produce siempre los mismos componentes.
      */
     std::vector<SpatialRecord<T>> selectSample(
         const std::vector<SpatialRecord<T>>& records) const {
-        // TODO: Muestreo uniforme con sampleRatio
-        return {};
+        size_t size = static_cast<size_t>(std::ceil(static_cast<double>(records.size()) * sampleRatio));
+        if (size == 0 || size >= records.size()) return records;
+        
+        std::vector<SpatialRecord<T>> sample;
+        sample.reserve(size);
+        std::mt19937_64 rng(records.size());
+        std::sample(records.begin(), records.end(), std::back_inserter(sample), size, rng);
+        return sample;
     }
     
     /**
-     * @brief Fase 2: Computar boundaries usando STR en la muestra
+     * @brief Fase 2: Computar boundaries sobre la muestra
+     * Divide la muestra recursivamente como el split de R*: eje con menor
+     * margen total y, en él, el corte con menor solape (luego menor área).
+     * Los cortes caen en múltiplos de maxComponentSize para que todos los
+     * grupos salvo uno queden llenos.
      */
     std::vector<MBR> computeBoundaries(
         const std::vector<SpatialRecord<T>>& sample,
         size_t dimensions,
         size_t maxComponentSize) const {
-        // TODO: Computar MBRs boundaries
-        // Para 2D: crear grid (sqrt(numPartitions) x sqrt(numPartitions))
-        // Para D>2: usar particionamiento por dimensión
-        return {};
+        std::vector<MBR> boundaries;
+        std::vector<Point> points;
+        points.reserve(sample.size());
+        for (const auto& r : sample) points.push_back(r.point);
+        splitSample(points, dimensions, std::max<size_t>(1, maxComponentSize), boundaries);
+        return boundaries;
+    }
+    
+    static double overlapArea(const MBR& a, const MBR& b) {
+        double area = 1.0;
+        for (size_t d = 0; d < a.dimensions(); ++d) {
+            double side = std::min(a.getUpper()[d], b.getUpper()[d]) -
+                          std::max(a.getLower()[d], b.getLower()[d]);
+            if (side <= 0.0) return 0.0;
+            area *= side;
+        }
+        return area;
+    }
+    
+    static void splitSample(std::vector<Point>& points, size_t dimensions, size_t capacity,
+                            std::vector<MBR>& boundaries) {
+        if (points.size() <= capacity) {
+            MBR box(dimensions);
+            for (const auto& p : points) box.expand(p);
+            boundaries.push_back(box);
+            return;
+        }
+        
+        auto prefixBoxes = [&](size_t dim, std::vector<MBR>& prefix, std::vector<MBR>& suffix) {
+            std::sort(points.begin(), points.end(),
+                      [dim](const Point& a, const Point& b) { return a[dim] < b[dim]; });
+            prefix.assign(points.size(), MBR(dimensions));
+            suffix.assign(points.size(), MBR(dimensions));
+            for (size_t i = 0; i < points.size(); ++i) {
+                if (i > 0) prefix[i] = prefix[i - 1];
+                prefix[i].expand(points[i]);
+            }
+            for (size_t i = points.size(); i-- > 0;) {
+                if (i + 1 < points.size()) suffix[i] = suffix[i + 1];
+                suffix[i].expand(points[i]);
+            }
+        };
+        
+        // Eje: el de menor margen sumado sobre todos los cortes candidatos
+        std::vector<MBR> prefix, suffix;
+        size_t bestDim = 0;
+        double bestMargin = std::numeric_limits<double>::max();
+        for (size_t dim = 0; dim < dimensions; ++dim) {
+            prefixBoxes(dim, prefix, suffix);
+            double margin = 0.0;
+            for (size_t cut = capacity; cut < points.size(); cut += capacity) {
+                margin += prefix[cut - 1].perimeter() + suffix[cut].perimeter();
+            }
+            if (margin < bestMargin) {
+                bestMargin = margin;
+                bestDim = dim;
+            }
+        }
+        
+        prefixBoxes(bestDim, prefix, suffix);
+        size_t bestCut = capacity;
+        double bestOverlap = std::numeric_limits<double>::max();
+        double bestArea = std::numeric_limits<double>::max();
+        for (size_t cut = capacity; cut < points.size(); cut += capacity) {
+            double overlap = overlapArea(prefix[cut - 1], suffix[cut]);
+            double area = prefix[cut - 1].area() + suffix[cut].area();
+            if (overlap < bestOverlap || (overlap == bestOverlap && area < bestArea)) {
+                bestOverlap = overlap;
+                bestArea = area;
+                bestCut = cut;
+            }
+        }
+        
+        std::vector<Point> right(points.begin() + bestCut, points.end());
+        points.resize(bestCut);
+        splitSample(points, dimensions, capacity, boundaries);
+        splitSample(right, dimensions, capacity, boundaries);
     }
     
     /**
      * @brief Fase 3: Asignar registros a componentes basados en boundaries
+     * Cada registro va al boundary que menos se agranda (a igualdad, el de
+     * menor área). Un grupo que la muestra subestimó se parte con STR para
+     * respetar maxComponentSize.
      */
     std::vector<std::shared_ptr<LSMComponent<T>>> assignToComponents(
         const std::vector<SpatialRecord<T>>& records,
         const std::vector<MBR>& boundaries,
         size_t targetLevel,
-        size_t dimensions) const {
-        // TODO: Asignar cada record al boundary con mínima expansión
-        // Crear bins, construir componentes
-        return {};
+        size_t dimensions,
+        size_t maxComponentSize) const {
+        std::vector<double> areas;
+        areas.reserve(boundaries.size());
+        for (const auto& b : boundaries) areas.push_back(b.area());
+        
+        std::vector<std::vector<SpatialRecord<T>>> bins(boundaries.size());
+        for (const auto& r : records) {
+            size_t best = 0;
+            double bestEnlargement = std::numeric_limits<double>::max();
+            for (size_t i = 0; i < boundaries.size(); ++i) {
+                double enlargement = 0.0;
+                if (!boundaries[i].contains(r.point)) {
+                    MBR grown = boundaries[i];
+                    grown.expand(r.point);
+                    enlargement = grown.area() - areas[i];
+                }
+                if (enlargement < bestEnlargement ||
+                    (enlargement == bestEnlargement && areas[i] < areas[best])) {
+                    bestEnlargement = enlargement;
+                    best = i;
+                }
+            }
+            bins[best].push_back(r);
+        }
+        
+        std::vector<std::shared_ptr<LSMComponent<T>>> components;
+        STRPartitioning<T> overflow;
+        for (auto& bin : bins) {
+            if (bin.empty()) continue;
+            if (bin.size() > maxComponentSize) {
+                auto parts = overflow.partition(bin, targetLevel, dimensions, maxComponentSize);
+                components.insert(components.end(), parts.begin(), parts.end());
+                continue;
+            }
+            auto component = std::make_shared<LSMComponent<T>>(targetLevel, dimensions);
+            component->build(std::move(bin));
+            components.push_back(component);
+        }
+        return components;
+    }
+};
+
+/**
+ * @brief Time Partitioning (tablas espacio-temporales)
+ * Ordena por la coordenada temporal y corta en componentes de hasta
+ * maxComponentSize registros que además no cruzan el borde de una ventana
+ * de tiempo. Los componentes de un nivel quedan disjuntos en el tiempo,
+ * así que una consulta por intervalo descarta por MBR los que no lo tocan.
+ */
+template<typename T>
+class TimePartitioning : public PartitioningStrategy<T> {
+private:
+    size_t timeDimension;
+    double window;      // Ancho de ventana (<= 0 = solo por tamaño)
+    
+public:
+    TimePartitioning(size_t timeDim, double windowSize)
+        : timeDimension(timeDim), window(windowSize) {}
+    
+    /**
+     * @brief Ventana a la que pertenece un instante
+     */
+    static int64_t windowOf(double time, double window) {
+        return window > 0.0 ? static_cast<int64_t>(std::floor(time / window)) : 0;
+    }
+    
+    std::vector<std::shared_ptr<LSMComponent<T>>> partition(
+        const std::vector<SpatialRecord<T>>& records,
+        size_t targetLevel,
+        size_t dimensions,
+        size_t maxComponentSize) const override {
+        
+        if (records.empty() || timeDimension >= dimensions) return {};
+        
+        std::vector<SpatialRecord<T>> sorted(records);
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [this](const SpatialRecord<T>& a, const SpatialRecord<T>& b) {
+                             return a.point[timeDimension] < b.point[timeDimension];
+                         });
+        
+        std::vector<std::shared_ptr<LSMComponent<T>>> components;
+        size_t maxSize = std::max<size_t>(1, maxComponentSize);
+        size_t begin = 0;
+        for (size_t i = 1; i <= sorted.size(); ++i) {
+            bool cut = i == sorted.size() || i - begin >= maxSize ||
+                       windowOf(sorted[i].point[timeDimension], window) !=
+                           windowOf(sorted[begin].point[timeDimension], window);
+            if (!cut) continue;
+            auto component = std::make_shared<LSMComponent<T>>(targetLevel, dimensions);
+            component->build(std::vector<SpatialRecord<T>>(sorted.begin() + begin, sorted.begin() + i));
+            components.push_back(component);
+            begin = i;
+        }
+        return components;
     }
 };
 
+/**
+ * @brief Crea una estrategia de particionado por nombre (Size, STR, RStarGrove)
+ * @param comparator Orden de Size partitioning: Simple o Hilbert
+ */
+template<typename T>
+std::shared_ptr<PartitioningStrategy<T>> makePartitioningStrategy(
+    const std::string& name, const std::string& comparator = "Simple", double sampleRatio = 0.1) {
+    if (comparator != "Simple" && comparator != "Hilbert") {
+        throw std::invalid_argument("Unknown comparator: " + comparator);
+    }
+    if (name == "Size") {
+        return std::make_shared<SizePartitioning<T>>(comparator == "Hilbert");
+    } else if (name == "STR") {
+        return std::make_shared<STRPartitioning<T>>();
+    } else if (name == "RStarGrove") {
+        return std::make_shared<RStarGrovePartitioning<T>>(sampleRatio);
+    }
+    throw std::invalid_argument("Unknown partitioning: " + name);
+}
+
 } // namespace lsm
@@ -0,0 +1,514 @@
+#pragma once
+
+#include "LSMTree.h"
+#include "ComponentBuilder.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef LSM_POSIX_IO
+#include <sys/mman.h>
+#endif
+
+namespace lsm {
+
+using namespace spatial;
+
+/**
+ * @brief Formatos de fichero de puntos que acepta PointLoader
+ *   CSV     x,y[,...][,data]; columnas y delimitador configurables
+ *   WKT     POINT(x y[ ...])[<delim>data], una geometría por línea
+ *   BINARY  registros fijos: dims doubles + int64 de payload, little-endian
+ */
+enum class PointFormat { CSV, WKT, BINARY };
+
+inline PointFormat parsePointFormat(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (name == "csv") return PointFormat::CSV;
+    if (name == "wkt") return PointFormat::WKT;
+    if (name == "binary" || name == "bin") return PointFormat::BINARY;
+    throw std::invalid_argument("Unknown load format: " + name);
+}
+
+struct PointLoaderOptions {
+    PointFormat format = PointFormat::CSV;
+    size_t dimensions = 2;
+    std::vector<size_t> coordinateColumns;  // CSV: columna de cada coordenada (vacío = 0..dims-1)
+    int dataColumn = -1;                    // CSV: columna del payload (-1 = tras las coordenadas, si existe)
+    char delimiter = ',';                   // CSV, y separador del payload en WKT
+    bool header = false;                    // Saltar la primera línea (CSV/WKT)
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkBytes = 8 * 1024 * 1024;    // Trozo del fichero que parsea cada tarea
+    bool bulk = false;                      // ComponentBuilder + ingesta en vez de inserts
+    size_t bulkRecords = 10000000;          // Registros por ronda de bulk load
+    std::string bulkDirectory = "./data/ingest";
+    size_t maxErrors = 0;                   // Líneas inválidas que se saltan antes de abortar
+};
+
+/**
+ * @brief Resumen de una carga
+ */
+struct PointLoadResult {
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    size_t chunks = 0;
+    size_t components = 0;                  // Ingeridos en modo bulk
+    uint64_t rejected = 0;                  // Líneas saltadas (hasta maxErrors)
+    std::vector<std::pair<uint64_t, std::string>> errors;  // (línea, motivo) de las primeras
+    double seconds = 0.0;
+
+    static constexpr size_t MAX_REPORTED_ERRORS = 10;
+
+    double recordsPerSecond() const { return seconds > 0.0 ? records / seconds : 0.0; }
+};
+
+/**
+ * @brief Fichero de solo lectura proyectado en memoria
+ * Sin POSIX se lee completo a un buffer.
+ */
+class MappedFile {
+private:
+    const char* begin = nullptr;
+    size_t length = 0;
+    std::vector<char> fallback;
+
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef LSM_POSIX_IO
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Cannot open " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat " + path);
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length > 0) {
+            void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Cannot mmap " + path);
+            }
+            ::madvise(mapped, length, MADV_SEQUENTIAL);
+            begin = static_cast<const char*>(mapped);
+        }
+        ::close(fd);
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("Cannot open " + path);
+        fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        begin = fallback.data();
+        length = fallback.size();
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef LSM_POSIX_IO
+        if (begin) ::munmap(const_cast<char*>(begin), length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return begin; }
+    size_t size() const { return length; }
+};
+
+/**
+ * @brief Cargador paralelo de ficheros de puntos
+ * El fichero se proyecta con mmap y se corta en trozos de chunkBytes
+ * alineados a fin de línea (o a registro en binario). Los hilos parsean
+ * trozos con std::from_chars, sin copias ni locale, mientras el hilo
+ * llamante entrega los registros en orden: inserts normales, o rondas de
+ * bulkRecords que ComponentBuilder convierte en componentes e
+ * ingestComponents() coloca directamente en el árbol (WA ≈ 1).
+ *
+ * Como mucho 2 × threads trozos parseados esperan a ser entregados, así
+ * que la memoria no depende del tamaño del fichero. Los errores indican
+ * la línea global: hasta maxErrors líneas inválidas se saltan y se
+ * informan; la siguiente aborta la carga con lo ya entregado escrito.
+ */
+template<typename T>
+class PointLoader {
+private:
+    struct Chunk {
+        const char* begin;
+        const char* end;
+    };
+
+    struct ChunkResult {
+        std::vector<SpatialRecord<T>> records;
+        size_t lines = 0;           // Líneas (o registros binarios) del trozo
+        std::vector<std::pair<size_t, std::string>> errors;  // (línea 1-based en el trozo, motivo)
+    };
+
+    PointLoaderOptions options;
+    std::vector<int> columnRole;    // CSV: índice de coordenada, dims = payload, -1 = ignorar
+
+    size_t binaryRecordBytes() const {
+        return options.dimensions * sizeof(double) + sizeof(int64_t);
+    }
+
+    static bool parseNumber(const char*& p, const char* end, double& value) {
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        if (p < end && *p == '+') ++p;
+        auto [next, ec] = std::from_chars(p, end, value);
+        if (ec != std::errc()) return false;
+        p = next;
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        return true;
+    }
+
+    /**
+     * @brief Campo CSV completo (sin comillas) convertido a número
+     */
+    static bool parseField(const char* begin, const char* end, double& value) {
+        const char* p = begin;
+        if (!parseNumber(p, end, value)) return false;
+        if (p < end && *p == '\r') ++p;
+        return p == end;
+    }
+
+    bool parseCSVLine(const char* p, const char* end, std::vector<double>& coords, double& data,
+                      bool& hasData, std::string& error) const {
+        size_t found = 0;
+        hasData = false;
+        for (size_t column = 0; p <= end && column < columnRole.size(); ++column) {
+            const char* fieldEnd = static_cast<const char*>(std::memchr(p, options.delimiter, end - p));
+            if (!fieldEnd) fieldEnd = end;
+            int role = columnRole[column];
+            if (role >= 0) {
+                double value;
+                if (!parseField(p, fieldEnd, value)) {
+                    error = "invalid number in column " + std::to_string(column + 1);
+                    return false;
+                }
+                if (static_cast<size_t>(role) == options.dimensions) {
+                    data = value;
+                    hasData = true;
+                } else {
+                    coords[role] = value;
+                    ++found;
+                }
+            }
+            p = fieldEnd + 1;
+        }
+        if (found < options.dimensions) {
+            error = "expected " + std::to_string(options.dimensions) + " coordinates";
+            return false;
+        }
+        return true;
+    }
+
+    bool parseWKTLine(const char* p, const char* end, std::vector<double>& coords, double& data,
+                      bool& hasData, std::string& error) const {
+        while (p < end && std::isspace(static_cast<unsigned char>(*p))) ++p;
+        static const char keyword[] = "POINT";
+        for (size_t i = 0; i < sizeof(keyword) - 1; ++i, ++p) {
+            if (p >= end || std::toupper(static_cast<unsigned char>(*p)) != keyword[i]) {
+                error = "expected POINT(...)";
+                return false;
+            }
+        }
+        // Admite "POINT Z (...)" y similares: se salta hasta el paréntesis
+        while (p < end && *p != '(') ++p;
+        if (p == end) {
+            error = "expected '(' after POINT";
+            return false;
+        }
+        ++p;
+        for (size_t d = 0; d < options.dimensions; ++d) {
+            if (!parseNumber(p, end, coords[d])) {
+                error = "invalid coordinate " + std::to_string(d + 1);
+                return false;
+            }
+        }
+        while (p < end && *p != ')') ++p;
+        if (p == end) {
+            error = "expected ')'";
+            return false;
+        }
+        ++p;
+        hasData = false;
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        if (p < end && *p == options.delimiter) {
+            ++p;
+            if (!parseField(p, end, data)) {
+                error = "invalid payload";
+                return false;
+            }
+            hasData = true;
+        }
+        return true;
+    }
+
+    ChunkResult parseText(const Chunk& chunk) const {
+        ChunkResult result;
+        std::vector<double> coords(options.dimensions);
+        std::string error;
+        const char* p = chunk.begin;
+
+        while (p < chunk.end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+            if (!lineEnd) lineEnd = chunk.end;
+            ++result.lines;
+
+            const char* contentEnd = lineEnd;
+            if (contentEnd > p && contentEnd[-1] == '\r') --contentEnd;
+            bool blank = true;
+            for (const char* c = p; c < contentEnd && blank; ++c) {
+                blank = std::isspace(static_cast<unsigned char>(*c)) != 0;
+            }
+
+            if (!blank && *p != '#') {
+                double data = 0.0;
+                bool hasData = false;
+                bool ok = options.format == PointFormat::WKT
+                    ? parseWKTLine(p, contentEnd, coords, data, hasData, error)
+                    : parseCSVLine(p, contentEnd, coords, data, hasData, error);
+                if (!ok) {
+                    result.errors.emplace_back(result.lines, error);
+                    // Superar maxErrors en un trozo ya aborta la carga: no hace falta seguir
+                    if (result.errors.size() > options.maxErrors) return result;
+                } else {
+                    result.records.emplace_back(Point(coords), hasData ? static_cast<T>(data) : T(),
+                                                false);
+                }
+            }
+            p = lineEnd + 1;
+        }
+        return result;
+    }
+
+    ChunkResult parseBinary(const Chunk& chunk) const {
+        ChunkResult result;
+        const size_t recordBytes = binaryRecordBytes();
+        std::vector<double> coords(options.dimensions);
+        result.records.reserve(static_cast<size_t>(chunk.end - chunk.begin) / recordBytes);
+
+        for (const char* p = chunk.begin; p + recordBytes <= chunk.end; p += recordBytes) {
+            std::memcpy(coords.data(), p, options.dimensions * sizeof(double));
+            int64_t data;
+            std::memcpy(&data, p + options.dimensions * sizeof(double), sizeof(data));
+            result.records.emplace_back(Point(coords), static_cast<T>(data), false);
+            ++result.lines;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Corta [data, data + size) en trozos de ~chunkBytes
+     * @param skippedLines Líneas saltadas al principio (cabecera)
+     */
+    std::vector<Chunk> splitChunks(const char* data, size_t size, size_t& skippedLines) const {
+        std::vector<Chunk> chunks;
+        const char* p = data;
+        const char* end = data + size;
+        skippedLines = 0;
+
+        if (options.format == PointFormat::BINARY) {
+            size_t recordBytes = binaryRecordBytes();
+            if (size % recordBytes != 0) {
+                throw std::runtime_error("Binary file size is not a multiple of the " +
+                                         std::to_string(recordBytes) + "-byte record");
+            }
+            size_t perChunk = std::max<size_t>(1, options.chunkBytes / recordBytes) * recordBytes;
+            for (; p < end; p += std::min<size_t>(perChunk, end - p)) {
+                chunks.push_back({p, p + std::min<size_t>(perChunk, end - p)});
+            }
+            return chunks;
+        }
+
+        if (options.header && p < end) {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            p = nl ? nl + 1 : end;
+            skippedLines = 1;
+        }
+        while (p < end) {
+            const char* cut = p + std::min<size_t>(std::max<size_t>(1, options.chunkBytes), end - p);
+            if (cut < end) {
+                const char* nl = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+                cut = nl ? nl + 1 : end;
+            }
+            chunks.push_back({p, cut});
+            p = cut;
+        }
+        return chunks;
+    }
+
+    void bulkIngest(std::vector<SpatialRecord<T>>& pending, LSMTree<T>& tree,
+                    PointLoadResult& result) const {
+        if (pending.empty()) return;
+        typename ComponentBuilder<T>::Options builderOptions;
+        builderOptions.outputDirectory = options.bulkDirectory;
+        builderOptions.dimensions = options.dimensions;
+        std::filesystem::create_directories(options.bulkDirectory);
+
+        auto files = ComponentBuilder<T>(builderOptions).build(pending);
+        if (files.empty()) {
+            throw std::runtime_error("Bulk load produced no components");
+        }
+        result.components += tree.ingestComponents(files);
+        // ingestComponents copia (MANIFEST) o carga en memoria: el fichero intermedio sobra
+        for (const auto& file : files) {
+            std::error_code ec;
+            std::filesystem::remove(file, ec);
+        }
+        pending.clear();
+    }
+
+public:
+    explicit PointLoader(const PointLoaderOptions& opts = PointLoaderOptions()) : options(opts) {
+        if (options.dimensions == 0) throw std::invalid_argument("Loader needs at least one dimension");
+        options.threads = std::max<size_t>(1, options.threads);
+
+        if (options.format == PointFormat::CSV) {
+            std::vector<size_t> coordinates = options.coordinateColumns;
+            if (coordinates.empty()) {
+                for (size_t d = 0; d < options.dimensions; ++d) coordinates.push_back(d);
+            }
+            if (coordinates.size() != options.dimensions) {
+                throw std::invalid_argument("Expected " + std::to_string(options.dimensions) +
+                                            " coordinate columns");
+            }
+            size_t dataColumn = options.dataColumn >= 0
+                ? static_cast<size_t>(options.dataColumn)
+                : *std::max_element(coordinates.begin(), coordinates.end()) + 1;
+            columnRole.assign(std::max(dataColumn, *std::max_element(coordinates.begin(),
+                                                                     coordinates.end())) + 1, -1);
+            for (size_t d = 0; d < coordinates.size(); ++d) {
+                if (columnRole[coordinates[d]] != -1) {
+                    throw std::invalid_argument("Column " + std::to_string(coordinates[d]) +
+                                                " used twice");
+                }
+                columnRole[coordinates[d]] = static_cast<int>(d);
+            }
+            if (columnRole[dataColumn] != -1) {
+                throw std::invalid_argument("Payload column overlaps a coordinate column");
+            }
+            columnRole[dataColumn] = static_cast<int>(options.dimensions);
+        }
+    }
+
+    /**
+     * @brief Carga path en tree
+     */
+    PointLoadResult load(const std::string& path, LSMTree<T>& tree) const {
+        using Clock = std::chrono::steady_clock;
+        auto start = Clock::now();
+
+        MappedFile file(path);
+        size_t lineOffset = 0;
+        auto chunks = splitChunks(file.data(), file.size(), lineOffset);
+
+        PointLoadResult result;
+        result.bytes = file.size();
+        result.chunks = chunks.size();
+
+        std::vector<ChunkResult> parsed(chunks.size());
+        std::vector<bool> ready(chunks.size(), false);
+        size_t nextChunk = 0;
+        size_t delivered = 0;
+        bool cancelled = false;
+        const size_t window = 2 * options.threads;
+        std::mutex mutex;
+        std::condition_variable canParse, parsedOne;
+
+        auto worker = [&]() {
+            for (;;) {
+                size_t i;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    canParse.wait(lock, [&]() {
+                        return cancelled || nextChunk >= chunks.size() || nextChunk < delivered + window;
+                    });
+                    if (cancelled || nextChunk >= chunks.size()) return;
+                    i = nextChunk++;
+                }
+                ChunkResult r = options.format == PointFormat::BINARY ? parseBinary(chunks[i])
+                                                                      : parseText(chunks[i]);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    parsed[i] = std::move(r);
+                    ready[i] = true;
+                }
+                parsedOne.notify_all();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        size_t threads = std::min(options.threads, std::max<size_t>(1, chunks.size()));
+        for (size_t t = 0; t < threads; ++t) workers.emplace_back(worker);
+
+        auto stopWorkers = [&]() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                cancelled = true;
+            }
+            canParse.notify_all();
+            for (auto& w : workers) {
+                if (w.joinable()) w.join();
+            }
+        };
+
+        try {
+            std::vector<SpatialRecord<T>> pending;
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                ChunkResult chunk;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    parsedOne.wait(lock, [&]() { return ready[i]; });
+                    chunk = std::move(parsed[i]);
+                    ++delivered;
+                }
+                canParse.notify_all();
+
+                for (const auto& [line, error] : chunk.errors) {
+                    uint64_t globalLine = lineOffset + line;
+                    if (++result.rejected > options.maxErrors) {
+                        // El trozo con el error se descarta entero
+                        throw std::runtime_error(path + ": line " + std::to_string(globalLine) + ": " +
+                                                 error + " (" + std::to_string(result.records) +
+                                                 " records loaded before the error)");
+                    }
+                    if (result.errors.size() < PointLoadResult::MAX_REPORTED_ERRORS) {
+                        result.errors.emplace_back(globalLine, error);
+                    }
+                }
+                lineOffset += chunk.lines;
+                result.records += chunk.records.size();
+
+                if (options.bulk) {
+                    std::move(chunk.records.begin(), chunk.records.end(), std::back_inserter(pending));
+                    if (pending.size() >= options.bulkRecords) bulkIngest(pending, tree, result);
+                } else {
+                    tree.insertBatch(chunk.records);
+                }
+            }
+            bulkIngest(pending, tree, result);
+        } catch (...) {
+            stopWorkers();
+            throw;
+        }
+        stopWorkers();
+
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return result;
+    }
+};
+
+} // namespace lsm
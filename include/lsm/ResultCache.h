@@ -0,0 +1,311 @@
+#pragma once
+
+#include "../spatial/MBR.h"
+#include "../spatial/Point.h"
+#include "../spatial/SpatialComparators.h"
+#include <list>
+#include <string>
+#include <iterator>
+#include <functional>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace lsm {
+
+using namespace spatial;
+
+/**
+ * @brief Caché de resultados de consultas espaciales
+ * Clave: MBR de la consulta + tipo (filas o COUNT). Presupuesto de memoria
+ * con expulsión LRU. Invalidación precisa: una escritura en p solo expulsa
+ * entradas cuyo box contiene p; una ingesta de rango, las que lo intersectan.
+ * Flush y merge no invalidan (no cambian resultados).
+ *
+ * Las entradas se indexan en una rejilla uniforme sobre las dos primeras
+ * dimensiones para que la invalidación no recorra toda la caché.
+ */
+template<typename T>
+class SpatialResultCache {
+public:
+    enum class QueryKind : uint8_t { ROWS, COUNT };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t invalidations = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t memoryUsage = 0;
+    };
+
+private:
+    using CellKey = std::pair<int64_t, int64_t>;
+
+    struct CellHash {
+        size_t operator()(const CellKey& c) const {
+            return std::hash<int64_t>()(c.first) ^ (std::hash<int64_t>()(c.second) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    struct Entry {
+        std::string key;
+        MBR box;
+        QueryKind kind;
+        std::vector<SpatialRecord<T>> rows;
+        size_t count = 0;
+        size_t bytes = 0;
+        bool large = false;                // Demasiadas celdas: lista aparte
+        std::vector<CellKey> cells;
+    };
+
+    using EntryList = std::list<Entry>;   // Frente = más reciente (LRU)
+
+    size_t budgetBytes;
+    double cellSize;
+    size_t maxCellsPerEntry;
+    EntryList lru;
+    std::unordered_map<std::string, typename EntryList::iterator> index;
+    std::unordered_map<CellKey, std::unordered_set<Entry*>, CellHash> grid;
+    std::unordered_set<Entry*> largeEntries;
+    size_t memoryUsed;
+    uint64_t generation;                  // Se incrementa con cada escritura notificada
+    Stats stats;
+    mutable std::mutex mutex;
+
+    static std::string makeKey(const MBR& box, QueryKind kind) {
+        std::string key(1, static_cast<char>(kind));
+        for (size_t d = 0; d < box.dimensions(); ++d) {
+            double lo = box.getLower()[d], hi = box.getUpper()[d];
+            key.append(reinterpret_cast<const char*>(&lo), sizeof(lo));
+            key.append(reinterpret_cast<const char*>(&hi), sizeof(hi));
+        }
+        return key;
+    }
+
+    int64_t cellOf(double v) const {
+        return static_cast<int64_t>(std::floor(v / cellSize));
+    }
+
+    void indexEntry(Entry& e) {
+        if (e.box.dimensions() < 2) {
+            e.large = true;
+            largeEntries.insert(&e);
+            return;
+        }
+        int64_t x0 = cellOf(e.box.getLower()[0]), x1 = cellOf(e.box.getUpper()[0]);
+        int64_t y0 = cellOf(e.box.getLower()[1]), y1 = cellOf(e.box.getUpper()[1]);
+        double cells = (static_cast<double>(x1 - x0) + 1) * (static_cast<double>(y1 - y0) + 1);
+        if (!(cells <= static_cast<double>(maxCellsPerEntry))) {
+            e.large = true;
+            largeEntries.insert(&e);
+            return;
+        }
+        for (int64_t x = x0; x <= x1; ++x) {
+            for (int64_t y = y0; y <= y1; ++y) {
+                e.cells.emplace_back(x, y);
+                grid[{x, y}].insert(&e);
+            }
+        }
+    }
+
+    void eraseLocked(typename EntryList::iterator it) {
+        Entry& e = *it;
+        if (e.large) {
+            largeEntries.erase(&e);
+        } else {
+            for (const auto& c : e.cells) {
+                auto g = grid.find(c);
+                if (g == grid.end()) continue;
+                g->second.erase(&e);
+                if (g->second.empty()) grid.erase(g);
+            }
+        }
+        memoryUsed -= e.bytes;
+        index.erase(e.key);
+        lru.erase(it);
+    }
+
+    template<typename Pred>
+    void invalidateLocked(std::vector<Entry*> candidates, Pred matches) {
+        size_t removed = 0;
+        for (Entry* e : candidates) {
+            if (!matches(*e)) continue;
+            auto it = index.find(e->key);
+            if (it == index.end()) continue;
+            eraseLocked(it->second);
+            ++removed;
+        }
+        stats.invalidations += removed;
+    }
+
+    std::vector<Entry*> candidatesForCells(int64_t x0, int64_t x1, int64_t y0, int64_t y1) const {
+        std::unordered_set<Entry*> found(largeEntries.begin(), largeEntries.end());
+        double cells = (static_cast<double>(x1 - x0) + 1) * (static_cast<double>(y1 - y0) + 1);
+        if (cells > static_cast<double>(grid.size())) {
+            // Rango grande: recorrer la rejilla es más barato que las celdas
+            for (const auto& [cell, entries] : grid) {
+                if (cell.first >= x0 && cell.first <= x1 && cell.second >= y0 && cell.second <= y1) {
+                    found.insert(entries.begin(), entries.end());
+                }
+            }
+        } else {
+            for (int64_t x = x0; x <= x1; ++x) {
+                for (int64_t y = y0; y <= y1; ++y) {
+                    auto g = grid.find({x, y});
+                    if (g != grid.end()) found.insert(g->second.begin(), g->second.end());
+                }
+            }
+        }
+        return std::vector<Entry*>(found.begin(), found.end());
+    }
+
+    void putLocked(Entry&& entry) {
+        auto existing = index.find(entry.key);
+        if (existing != index.end()) eraseLocked(existing->second);
+
+        if (entry.bytes > budgetBytes) return;
+        while (memoryUsed + entry.bytes > budgetBytes && !lru.empty()) {
+            eraseLocked(std::prev(lru.end()));
+            ++stats.evictions;
+        }
+
+        lru.push_front(std::move(entry));
+        Entry& stored = lru.front();
+        index[stored.key] = lru.begin();
+        memoryUsed += stored.bytes;
+        indexEntry(stored);
+    }
+
+public:
+    explicit SpatialResultCache(size_t budget = 64 * 1024 * 1024, double cell = 0.01,
+                                size_t maxCells = 256)
+        : budgetBytes(budget), cellSize(cell > 0.0 ? cell : 0.01), maxCellsPerEntry(maxCells),
+          memoryUsed(0), generation(0) {}
+
+    /**
+     * @brief Generación actual; se captura antes de ejecutar una consulta
+     * y put() descarta el resultado si hubo invalidaciones entre medias.
+     */
+    uint64_t currentGeneration() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return generation;
+    }
+
+    bool getRows(const MBR& box, std::vector<SpatialRecord<T>>& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(makeKey(box, QueryKind::ROWS));
+        if (it == index.end()) {
+            ++stats.misses;
+            return false;
+        }
+        lru.splice(lru.begin(), lru, it->second);
+        out = it->second->rows;
+        ++stats.hits;
+        return true;
+    }
+
+    bool getCount(const MBR& box, size_t& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(makeKey(box, QueryKind::COUNT));
+        if (it == index.end()) {
+            ++stats.misses;
+            return false;
+        }
+        lru.splice(lru.begin(), lru, it->second);
+        out = it->second->count;
+        ++stats.hits;
+        return true;
+    }
+
+    void putRows(const MBR& box, const std::vector<SpatialRecord<T>>& rows, uint64_t observedGeneration) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (observedGeneration != generation) return;
+
+        Entry e;
+        e.key = makeKey(box, QueryKind::ROWS);
+        e.box = box;
+        e.kind = QueryKind::ROWS;
+        e.rows = rows;
+        e.bytes = sizeof(Entry) + e.key.size() +
+                  rows.size() * (sizeof(SpatialRecord<T>) + box.dimensions() * sizeof(double));
+        putLocked(std::move(e));
+    }
+
+    void putCount(const MBR& box, size_t count, uint64_t observedGeneration) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (observedGeneration != generation) return;
+
+        Entry e;
+        e.key = makeKey(box, QueryKind::COUNT);
+        e.box = box;
+        e.kind = QueryKind::COUNT;
+        e.count = count;
+        e.bytes = sizeof(Entry) + e.key.size();
+        putLocked(std::move(e));
+    }
+
+    /**
+     * @brief Invalida las entradas cuyo box contiene el punto escrito
+     */
+    void invalidatePoint(const Point& p) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++generation;  // Consultas en vuelo no deben cachear un resultado previo
+        if (lru.empty()) return;
+        if (p.dimensions() < 2) {
+            invalidateLocked(std::vector<Entry*>(largeEntries.begin(), largeEntries.end()),
+                             [&p](const Entry& e) { return e.box.contains(p); });
+            return;
+        }
+        int64_t x = cellOf(p[0]), y = cellOf(p[1]);
+        invalidateLocked(candidatesForCells(x, x, y, y),
+                         [&p](const Entry& e) { return e.box.contains(p); });
+    }
+
+    /**
+     * @brief Invalida las entradas cuyo box intersecta el rango afectado
+     */
+    void invalidateRange(const MBR& range) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++generation;
+        if (lru.empty()) return;
+        if (range.dimensions() < 2) {
+            clearLocked();
+            return;
+        }
+        invalidateLocked(candidatesForCells(cellOf(range.getLower()[0]), cellOf(range.getUpper()[0]),
+                                            cellOf(range.getLower()[1]), cellOf(range.getUpper()[1])),
+                         [&range](const Entry& e) { return e.box.intersects(range); });
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        clearLocked();
+    }
+
+    Stats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats s = stats;
+        s.entries = lru.size();
+        s.memoryUsage = memoryUsed;
+        return s;
+    }
+
+private:
+    void clearLocked() {
+        stats.invalidations += lru.size();
+        lru.clear();
+        index.clear();
+        grid.clear();
+        largeEntries.clear();
+        memoryUsed = 0;
+        ++generation;
+    }
+};
+
+} // namespace lsm
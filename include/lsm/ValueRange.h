@@ -0,0 +1,60 @@
+#pragma once
+
+#include <limits>
+
+namespace lsm {
+
+/**
+ * @brief Intervalo de payloads que admite una conjunción de comparaciones
+ * Cada comparación (=, <, <=, >, >=) estrecha los extremos. Un zone map
+ * [min, max] de nodo o componente que no lo intersecta no tiene ningún
+ * registro que cumpla el predicado.
+ */
+struct ValueRange {
+    double lower = -std::numeric_limits<double>::infinity();
+    double upper = std::numeric_limits<double>::infinity();
+    bool lowerInclusive = true;
+    bool upperInclusive = true;
+
+    bool unbounded() const {
+        return lower == -std::numeric_limits<double>::infinity() &&
+               upper == std::numeric_limits<double>::infinity();
+    }
+
+    void atLeast(double value, bool inclusive) {
+        if (value > lower || (value == lower && !inclusive)) {
+            lower = value;
+            lowerInclusive = inclusive;
+        }
+    }
+
+    void atMost(double value, bool inclusive) {
+        if (value < upper || (value == upper && !inclusive)) {
+            upper = value;
+            upperInclusive = inclusive;
+        }
+    }
+
+    bool contains(double value) const {
+        return (value > lower || (lowerInclusive && value == lower)) &&
+               (value < upper || (upperInclusive && value == upper));
+    }
+
+    /**
+     * @brief ¿Algún valor de [min, max] lo cumple? (min > max = zona vacía)
+     */
+    bool overlaps(double min, double max) const {
+        if (min > max) return false;
+        return (max > lower || (lowerInclusive && max == lower)) &&
+               (min < upper || (upperInclusive && min == upper));
+    }
+
+    /**
+     * @brief ¿Lo cumple todo [min, max]?
+     */
+    bool covers(double min, double max) const {
+        return min > max || (contains(min) && contains(max));
+    }
+};
+
+} // namespace lsm
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <algorithm>
+
+namespace lsm {
+
+/**
+ * @brief Gestor global de write buffers
+ * Comparte un único presupuesto de memoria entre las MemTables de todas
+ * las tablas. Cada MemTable reporta su uso exacto; al alcanzar el
+ * presupuesto se fuerza el flush de las más grandes o las más antiguas.
+ */
+class WriteBufferManager {
+public:
+    enum class FlushPolicy { LARGEST, OLDEST };
+
+    struct Options {
+        size_t bufferSize;          // Presupuesto total en bytes (0 = sin límite)
+        double flushTriggerRatio;   // Fracción del presupuesto que dispara flush
+        FlushPolicy policy;
+        // Cargo opcional al block cache: recibe deltas de bytes (+reserva/-libera)
+        std::function<void(int64_t)> cacheCharge;
+
+        Options() : bufferSize(256 * 1024 * 1024), flushTriggerRatio(0.9),
+                    policy(FlushPolicy::LARGEST) {}
+    };
+
+    using BufferId = uint64_t;
+
+private:
+    struct Entry {
+        std::string name;
+        size_t usage = 0;
+        uint64_t firstWriteSeq = 0;   // 0 = MemTable vacía
+        std::function<void()> flush;
+        size_t inFlight = 0;          // Flushes forzados en curso (sin mutex)
+        bool closing = false;         // unregisterBuffer esperando a inFlight
+    };
+
+    Options options;
+    std::map<BufferId, Entry> buffers;
+    std::atomic<size_t> memoryUsed;
+    BufferId nextId;
+    uint64_t writeSeq;
+    uint64_t forcedFlushes;
+    mutable std::mutex mutex;
+    std::condition_variable flushDone;
+
+    bool overTrigger() const {
+        return options.bufferSize > 0 &&
+               memoryUsed.load(std::memory_order_relaxed) >=
+                   static_cast<size_t>(options.bufferSize * options.flushTriggerRatio);
+    }
+
+    /**
+     * @brief Elige la MemTable víctima según la política. Requiere mutex.
+     * @return buffers.end() si no hay ninguna con datos
+     */
+    std::map<BufferId, Entry>::iterator pickVictimLocked() {
+        auto victim = buffers.end();
+        for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+            const Entry& entry = it->second;
+            if (entry.usage == 0 || entry.closing) continue;
+            if (victim == buffers.end()) {
+                victim = it;
+            } else if (options.policy == FlushPolicy::LARGEST) {
+                if (entry.usage > victim->second.usage) victim = it;
+            } else if (entry.firstWriteSeq < victim->second.firstWriteSeq) {
+                victim = it;
+            }
+        }
+        return victim;
+    }
+
+public:
+    explicit WriteBufferManager(const Options& opts = Options())
+        : options(opts), memoryUsed(0), nextId(1), writeSeq(0), forcedFlushes(0) {}
+
+    /**
+     * @brief Registra una MemTable con su callback de flush
+     */
+    BufferId registerBuffer(const std::string& name, std::function<void()> flush) {
+        std::lock_guard<std::mutex> lock(mutex);
+        BufferId id = nextId++;
+        buffers[id].name = name;
+        buffers[id].flush = std::move(flush);
+        return id;
+    }
+
+    /**
+     * @brief Da de baja una MemTable
+     * Espera a los flushes forzados en curso sobre ella: su callback apunta
+     * a la tabla, que puede destruirse en cuanto esto retorne.
+     */
+    void unregisterBuffer(BufferId id) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = buffers.find(id);
+        if (it == buffers.end()) return;
+        it->second.closing = true;
+        flushDone.wait(lock, [&it]() { return it->second.inFlight == 0; });
+        memoryUsed.fetch_sub(it->second.usage, std::memory_order_relaxed);
+        if (options.cacheCharge) options.cacheCharge(-static_cast<int64_t>(it->second.usage));
+        buffers.erase(it);
+    }
+
+    /**
+     * @brief Aplica un delta de memoria reportado por una MemTable
+     */
+    void charge(BufferId id, int64_t delta) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = buffers.find(id);
+        if (it == buffers.end() || delta == 0) return;
+
+        Entry& entry = it->second;
+        if (delta > 0) {
+            if (entry.usage == 0) entry.firstWriteSeq = ++writeSeq;
+            entry.usage += static_cast<size_t>(delta);
+            memoryUsed.fetch_add(static_cast<size_t>(delta), std::memory_order_relaxed);
+        } else {
+            size_t freed = std::min(entry.usage, static_cast<size_t>(-delta));
+            entry.usage -= freed;
+            if (entry.usage == 0) entry.firstWriteSeq = 0;
+            memoryUsed.fetch_sub(freed, std::memory_order_relaxed);
+            delta = -static_cast<int64_t>(freed);
+        }
+
+        if (options.cacheCharge) options.cacheCharge(delta);
+    }
+
+    /**
+     * @brief Fuerza flushes hasta quedar por debajo del umbral
+     * Los callbacks se invocan sin el mutex tomado (flush → charge()); la
+     * entrada queda marcada en curso para que unregisterBuffer no deje
+     * destruir la tabla mientras tanto.
+     */
+    void enforceBudget() {
+        // Cota de iteraciones: cada flush vacía una MemTable registrada
+        size_t attempts = 0;
+        while (overTrigger()) {
+            BufferId id;
+            std::function<void()> flush;
+            size_t registered;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto victim = pickVictimLocked();
+                registered = buffers.size();
+                if (victim == buffers.end() || ++attempts > registered) break;
+                id = victim->first;
+                flush = victim->second.flush;
+                victim->second.inFlight++;
+                ++forcedFlushes;
+            }
+
+            struct Release {
+                WriteBufferManager* manager;
+                BufferId id;
+                ~Release() {
+                    {
+                        std::lock_guard<std::mutex> lock(manager->mutex);
+                        auto it = manager->buffers.find(id);
+                        if (it != manager->buffers.end()) it->second.inFlight--;
+                    }
+                    manager->flushDone.notify_all();
+                }
+            } release{this, id};
+            flush();
+        }
+    }
+
+    bool shouldFlush() const { return overTrigger(); }
+    size_t memoryUsage() const { return memoryUsed.load(std::memory_order_relaxed); }
+    size_t bufferSize() const { return options.bufferSize; }
+
+    uint64_t getForcedFlushes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return forcedFlushes;
+    }
+
+    /**
+     * @brief Uso por MemTable (nombre → bytes)
+     */
+    std::vector<std::pair<std::string, size_t>> usageByBuffer() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::pair<std::string, size_t>> out;
+        for (const auto& [id, entry] : buffers) {
+            out.emplace_back(entry.name, entry.usage);
+        }
+        return out;
+    }
+};
+
+} // namespace lsm
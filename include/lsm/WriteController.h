@@ -0,0 +1,230 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <functional>
+
+namespace lsm {
+
+/**
+ * @brief Umbrales del controlador de escrituras
+ * Cada señal tiene un umbral de ralentización (slowdown) y uno de parada (stop).
+ */
+struct WriteControllerOptions {
+    size_t l0SlowdownTrigger;              // Componentes en nivel 0
+    size_t l0StopTrigger;
+    size_t immutableSlowdownTrigger;       // MemTables inmutables pendientes de flush
+    size_t immutableStopTrigger;
+    uint64_t pendingCompactionSlowdownBytes;
+    uint64_t pendingCompactionStopBytes;
+    uint64_t maxDelayedWriteRate;          // bytes/s al entrar en slowdown
+    uint64_t minDelayedWriteRate;          // bytes/s cerca del umbral de parada
+    std::chrono::milliseconds maxStopWait; // 0 = esperar indefinidamente
+
+    WriteControllerOptions()
+        : l0SlowdownTrigger(20), l0StopTrigger(36),
+          immutableSlowdownTrigger(2), immutableStopTrigger(4),
+          pendingCompactionSlowdownBytes(64ull * 1024 * 1024 * 1024),
+          pendingCompactionStopBytes(256ull * 1024 * 1024 * 1024),
+          maxDelayedWriteRate(16ull * 1024 * 1024),
+          minDelayedWriteRate(16ull * 1024),
+          maxStopWait(0) {}
+};
+
+/**
+ * @brief Control de backpressure (write stall)
+ * Limita cuánto pueden adelantarse los flushes a los merges: aplica
+ * retardos graduales (token bucket) y después paradas duras a insert.
+ */
+class WriteController {
+public:
+    enum class State { NORMAL, DELAYED, STOPPED };
+
+    /**
+     * @brief Estado observable del controlador (para métricas)
+     */
+    struct Stats {
+        State state = State::NORMAL;
+        size_t l0Components = 0;
+        size_t immutableMemTables = 0;
+        uint64_t pendingCompactionBytes = 0;
+        uint64_t currentDelayedRate = 0;
+        uint64_t delayedWrites = 0;
+        uint64_t stoppedWrites = 0;
+        uint64_t stopTimeouts = 0;
+        uint64_t totalDelayMicros = 0;
+        uint64_t totalStopMicros = 0;
+    };
+
+private:
+    WriteControllerOptions options;
+    Stats stats;
+    double availableBytes;  // Tokens del bucket
+    std::chrono::steady_clock::time_point lastRefill;
+    mutable std::mutex mutex;
+    std::condition_variable stateChanged;
+
+    static double severity(double value, double slowdown, double stop) {
+        if (value < slowdown) return 0.0;
+        if (stop <= slowdown) return 1.0;
+        return std::min(1.0, (value - slowdown) / (stop - slowdown));
+    }
+
+    void recomputeState() {
+        const auto& o = options;
+        bool stop = stats.l0Components >= o.l0StopTrigger ||
+                    stats.immutableMemTables >= o.immutableStopTrigger ||
+                    stats.pendingCompactionBytes >= o.pendingCompactionStopBytes;
+
+        double s = std::max({
+            severity(static_cast<double>(stats.l0Components),
+                     static_cast<double>(o.l0SlowdownTrigger), static_cast<double>(o.l0StopTrigger)),
+            severity(static_cast<double>(stats.immutableMemTables),
+                     static_cast<double>(o.immutableSlowdownTrigger),
+                     static_cast<double>(o.immutableStopTrigger)),
+            severity(static_cast<double>(stats.pendingCompactionBytes),
+                     static_cast<double>(o.pendingCompactionSlowdownBytes),
+                     static_cast<double>(o.pendingCompactionStopBytes))});
+
+        bool slowdown = stats.l0Components >= o.l0SlowdownTrigger ||
+                        stats.immutableMemTables >= o.immutableSlowdownTrigger ||
+                        stats.pendingCompactionBytes >= o.pendingCompactionSlowdownBytes;
+
+        if (stop) {
+            stats.state = State::STOPPED;
+            stats.currentDelayedRate = 0;
+        } else if (slowdown) {
+            // Ritmo graduado: interpolación geométrica entre max y min según la deuda
+            double ratio = static_cast<double>(o.minDelayedWriteRate) /
+                           static_cast<double>(std::max<uint64_t>(1, o.maxDelayedWriteRate));
+            double rate = static_cast<double>(o.maxDelayedWriteRate) * std::pow(ratio, s);
+            stats.state = State::DELAYED;
+            stats.currentDelayedRate = std::max<uint64_t>(1, static_cast<uint64_t>(rate));
+        } else {
+            stats.state = State::NORMAL;
+            stats.currentDelayedRate = 0;
+        }
+    }
+
+public:
+    explicit WriteController(const WriteControllerOptions& opts = WriteControllerOptions())
+        : options(opts), availableBytes(0.0), lastRefill(std::chrono::steady_clock::now()) {}
+
+    /**
+     * @brief Actualiza las señales de deuda (tras flush o merge)
+     */
+    void update(size_t l0Components, size_t immutableMemTables, uint64_t pendingCompactionBytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.l0Components = l0Components;
+            stats.immutableMemTables = immutableMemTables;
+            stats.pendingCompactionBytes = pendingCompactionBytes;
+            recomputeState();
+        }
+        stateChanged.notify_all();
+    }
+
+    /**
+     * @brief Aplica backpressure antes de una escritura de 'bytes'
+     * NORMAL: no espera. DELAYED: consume tokens y duerme si faltan.
+     * STOPPED: el escritor parado ejecuta drain (compactación) sin el lock
+     * mientras avance; si no avanza, bloquea hasta que cambie el estado o
+     * venza maxStopWait.
+     * @param drain Reduce la deuda; devuelve false si no pudo hacer nada
+     */
+    void throttle(uint64_t bytes, const std::function<bool()>& drain = nullptr) {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (stats.state == State::STOPPED) {
+            ++stats.stoppedWrites;
+            auto start = std::chrono::steady_clock::now();
+            auto notStopped = [this]() { return stats.state != State::STOPPED; };
+
+            while (stats.state == State::STOPPED) {
+                if (drain) {
+                    lock.unlock();
+                    bool progressed = drain();
+                    lock.lock();
+                    if (progressed) continue;
+                }
+                if (options.maxStopWait.count() == 0) {
+                    stateChanged.wait(lock, notStopped);
+                } else if (!stateChanged.wait_for(lock, options.maxStopWait, notStopped)) {
+                    ++stats.stopTimeouts;
+                    break;
+                }
+            }
+
+            stats.totalStopMicros += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+
+        if (stats.state != State::DELAYED) {
+            return;
+        }
+
+        // Token bucket: recarga según el ritmo actual
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+        lastRefill = now;
+        double rate = static_cast<double>(stats.currentDelayedRate);
+        availableBytes = std::min(availableBytes + elapsed * rate, rate);  // ráfaga máx. 1 s
+        availableBytes -= static_cast<double>(bytes);
+
+        if (availableBytes >= 0.0) {
+            return;
+        }
+
+        auto delay = std::chrono::microseconds(
+            static_cast<int64_t>(-availableBytes / rate * 1e6));
+        ++stats.delayedWrites;
+        stats.totalDelayMicros += delay.count();
+
+        lock.unlock();
+        std::this_thread::sleep_for(delay);
+    }
+
+    /**
+     * @brief Reemplaza los umbrales y reevalúa el estado
+     */
+    void setOptions(const WriteControllerOptions& opts) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            options = opts;
+            recomputeState();
+        }
+        stateChanged.notify_all();
+    }
+
+    State getState() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats.state;
+    }
+
+    Stats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+    WriteControllerOptions getOptions() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return options;
+    }
+
+    static std::string stateName(State state) {
+        switch (state) {
+            case State::NORMAL:  return "normal";
+            case State::DELAYED: return "delayed";
+            case State::STOPPED: return "stopped";
+        }
+        return "unknown";
+    }
+};
+
+} // namespace lsm
@@ -50,8 +50,11 @@ public:
      * @brief Verifica si el MBR contiene un punto
      */
     bool contains(const Point& point) const {
-        // TODO: Implementar verificación de contención
-        return false;
+        if (point.dimensions() != dimensions()) return false;
+        for (size_t i = 0; i < dimensions(); ++i) {
+            if (point[i] < lower[i] || point[i] > upper[i]) return false;
+        }
+        return true;
     }
     
     /**
@@ -59,53 +62,86 @@ public:
      * Usado para filtrado en búsquedas espaciales
      */
     bool intersects(const MBR& other) const {
-        // TODO: Implementar verificación de intersección
-        return false;
+        if (other.dimensions() != dimensions()) return false;
+        for (size_t i = 0; i < dimensions(); ++i) {
+            if (other.upper[i] < lower[i] || other.lower[i] > upper[i]) return false;
+        }
+        return true;
     }
     
     /**
      * @brief Expande este MBR para incluir un punto
      */
     void expand(const Point& point) {
-        // TODO: Implementar expansión para incluir punto
+        if (dimensions() == 0) {
+            lower = point;
+            upper = point;
+            return;
+        }
+        for (size_t i = 0; i < dimensions(); ++i) {
+            lower[i] = std::min(lower[i], point[i]);
+            upper[i] = std::max(upper[i], point[i]);
+        }
     }
     
     /**
      * @brief Expande este MBR para incluir otro MBR
      */
     void expand(const MBR& other) {
-        // TODO: Implementar expansión para incluir otro MBR
+        if (!other.isValid()) return;
+        if (!isValid()) {
+            *this = other;
+            return;
+        }
+        for (size_t i = 0; i < dimensions(); ++i) {
+            lower[i] = std::min(lower[i], other.lower[i]);
+            upper[i] = std::max(upper[i], other.upper[i]);
+        }
     }
     
     /**
      * @brief Calcula el área (volumen en D dimensiones)
      */
     double area() const {
-        // TODO: Implementar cálculo de área/volumen
-        return 0.0;
+        if (!isValid()) return 0.0;
+        double result = 1.0;
+        for (size_t i = 0; i < dimensions(); ++i) {
+            result *= upper[i] - lower[i];
+        }
+        return result;
     }
     
     /**
      * @brief Calcula el perímetro (margen en D dimensiones)
      */
     double perimeter() const {
-        // TODO: Implementar cálculo de perímetro/margen
-        return 0.0;
+        if (!isValid()) return 0.0;
+        double result = 0.0;
+        for (size_t i = 0; i < dimensions(); ++i) {
+            result += upper[i] - lower[i];
+        }
+        return 2.0 * result;
     }
     
     /**
      * @brief Calcula el centro del MBR
      */
     Point center() const {
-        // TODO: Implementar cálculo del centro
-        return Point();
+        Point c(dimensions());
+        for (size_t i = 0; i < dimensions(); ++i) {
+            c[i] = (lower[i] + upper[i]) / 2.0;
+        }
+        return c;
     }
     
     /**
      * @brief Verifica si el MBR es válido (no vacío)
      */
     bool isValid() const {
-        // TODO: Implementar verificación de validez
+        if (dimensions() == 0 || lower.dimensions() != upper.dimensions()) return false;
+        for (size_t i = 0; i < dimensions(); ++i) {
+            if (lower[i] > upper[i]) return false;
+        }
         return true;
     }
 };
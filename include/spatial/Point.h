@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <initializer_list>
 #include <cmath>
 #include <stdexcept>
 
@@ -15,30 +16,37 @@ private:
     std::vector<double> coords;
     
 public:
-    // TODO: Implementar constructores
     Point() : coords() {}
-    explicit Point(size_t dimensions) {}
-    Point(const std::vector<double>& coordinates) {}
-    Point(std::initializer_list<double> coordinates) {}
+    explicit Point(size_t dimensions) : coords(dimensions, 0.0) {}
+    Point(const std::vector<double>& coordinates) : coords(coordinates) {}
+    Point(std::initializer_list<double> coordinates) : coords(coordinates) {}
     
-    // TODO: Implementar getters
-    size_t dimensions() const { return 0; }
-    double operator[](size_t index) const { return 0.0; }
-    double& operator[](size_t index) { static double dummy = 0; return dummy; }
+    size_t dimensions() const { return coords.size(); }
+    double operator[](size_t index) const { return coords[index]; }
+    double& operator[](size_t index) { return coords[index]; }
     const std::vector<double>& getCoords() const { return coords; }
     
-    // TODO: Implementar distancia euclidiana
+    /**
+     * @brief Distancia euclidiana
+     */
     double distanceTo(const Point& other) const {
-        return 0.0;
+        if (coords.size() != other.coords.size()) {
+            throw std::invalid_argument("Point dimensions do not match");
+        }
+        double sum = 0.0;
+        for (size_t i = 0; i < coords.size(); ++i) {
+            double d = coords[i] - other.coords[i];
+            sum += d * d;
+        }
+        return std::sqrt(sum);
     }
     
-    // TODO: Implementar operadores de comparación
     bool operator==(const Point& other) const {
-        return false;
+        return coords == other.coords;
     }
     
     bool operator!=(const Point& other) const {
-        return true;
+        return !(*this == other);
     }
 };
 
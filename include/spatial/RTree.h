@@ -3,12 +3,30 @@
 #include "Point.h"
 #include "MBR.h"
 #include "SpatialComparators.h"
+#include "../util/Arena.h"
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
 
 namespace spatial {
 
+/**
+ * @brief Payload como número para agregados y zone maps (0 si T no es aritmético)
+ */
+template<typename T>
+double payloadValue(const T& data) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        return static_cast<double>(data);
+    } else {
+        return 0.0;
+    }
+}
+
 /**
  * @brief Nodo del R-tree
  * Implementa R*-tree optimizado para bulk-loading
@@ -21,13 +39,125 @@ public:
     std::vector<std::shared_ptr<RTreeNode<T>>> children;
     std::vector<SpatialRecord<T>> records;
     bool isLeaf;
+    uint64_t liveCount = 0;     // Registros no tombstone del subárbol
+    double valueSum = 0.0;      // Suma de sus payloads (0 si T no es aritmético)
+    double minValue = std::numeric_limits<double>::max();      // Zone map del payload;
+    double maxValue = std::numeric_limits<double>::lowest();   // min > max = sin registros vivos
     
     RTreeNode(bool leaf = true) : isLeaf(leaf) {}
     
     void updateMBR() {
-        // TODO: Actualizar MBR del nodo
-        // - Si es hoja: calcular MBR que contenga todos los records
-        // - Si es interno: calcular MBR que contenga todos los children
+        if (isLeaf) {
+            if (records.empty()) return;
+            mbr = MBR(records.front().point.dimensions());
+            for (const auto& rec : records) {
+                mbr.expand(rec.point);
+            }
+        } else {
+            if (children.empty()) return;
+            mbr = MBR(children.front()->mbr.dimensions());
+            for (const auto& child : children) {
+                mbr.expand(child->mbr);
+            }
+        }
+    }
+    
+    /**
+     * @brief Agregados COUNT/SUM y zone map [min, max] del subárbol, desde
+     *        registros o hijos
+     */
+    void updateAggregates() {
+        liveCount = 0;
+        valueSum = 0.0;
+        minValue = std::numeric_limits<double>::max();
+        maxValue = std::numeric_limits<double>::lowest();
+        if (isLeaf) {
+            for (const auto& rec : records) {
+                if (rec.isTombstone) continue;
+                double value = payloadValue(rec.data);
+                ++liveCount;
+                valueSum += value;
+                minValue = std::min(minValue, value);
+                maxValue = std::max(maxValue, value);
+            }
+        } else {
+            for (const auto& child : children) {
+                liveCount += child->liveCount;
+                valueSum += child->valueSum;
+                minValue = std::min(minValue, child->minValue);
+                maxValue = std::max(maxValue, child->maxValue);
+            }
+        }
+    }
+};
+
+/**
+ * @brief Traza de una búsqueda en el R-tree (EXPLAIN ANALYZE)
+ */
+struct RTreeSearchTrace {
+    std::vector<size_t> nodesVisitedPerLevel;  // Índice 0 = raíz
+    size_t leafEntriesTested = 0;
+    size_t matches = 0;
+};
+
+/**
+ * @brief Recorrido incremental de una búsqueda por rango
+ * Pila explícita de (nodo, siguiente hijo o registro): next() reanuda donde
+ * se quedó, así que quien consume puede parar en cualquier momento sin
+ * visitar el resto del árbol. Los nodos para los que prune() devuelve true
+ * se saltan enteros (zone maps). Válido mientras viva el árbol.
+ */
+template<typename T>
+class RTreeRangeIterator {
+private:
+    struct Frame {
+        const RTreeNode<T>* node;
+        size_t next;
+    };
+    
+    using Prune = std::function<bool(const RTreeNode<T>&)>;
+    
+    std::vector<Frame> stack;
+    MBR queryBox;
+    Prune prune;
+    
+    bool enter(const RTreeNode<T>& node) const {
+        return node.mbr.intersects(queryBox) && !(prune && prune(node));
+    }
+    
+public:
+    RTreeRangeIterator() = default;
+    
+    RTreeRangeIterator(const RTreeNode<T>* root, const MBR& box, Prune pruneNode = Prune())
+        : queryBox(box), prune(std::move(pruneNode)) {
+        if (root && enter(*root)) {
+            stack.push_back({root, 0});
+        }
+    }
+    
+    /**
+     * @brief Siguiente registro dentro del box (tombstones incluidos)
+     * @return nullptr cuando no quedan
+     */
+    const SpatialRecord<T>* next() {
+        while (!stack.empty()) {
+            Frame& top = stack.back();
+            if (top.node->isLeaf) {
+                while (top.next < top.node->records.size()) {
+                    const auto& rec = top.node->records[top.next++];
+                    if (queryBox.contains(rec.point)) return &rec;
+                }
+                stack.pop_back();
+            } else if (top.next < top.node->children.size()) {
+                const RTreeNode<T>* child = top.node->children[top.next++].get();
+                if (enter(*child)) {
+                    stack.push_back({child, 0});
+                }
+            } else {
+                stack.pop_back();
+            }
+        }
+        return nullptr;
     }
 };
 
@@ -43,17 +173,95 @@ private:
     size_t minEntriesPerNode;
     size_t dimensions;
     
+    using RecordRef = SpatialRecord<T>*;
+    using RefIterator = typename std::vector<RecordRef, util::ArenaAllocator<RecordRef>>::iterator;
+    using NodePtr = std::shared_ptr<RTreeNode<T>>;
+    using NodeList = std::vector<NodePtr, util::ArenaAllocator<NodePtr>>;
+    
     /**
      * @brief Bulk-load usando Sort-Tile-Recursive (STR)
+     * El espacio de trabajo (referencias a ordenar y listas de nodos de cada
+     * nivel) vive en un arena que se libera completo al terminar build();
+     * solo los nodos, que la raíz comparte con cursores, van al heap.
      */
     std::shared_ptr<RTreeNode<T>> bulkLoad(std::vector<SpatialRecord<T>>& records, size_t dim = 0) {
-        // TODO: Implementar STR bulk-loading
-        // 1. Si records <= maxEntriesPerNode, crear hoja directamente
-        // 2. Ordenar por dimensión actual (dim % dimensions)
-        // 3. Particionar en S slices (S = sqrt(N/M))
-        // 4. Recursión con siguiente dimensión
-        // 5. Crear nodos internos si necesario
-        return std::make_shared<RTreeNode<T>>(true);
+        size_t leaves = (records.size() + maxEntriesPerNode - 1) / maxEntriesPerNode;
+        util::Arena scratch(std::max<size_t>(
+            64 * 1024, records.size() * sizeof(RecordRef) + 2 * leaves * sizeof(NodePtr) + 64));
+        std::vector<RecordRef, util::ArenaAllocator<RecordRef>> refs{util::ArenaAllocator<RecordRef>(&scratch)};
+        refs.reserve(records.size());
+        for (auto& rec : records) {
+            refs.push_back(&rec);
+        }
+        
+        NodeList level{util::ArenaAllocator<NodePtr>(&scratch)};
+        level.reserve(leaves);
+        bulkLoadRange(refs.begin(), refs.end(), dim, level);
+        
+        // Crear nodos internos hasta que quede una sola raíz
+        while (level.size() > 1) {
+            NodeList parents{util::ArenaAllocator<NodePtr>(&scratch)};
+            parents.reserve((level.size() + maxEntriesPerNode - 1) / maxEntriesPerNode);
+            for (size_t i = 0; i < level.size(); i += maxEntriesPerNode) {
+                auto parent = std::make_shared<RTreeNode<T>>(false);
+                size_t end = std::min(i + maxEntriesPerNode, level.size());
+                parent->children.assign(std::make_move_iterator(level.begin() + i),
+                                        std::make_move_iterator(level.begin() + end));
+                parent->updateMBR();
+                parent->updateAggregates();
+                parents.push_back(std::move(parent));
+            }
+            level.swap(parents);
+        }
+        
+        return level.empty() ? std::make_shared<RTreeNode<T>>(true) : level.front();
+    }
+    
+    /**
+     * @brief STR recursivo sobre un rango de referencias; añade las hojas a
+     * leaves en orden de tiles
+     */
+    void bulkLoadRange(RefIterator first, RefIterator last, size_t dim, NodeList& leaves) {
+        size_t n = static_cast<size_t>(last - first);
+        if (n == 0) return;
+        
+        if (n <= maxEntriesPerNode) {
+            auto leaf = std::make_shared<RTreeNode<T>>(true);
+            leaf->records.reserve(n);
+            for (auto it = first; it != last; ++it) {
+                leaf->records.push_back(std::move(**it));
+            }
+            leaf->updateMBR();
+            leaf->updateAggregates();
+            leaves.push_back(std::move(leaf));
+            return;
+        }
+        
+        size_t axis = dim % dimensions;
+        std::sort(first, last, [axis](RecordRef a, RecordRef b) {
+            return a->point[axis] < b->point[axis];
+        });
+        
+        // En la última dimensión se cortan hojas directamente
+        if (dim + 1 >= dimensions) {
+            for (auto it = first; it < last; ) {
+                auto end = (static_cast<size_t>(last - it) > maxEntriesPerNode) ? it + maxEntriesPerNode : last;
+                bulkLoadRange(it, end, dim, leaves);
+                it = end;
+            }
+            return;
+        }
+        
+        // S = ceil((N/M)^(1/(D - dim))) slices en la dimensión actual
+        double pages = std::ceil(static_cast<double>(n) / maxEntriesPerNode);
+        size_t slices = static_cast<size_t>(std::ceil(std::pow(pages, 1.0 / (dimensions - dim))));
+        size_t sliceSize = (n + slices - 1) / slices;
+        
+        for (auto it = first; it < last; ) {
+            auto end = (static_cast<size_t>(last - it) > sliceSize) ? it + sliceSize : last;
+            bulkLoadRange(it, end, dim + 1, leaves);
+            it = end;
+        }
     }
     
     /**
@@ -61,11 +269,34 @@ private:
      */
     void rangeSearchRecursive(const std::shared_ptr<RTreeNode<T>>& node, 
                              const MBR& queryBox,
-                             std::vector<SpatialRecord<T>>& results) const {
-        // TODO: Implementar range search recursivo
-        // 1. Verificar si node->mbr intersecta queryBox
-        // 2. Si es hoja: revisar cada record, agregar si está en queryBox (y no es tombstone)
-        // 3. Si es interno: recursión sobre children que intersectan
+                             std::vector<SpatialRecord<T>>& results,
+                             RTreeSearchTrace* trace = nullptr,
+                             size_t depth = 0) const {
+        if (trace) {
+            if (trace->nodesVisitedPerLevel.size() <= depth) {
+                trace->nodesVisitedPerLevel.resize(depth + 1, 0);
+            }
+            trace->nodesVisitedPerLevel[depth]++;
+        }
+        if (!node->mbr.intersects(queryBox)) return;
+        
+        if (node->isLeaf) {
+            // Los tombstones también se devuelven: la reconciliación del
+            // LSM-tree los necesita para ocultar versiones más antiguas
+            for (const auto& rec : node->records) {
+                if (queryBox.contains(rec.point)) {
+                    results.push_back(rec);
+                }
+            }
+            if (trace) trace->leafEntriesTested += node->records.size();
+            return;
+        }
+        
+        for (const auto& child : node->children) {
+            if (child->mbr.intersects(queryBox)) {
+                rangeSearchRecursive(child, queryBox, results, trace, depth + 1);
+            }
+        }
     }
     
 public:
@@ -80,48 +311,139 @@ public:
      * Usa bulk-loading para eficiencia
      */
     void build(std::vector<SpatialRecord<T>> records) {
-        // TODO: Construir R-tree usando bulkLoad()
-        root = std::make_shared<RTreeNode<T>>(true);
+        root = records.empty() ? std::make_shared<RTreeNode<T>>(true) : bulkLoad(records);
     }
     
     /**
      * @brief Búsqueda por rango espacial
      */
-    std::vector<SpatialRecord<T>> rangeSearch(const MBR& queryBox) const {
-        // TODO: Ejecutar rangeSearchRecursive desde root
-        return {};
+    std::vector<SpatialRecord<T>> rangeSearch(const MBR& queryBox,
+                                              RTreeSearchTrace* trace = nullptr) const {
+        std::vector<SpatialRecord<T>> results;
+        if (root) {
+            rangeSearchRecursive(root, queryBox, results, trace);
+        }
+        if (trace) trace->matches += results.size();
+        return results;
+    }
+    
+    /**
+     * @brief Búsqueda por rango incremental (cursores, LIMIT)
+     */
+    RTreeRangeIterator<T> rangeIterator(
+        const MBR& queryBox,
+        std::function<bool(const RTreeNode<T>&)> prune = nullptr) const {
+        return RTreeRangeIterator<T>(root.get(), queryBox, std::move(prune));
+    }
+    
+    /**
+     * @brief Zone map del árbol: [min, max] de los payloads vivos
+     * @return false si el árbol no está construido
+     */
+    bool valueBounds(double& min, double& max) const {
+        if (!root) return false;
+        min = root->minValue;
+        max = root->maxValue;
+        return true;
+    }
+    
+    /**
+     * @brief Búsqueda por rango con agregados precalculados
+     * Si canCredit(nodo) acepta un nodo que intersecta el box, credit(nodo)
+     * usa su liveCount/valueSum y sus hojas no se visitan; si no, se baja
+     * y visit(registro) recibe cada registro del box (tombstones incluidos).
+     */
+    template<typename CanCredit, typename Credit, typename Visit>
+    void aggregateSearch(const MBR& queryBox, CanCredit&& canCredit, Credit&& credit,
+                         Visit&& visit, RTreeSearchTrace* trace = nullptr) const {
+        if (root) {
+            aggregateRecursive(*root, queryBox, canCredit, credit, visit, trace, 0);
+        }
     }
     
     /**
      * @brief Obtiene el MBR total del árbol
      */
     MBR getTotalMBR() const {
-        // TODO: Retornar root->mbr si existe, sino MBR vacío
-        return MBR(dimensions);
+        if (!root || (root->isLeaf && root->records.empty())) {
+            return MBR(dimensions);
+        }
+        return root->mbr;
     }
     
     /**
      * @brief Verifica si el árbol está vacío
      */
     bool isEmpty() const {
-        // TODO: Verificar si root es nullptr o root->records está vacío
-        return true;
+        return size() == 0;
     }
     
     /**
      * @brief Cuenta total de registros
      */
     size_t size() const {
-        // TODO: Contar recursivamente registros en el árbol
-        return 0;
+        return root ? countRecords(root) : 0;
+    }
+    
+    /**
+     * @brief Obtiene todos los registros de las hojas (para serialización)
+     */
+    std::vector<SpatialRecord<T>> getAllRecords() const {
+        std::vector<SpatialRecord<T>> out;
+        if (root) {
+            collectRecords(root, out);
+        }
+        return out;
     }
     
 private:
+    template<typename CanCredit, typename Credit, typename Visit>
+    void aggregateRecursive(const RTreeNode<T>& node, const MBR& queryBox, CanCredit& canCredit,
+                            Credit& credit, Visit& visit, RTreeSearchTrace* trace,
+                            size_t depth) const {
+        if (trace) {
+            if (trace->nodesVisitedPerLevel.size() <= depth) {
+                trace->nodesVisitedPerLevel.resize(depth + 1, 0);
+            }
+            trace->nodesVisitedPerLevel[depth]++;
+        }
+        if (!node.mbr.intersects(queryBox)) return;
+        if (canCredit(node)) {
+            credit(node);
+            return;
+        }
+        if (node.isLeaf) {
+            for (const auto& rec : node.records) {
+                if (queryBox.contains(rec.point)) visit(rec);
+            }
+            if (trace) trace->leafEntriesTested += node.records.size();
+            return;
+        }
+        for (const auto& child : node.children) {
+            aggregateRecursive(*child, queryBox, canCredit, credit, visit, trace, depth + 1);
+        }
+    }
+    
+    void collectRecords(const std::shared_ptr<RTreeNode<T>>& node,
+                        std::vector<SpatialRecord<T>>& out) const {
+        if (node->isLeaf) {
+            out.insert(out.end(), node->records.begin(), node->records.end());
+            return;
+        }
+        for (const auto& child : node->children) {
+            collectRecords(child, out);
+        }
+    }
+    
     size_t countRecords(const std::shared_ptr<RTreeNode<T>>& node) const {
-        // TODO: Contar registros recursivamente
-        // Si es hoja: retornar node->records.size()
-        // Si es interno: sumar countRecords de todos los children
-        return 0;
+        if (node->isLeaf) {
+            return node->records.size();
+        }
+        size_t total = 0;
+        for (const auto& child : node->children) {
+            total += countRecords(child);
+        }
+        return total;
     }
 };
 
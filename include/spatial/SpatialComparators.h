@@ -3,6 +3,8 @@
 #include "Point.h"
 #include "MBR.h"
 #include <functional>
+#include <algorithm>
+#include <utility>
 #include <cstdint>
 
 namespace spatial {
@@ -30,14 +32,20 @@ class SimpleComparator {
 public:
     template<typename T>
     bool operator()(const SpatialRecord<T>& a, const SpatialRecord<T>& b) const {
-        // TODO: Implementar comparación Nearest-X (SIMPLECOMPARE del paper)
-        // Comparar por primera dimensión, luego segunda, etc.
-        return false;
+        return (*this)(a.point, b.point);
     }
     
+    /**
+     * @brief Orden lexicográfico por coordenadas; a igualdad de prefijo,
+     * el punto con menos dimensiones va primero
+     */
     bool operator()(const Point& p1, const Point& p2) const {
-        // TODO: Implementar comparación de puntos
-        return false;
+        const size_t dims = std::min(p1.dimensions(), p2.dimensions());
+        for (size_t i = 0; i < dims; ++i) {
+            if (p1[i] < p2[i]) return true;
+            if (p2[i] < p1[i]) return false;
+        }
+        return p1.dimensions() < p2.dimensions();
     }
 };
 
@@ -54,40 +62,62 @@ private:
      * @brief Calcula el índice de Hilbert para un punto 2D
      */
     static uint64_t hilbertIndex2D(int x, int y, int order) {
-        // TODO: Implementar algoritmo de Hilbert Curve
-        // Referencia: Mapeo de coordenadas 2D a índice 1D preservando localidad
-        return 0;
+        const int n = 1 << order;
+        uint64_t d = 0;
+        for (int s = n / 2; s > 0; s /= 2) {
+            int rx = (x & s) > 0 ? 1 : 0;
+            int ry = (y & s) > 0 ? 1 : 0;
+            d += static_cast<uint64_t>(s) * static_cast<uint64_t>(s) * static_cast<uint64_t>((3 * rx) ^ ry);
+            // Rotar el cuadrante para que la curva siga siendo continua
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = n - 1 - x;
+                    y = n - 1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return d;
     }
     
     /**
      * @brief Normaliza coordenadas al rango [0, 2^order - 1]
      */
     static int normalize(double value, double min, double max, int order) {
-        // TODO: Implementar normalización de coordenadas
-        return 0;
+        const double cells = static_cast<double>((1 << order) - 1);
+        if (!(max > min)) return 0;
+        double t = (value - min) / (max - min);
+        t = std::min(1.0, std::max(0.0, t));
+        return static_cast<int>(t * cells);
     }
     
 public:
     /**
      * @brief Calcula el índice de Hilbert para un punto
+     * Las coordenadas se normalizan con bounds; fuera del dominio se
+     * recortan al borde.
      */
     static uint64_t computeHilbertIndex(const Point& p, const MBR& bounds) {
-        // TODO: Implementar cálculo de índice Hilbert
-        // Para 2D: usar hilbertIndex2D
-        // Para 1D: fallback a coordenada X
-        // Para D>2: usar primeras dos dimensiones
-        return 0;
+        const size_t dims = std::min(p.dimensions(), bounds.dimensions());
+        if (dims == 0) return 0;
+        
+        const Point& lo = bounds.getLower();
+        const Point& hi = bounds.getUpper();
+        int x = normalize(p[0], lo[0], hi[0], MAX_ITERATIONS);
+        if (dims == 1) return static_cast<uint64_t>(x);
+        
+        // D>2: las dos primeras dimensiones (espaciales) definen el orden
+        int y = normalize(p[1], lo[1], hi[1], MAX_ITERATIONS);
+        return hilbertIndex2D(x, y, MAX_ITERATIONS);
     }
     
     template<typename T>
     bool operator()(const SpatialRecord<T>& a, const SpatialRecord<T>& b, const MBR& bounds) const {
-        // TODO: Comparar usando índices de Hilbert
-        return false;
+        return (*this)(a.point, b.point, bounds);
     }
     
     bool operator()(const Point& p1, const Point& p2, const MBR& bounds) const {
-        // TODO: Comparar puntos usando índices de Hilbert
-        return false;
+        return computeHilbertIndex(p1, bounds) < computeHilbertIndex(p2, bounds);
     }
 };
 
@@ -96,21 +126,51 @@ public:
  */
 class ZOrderComparator {
 private:
+    static const int ORDER = 16;  // Bits por dimensión
+    
+    /**
+     * @brief Separa los bits de v con un cero entre cada dos (bit i → 2i)
+     */
+    static uint64_t spreadBits(uint32_t v) {
+        uint64_t x = v;
+        x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+        x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+        x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        x = (x | (x << 2)) & 0x3333333333333333ULL;
+        x = (x | (x << 1)) & 0x5555555555555555ULL;
+        return x;
+    }
+    
     static uint64_t interleaveBits(uint32_t x, uint32_t y) {
-        // TODO: Implementar interleaving de bits para Z-order
-        return 0;
+        return spreadBits(x) | (spreadBits(y) << 1);
+    }
+    
+    static uint32_t normalize(double value, double min, double max) {
+        const double cells = static_cast<double>((1u << ORDER) - 1);
+        if (!(max > min)) return 0;
+        double t = (value - min) / (max - min);
+        t = std::min(1.0, std::max(0.0, t));
+        return static_cast<uint32_t>(t * cells);
     }
     
 public:
+    /**
+     * @brief Código Morton de las dos primeras dimensiones normalizadas con bounds
+     */
     static uint64_t computeZOrder(const Point& p, const MBR& bounds) {
-        // TODO: Implementar cálculo de Z-order (Morton code)
-        return 0;
+        const size_t dims = std::min(p.dimensions(), bounds.dimensions());
+        if (dims == 0) return 0;
+        
+        const Point& lo = bounds.getLower();
+        const Point& hi = bounds.getUpper();
+        uint32_t x = normalize(p[0], lo[0], hi[0]);
+        uint32_t y = dims > 1 ? normalize(p[1], lo[1], hi[1]) : 0;
+        return interleaveBits(x, y);
     }
     
     template<typename T>
     bool operator()(const SpatialRecord<T>& a, const SpatialRecord<T>& b, const MBR& bounds) const {
-        // TODO: Comparar usando Z-order
-        return false;
+        return computeZOrder(a.point, bounds) < computeZOrder(b.point, bounds);
     }
 };
 
@@ -5,6 +5,8 @@
 #include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <map>
+#include <stdexcept>
 
 namespace sql {
 
@@ -14,12 +16,14 @@ namespace sql {
 enum class TokenType {
     // Keywords
     SELECT, INSERT, INTO, CREATE, TABLE, WHERE, FROM, VALUES, COUNT,
+    EXPLAIN, ANALYZE, LOAD, FORMAT, COPY, LIMIT, OFFSET, GROUP, BY, SUM, AVG, AND,
     
     // Operadores
-    STAR, COMMA, SEMICOLON, LPAREN, RPAREN,
+    STAR, COMMA, SEMICOLON, LPAREN, RPAREN, PARAMETER,
+    COMPARISON,     // value = "=", "<", "<=", ">" o ">="
     
     // Tipos de datos
-    INT, DOUBLE, VARCHAR, POINT, GEOMETRY,
+    INT, DOUBLE, VARCHAR, POINT, GEOMETRY, TIMESTAMP,
     
     // Funciones espaciales
     SPATIAL_INTERSECT,
@@ -60,48 +64,141 @@ private:
     }
     
     void skipWhitespace() {
-        // TODO: Avanzar position mientras peek() sea espacio en blanco
+        while (std::isspace(static_cast<unsigned char>(peek()))) {
+            advance();
+        }
     }
     
     std::string readIdentifier() {
-        // TODO: Leer caracteres alfanuméricos + '_' para identificadores
-        return "";
+        size_t start = position;
+        while (std::isalnum(static_cast<unsigned char>(peek())) || peek() == '_') {
+            advance();
+        }
+        return input.substr(start, position - start);
     }
     
     std::string readNumber() {
-        // TODO: Leer dígitos + '.' para números
-        return "";
+        size_t start = position;
+        if (peek() == '-' || peek() == '+') advance();
+        while (std::isdigit(static_cast<unsigned char>(peek())) || peek() == '.') {
+            advance();
+        }
+        // Exponente: 1e-3, 2.5E6
+        if ((peek() == 'e' || peek() == 'E') && position + 1 < input.length()) {
+            char next = input[position + 1];
+            if (std::isdigit(static_cast<unsigned char>(next)) ||
+                ((next == '-' || next == '+') && position + 2 < input.length() &&
+                 std::isdigit(static_cast<unsigned char>(input[position + 2])))) {
+                advance();
+                if (peek() == '-' || peek() == '+') advance();
+                while (std::isdigit(static_cast<unsigned char>(peek()))) advance();
+            }
+        }
+        return input.substr(start, position - start);
     }
     
     std::string readString() {
-        // TODO: Leer desde ' hasta ' para strings
-        return "";
+        advance();  // Comilla inicial
+        std::string value;
+        while (peek() != '\0') {
+            char c = advance();
+            if (c == '\'') {
+                if (peek() == '\'') {  // '' = comilla escapada
+                    value += advance();
+                    continue;
+                }
+                return value;
+            }
+            value += c;
+        }
+        throw std::runtime_error("Unterminated string literal");
     }
     
     TokenType keywordOrIdentifier(const std::string& word) {
-        // TODO: Convertir word a uppercase, mapear a TokenType
-        // SELECT, INSERT, CREATE, etc. -> keywords
-        // Otros -> IDENTIFIER
-        return TokenType::IDENTIFIER;
+        std::string upper(word);
+        std::transform(upper.begin(), upper.end(), upper.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        
+        static const std::map<std::string, TokenType> keywords = {
+            {"SELECT", TokenType::SELECT}, {"INSERT", TokenType::INSERT},
+            {"INTO", TokenType::INTO}, {"CREATE", TokenType::CREATE},
+            {"TABLE", TokenType::TABLE}, {"WHERE", TokenType::WHERE},
+            {"FROM", TokenType::FROM}, {"VALUES", TokenType::VALUES},
+            {"COUNT", TokenType::COUNT}, {"EXPLAIN", TokenType::EXPLAIN},
+            {"ANALYZE", TokenType::ANALYZE}, {"LOAD", TokenType::LOAD},
+            {"FORMAT", TokenType::FORMAT}, {"COPY", TokenType::COPY},
+            {"LIMIT", TokenType::LIMIT}, {"OFFSET", TokenType::OFFSET},
+            {"GROUP", TokenType::GROUP}, {"BY", TokenType::BY},
+            {"SUM", TokenType::SUM}, {"AVG", TokenType::AVG},
+            {"AND", TokenType::AND},
+            {"INT", TokenType::INT},
+            {"DOUBLE", TokenType::DOUBLE}, {"VARCHAR", TokenType::VARCHAR},
+            {"POINT", TokenType::POINT}, {"GEOMETRY", TokenType::GEOMETRY},
+            {"TIMESTAMP", TokenType::TIMESTAMP},
+            {"SPATIAL_INTERSECT", TokenType::SPATIAL_INTERSECT}
+        };
+        
+        auto it = keywords.find(upper);
+        return it == keywords.end() ? TokenType::IDENTIFIER : it->second;
     }
     
 public:
     explicit SQLLexer(const std::string& sql) : input(sql), position(0) {}
     
     Token nextToken() {
-        // TODO: Implementar tokenización
-        // 1. skipWhitespace()
-        // 2. Verificar EOF
-        // 3. Reconocer símbolos: *, ,, ;, (, )
-        // 4. Reconocer strings: '...'
-        // 5. Reconocer números
-        // 6. Reconocer identificadores/keywords
-        return Token(TokenType::INVALID);
+        skipWhitespace();
+        
+        char c = peek();
+        if (c == '\0') return Token(TokenType::END_OF_FILE);
+        
+        switch (c) {
+            case '*': advance(); return Token(TokenType::STAR, "*");
+            case ',': advance(); return Token(TokenType::COMMA, ",");
+            case ';': advance(); return Token(TokenType::SEMICOLON, ";");
+            case '(': advance(); return Token(TokenType::LPAREN, "(");
+            case ')': advance(); return Token(TokenType::RPAREN, ")");
+            case '?': advance(); return Token(TokenType::PARAMETER, "?");
+            case '\'': return Token(TokenType::STRING, readString());
+            case '=': advance(); return Token(TokenType::COMPARISON, "=");
+            case '<':
+            case '>':
+                advance();
+                if (peek() == '=') {
+                    advance();
+                    return Token(TokenType::COMPARISON, std::string(1, c) + "=");
+                }
+                return Token(TokenType::COMPARISON, std::string(1, c));
+            default: break;
+        }
+        
+        char next = position + 1 < input.length() ? input[position + 1] : '\0';
+        if (std::isdigit(static_cast<unsigned char>(c)) ||
+            (c == '.' && std::isdigit(static_cast<unsigned char>(next))) ||
+            ((c == '-' || c == '+') &&
+             (std::isdigit(static_cast<unsigned char>(next)) || next == '.'))) {
+            return Token(TokenType::NUMBER, readNumber());
+        }
+        
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            std::string word = readIdentifier();
+            return Token(keywordOrIdentifier(word), word);
+        }
+        
+        advance();
+        return Token(TokenType::INVALID, std::string(1, c));
     }
     
     std::vector<Token> tokenize() {
-        // TODO: Llamar nextToken() hasta END_OF_FILE
-        return {};
+        std::vector<Token> tokens;
+        for (;;) {
+            Token token = nextToken();
+            if (token.type == TokenType::INVALID) {
+                throw std::runtime_error("Unexpected character '" + token.value + "' in SQL");
+            }
+            tokens.push_back(token);
+            if (token.type == TokenType::END_OF_FILE) break;
+        }
+        return tokens;
     }
 };
 
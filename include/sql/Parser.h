@@ -13,14 +13,25 @@ enum class ASTNodeType {
     SELECT_STMT,
     INSERT_STMT,
     CREATE_TABLE_STMT,
+    EXPLAIN_STMT,
+    LOAD_STMT,
+    COPY_STMT,
     WHERE_CLAUSE,
+    LIMIT_CLAUSE,   // Hijo: operando con el número de filas
+    OFFSET_CLAUSE,  // Hijo: operando con las filas a saltar
     SPATIAL_INTERSECT_EXPR,
+    COMPARISON_EXPR,    // value = operador; hijos: columna y operando
     COUNT_EXPR,
+    SUM_EXPR,       // value = columna
+    AVG_EXPR,       // value = columna
+    GRID_EXPR,      // Hijos: columna espacial y operando con el lado de celda
+    GROUP_BY_CLAUSE,
     COLUMN_LIST,
     VALUE_LIST,
     IDENTIFIER,
     NUMBER,
-    STRING
+    STRING,
+    PARAMETER       // '?': value = posición (0-based) en la sentencia
 };
 
 /**
@@ -43,13 +54,20 @@ struct ASTNode {
  * @brief Parser SQL simple
  * Soporta:
  * - SELECT COUNT(*) FROM table WHERE spatial_intersect(column, box)
- * - INSERT INTO table VALUES (...)
+ * - SELECT * FROM table [WHERE ...] [LIMIT n] [OFFSET m]
+ * - WHERE spatial_intersect(...) AND column op valor [AND ...]
+ * - SELECT COUNT(*), SUM(col), AVG(col) FROM table [WHERE ...] GROUP BY grid(column, size)
+ * - INSERT INTO table VALUES (...)[, (...) ...]
  * - CREATE TABLE table (columns...)
+ * - EXPLAIN [ANALYZE] SELECT ...
+ * - LOAD 'file' INTO table [FORMAT csv|wkt|binary] [opciones]
+ * - COPY table FROM 'file' [FORMAT csv|wkt|binary] [opciones]
  */
 class SQLParser {
 private:
     std::vector<Token> tokens;
     size_t position;
+    size_t parameters = 0;
     
     const Token& peek() const {
         if (position >= tokens.size()) {
@@ -73,6 +91,20 @@ private:
         return false;
     }
     
+    /**
+     * @brief Literal numérico o parámetro '?' (numerado en orden de aparición)
+     */
+    std::shared_ptr<ASTNode> parseOperand() {
+        if (peek().type == TokenType::NUMBER) {
+            return std::make_shared<ASTNode>(ASTNodeType::NUMBER, advance().value);
+        }
+        if (peek().type == TokenType::PARAMETER) {
+            advance();
+            return std::make_shared<ASTNode>(ASTNodeType::PARAMETER, std::to_string(parameters++));
+        }
+        return nullptr;
+    }
+    
     void expect(TokenType type, const std::string& msg = "Unexpected token") {
         if (peek().type != type) {
             throw std::runtime_error(msg + ": expected " + std::to_string(static_cast<int>(type)));
@@ -82,37 +114,276 @@ private:
     
     /**
      * @brief SELECT statement
-     * SELECT COUNT(*) FROM table [WHERE condition]
+     * SELECT * | items FROM table [WHERE condition] [GROUP BY grid(col, size)]
+     *        [LIMIT n] [OFFSET m]
      */
     std::shared_ptr<ASTNode> parseSelect() {
-        // TODO: Implementar parser de SELECT
-        // 1. expect(SELECT)
-        // 2. Parsear COUNT(*) o *
-        // 3. expect(FROM), leer tabla
-        // 4. Parsear WHERE opcional con parseWhere()
-        return std::make_shared<ASTNode>(ASTNodeType::SELECT_STMT);
+        auto node = std::make_shared<ASTNode>(ASTNodeType::SELECT_STMT);
+        
+        expect(TokenType::SELECT);
+        
+        if (!match(TokenType::STAR)) {
+            do {
+                node->addChild(parseSelectItem());
+            } while (match(TokenType::COMMA));
+        }
+        
+        expect(TokenType::FROM);
+        if (peek().type != TokenType::IDENTIFIER) {
+            throw std::runtime_error("Expected table name after FROM");
+        }
+        node->addChild(std::make_shared<ASTNode>(ASTNodeType::IDENTIFIER, peek().value));
+        advance();
+        
+        if (peek().type == TokenType::WHERE) {
+            node->addChild(parseWhere());
+        }
+        if (match(TokenType::GROUP)) {
+            expect(TokenType::BY, "Expected BY after GROUP");
+            if (!atGrid()) {
+                throw std::runtime_error("Only GROUP BY grid(column, size) is supported");
+            }
+            auto group = std::make_shared<ASTNode>(ASTNodeType::GROUP_BY_CLAUSE);
+            group->addChild(parseGrid());
+            node->addChild(group);
+        }
+        if (match(TokenType::LIMIT)) {
+            node->addChild(parseRowCount(ASTNodeType::LIMIT_CLAUSE, "LIMIT"));
+        }
+        if (match(TokenType::OFFSET)) {
+            node->addChild(parseRowCount(ASTNodeType::OFFSET_CLAUSE, "OFFSET"));
+        }
+        
+        match(TokenType::SEMICOLON);
+        if (peek().type != TokenType::END_OF_FILE) {
+            throw std::runtime_error("Unexpected token after SELECT: " + peek().value);
+        }
+        return node;
+    }
+    
+    /**
+     * @brief column op valor, con op en =, <, <=, >, >=
+     */
+    std::shared_ptr<ASTNode> parseComparison() {
+        auto column = std::make_shared<ASTNode>(ASTNodeType::IDENTIFIER, advance().value);
+        if (peek().type != TokenType::COMPARISON) {
+            throw std::runtime_error("Expected comparison operator after " + column->value);
+        }
+        auto node = std::make_shared<ASTNode>(ASTNodeType::COMPARISON_EXPR, advance().value);
+        node->addChild(column);
+        auto operand = parseOperand();
+        if (!operand) {
+            throw std::runtime_error("Comparison with " + column->value + " expects a number or '?'");
+        }
+        node->addChild(operand);
+        return node;
+    }
+    
+    /**
+     * @brief Elemento de la lista SELECT: COUNT(*), SUM(col), AVG(col) o grid(col, size)
+     */
+    std::shared_ptr<ASTNode> parseSelectItem() {
+        if (match(TokenType::COUNT)) {
+            expect(TokenType::LPAREN);
+            expect(TokenType::STAR, "Only COUNT(*) is supported");
+            expect(TokenType::RPAREN);
+            return std::make_shared<ASTNode>(ASTNodeType::COUNT_EXPR);
+        }
+        if (peek().type == TokenType::SUM || peek().type == TokenType::AVG) {
+            auto type = advance().type == TokenType::SUM ? ASTNodeType::SUM_EXPR : ASTNodeType::AVG_EXPR;
+            expect(TokenType::LPAREN, "Expected '(' after aggregate");
+            if (peek().type != TokenType::IDENTIFIER) {
+                throw std::runtime_error("Expected column name in aggregate");
+            }
+            auto node = std::make_shared<ASTNode>(type, advance().value);
+            expect(TokenType::RPAREN, "Expected ')' after aggregate column");
+            return node;
+        }
+        if (atGrid()) {
+            return parseGrid();
+        }
+        throw std::runtime_error("Only *, COUNT(*), SUM(col), AVG(col) and grid(col, size) can be selected");
+    }
+    
+    bool atGrid() const {
+        if (peek().type != TokenType::IDENTIFIER) return false;
+        std::string name = peek().value;
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        return name == "GRID";
+    }
+    
+    /**
+     * @brief grid(column, size): celdas cuadradas de lado size
+     */
+    std::shared_ptr<ASTNode> parseGrid() {
+        advance();
+        auto node = std::make_shared<ASTNode>(ASTNodeType::GRID_EXPR);
+        expect(TokenType::LPAREN, "Expected '(' after grid");
+        if (peek().type != TokenType::IDENTIFIER) {
+            throw std::runtime_error("Expected column name in grid()");
+        }
+        node->addChild(std::make_shared<ASTNode>(ASTNodeType::IDENTIFIER, advance().value));
+        expect(TokenType::COMMA, "Expected ',' after grid column");
+        auto size = parseOperand();
+        if (!size) {
+            throw std::runtime_error("grid() expects a cell size");
+        }
+        node->addChild(size);
+        expect(TokenType::RPAREN, "Expected ')' after grid cell size");
+        return node;
+    }
+    
+    /**
+     * @brief Argumento de LIMIT u OFFSET: número o '?'
+     */
+    std::shared_ptr<ASTNode> parseRowCount(ASTNodeType type, const std::string& clause) {
+        auto operand = parseOperand();
+        if (!operand) {
+            throw std::runtime_error(clause + " expects a number or '?'");
+        }
+        auto node = std::make_shared<ASTNode>(type);
+        node->addChild(operand);
+        return node;
+    }
+    
+    /**
+     * @brief EXPLAIN [ANALYZE] SELECT ...
+     * value = "ANALYZE" si se pide ejecutar la consulta
+     */
+    std::shared_ptr<ASTNode> parseExplain() {
+        auto node = std::make_shared<ASTNode>(ASTNodeType::EXPLAIN_STMT);
+        
+        expect(TokenType::EXPLAIN);
+        if (match(TokenType::ANALYZE)) {
+            node->value = "ANALYZE";
+        }
+        node->addChild(parseSelect());
+        
+        return node;
+    }
+    
+    /**
+     * @brief [FORMAT fmt] [HEADER] [BULK] [DELIMITER 'c'] [COLUMNS (x, y[, data])]
+     *        [THREADS n] [MAX_ERRORS n], comunes a LOAD y COPY
+     */
+    void parseLoadOptions(const std::shared_ptr<ASTNode>& node, const std::string& statement) {
+        std::string format = "csv";
+        if (match(TokenType::FORMAT)) {
+            if (peek().type != TokenType::IDENTIFIER) {
+                throw std::runtime_error("Expected format name after FORMAT");
+            }
+            format = advance().value;
+        }
+        node->addChild(std::make_shared<ASTNode>(ASTNodeType::IDENTIFIER, format));
+        
+        while (peek().type == TokenType::IDENTIFIER) {
+            std::string name = advance().value;
+            std::transform(name.begin(), name.end(), name.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+            auto option = std::make_shared<ASTNode>(ASTNodeType::IDENTIFIER, name);
+            
+            if (name == "DELIMITER") {
+                if (peek().type != TokenType::STRING || peek().value.size() != 1) {
+                    throw std::runtime_error("DELIMITER expects a one-character string");
+                }
+                option->addChild(std::make_shared<ASTNode>(ASTNodeType::STRING, advance().value));
+            } else if (name == "THREADS" || name == "MAX_ERRORS") {
+                if (peek().type != TokenType::NUMBER) {
+                    throw std::runtime_error(name + " expects a number");
+                }
+                option->addChild(std::make_shared<ASTNode>(ASTNodeType::NUMBER, advance().value));
+            } else if (name == "COLUMNS") {
+                expect(TokenType::LPAREN, "Expected '(' after COLUMNS");
+                while (peek().type == TokenType::NUMBER) {
+                    option->addChild(std::make_shared<ASTNode>(ASTNodeType::NUMBER, advance().value));
+                    if (!match(TokenType::COMMA)) break;
+                }
+                expect(TokenType::RPAREN, "Expected ')' after COLUMNS");
+            } else if (name != "HEADER" && name != "BULK") {
+                throw std::runtime_error("Unknown " + statement + " option: " + name);
+            }
+            node->addChild(option);
+        }
+        
+        match(TokenType::SEMICOLON);
+        if (peek().type != TokenType::END_OF_FILE) {
+            throw std::runtime_error("Unexpected token after " + statement + ": " + peek().value);
+        }
+    }
+    
+    /**
+     * @brief LOAD 'file' INTO table [opciones]
+     * value = fichero; hijos: tabla, formato y una opción por nodo
+     * IDENTIFIER (nombre en mayúsculas, argumentos como hijos)
+     */
+    std::shared_ptr<ASTNode> parseLoad() {
+        auto node = std::make_shared<ASTNode>(ASTNodeType::LOAD_STMT);
+        
+        expect(TokenType::LOAD);
+        if (peek().type != TokenType::STRING) {
+            throw std::runtime_error("Expected quoted file name after LOAD");
+        }
+        node->value = advance().value;
+        
+        expect(TokenType::INTO, "Expected INTO after file name");
+        if (peek().type != TokenType::IDENTIFIER) {
+            throw std::runtime_error("Expected table name after INTO");
+        }
+        node->addChild(std::make_shared<ASTNode>(ASTNodeType::IDENTIFIER, advance().value));
+        
+        parseLoadOptions(node, "LOAD");
+        return node;
+    }
+    
+    /**
+     * @brief COPY table FROM 'file' [opciones]: misma forma de AST que LOAD
+     */
+    std::shared_ptr<ASTNode> parseCopy() {
+        auto node = std::make_shared<ASTNode>(ASTNodeType::COPY_STMT);
+        
+        expect(TokenType::COPY);
+        if (peek().type != TokenType::IDENTIFIER) {
+            throw std::runtime_error("Expected table name after COPY");
+        }
+        auto table = std::make_shared<ASTNode>(ASTNodeType::IDENTIFIER, advance().value);
+        
+        expect(TokenType::FROM, "Expected FROM after table name");
+        if (peek().type != TokenType::STRING) {
+            throw std::runtime_error("Expected quoted file name after FROM");
+        }
+        node->value = advance().value;
+        node->addChild(table);
+        
+        parseLoadOptions(node, "COPY");
+        return node;
     }
     
     /**
      * @brief WHERE clause
-     * WHERE spatial_intersect(column, box)
+     * WHERE spatial_intersect(column, box) [AND column op valor ...]
      */
     std::shared_ptr<ASTNode> parseWhere() {
         auto node = std::make_shared<ASTNode>(ASTNodeType::WHERE_CLAUSE);
         
         expect(TokenType::WHERE);
         
-        // Parse spatial_intersect function
-        if (peek().type == TokenType::SPATIAL_INTERSECT) {
-            auto spatialNode = parseSpatialIntersect();
-            node->addChild(spatialNode);
-        }
+        // Conjunción de spatial_intersect y comparaciones sobre columnas
+        do {
+            if (peek().type == TokenType::SPATIAL_INTERSECT) {
+                node->addChild(parseSpatialIntersect());
+            } else if (peek().type == TokenType::IDENTIFIER) {
+                node->addChild(parseComparison());
+            } else {
+                throw std::runtime_error("Expected spatial_intersect(...) or a column comparison in WHERE");
+            }
+        } while (match(TokenType::AND));
         
         return node;
     }
     
     /**
-     * @brief spatial_intersect(column, x1, y1, x2, y2)
+     * @brief spatial_intersect(column, x1, y1, x2, y2[, t1, t2])
      */
     std::shared_ptr<ASTNode> parseSpatialIntersect() {
         auto node = std::make_shared<ASTNode>(ASTNodeType::SPATIAL_INTERSECT_EXPR);
@@ -129,12 +400,10 @@ private:
         
         expect(TokenType::COMMA);
         
-        // Bounding box coordinates: x1, y1, x2, y2
+        // Bounding box coordinates: x1, y1, x2, y2[, t1, t2]
         for (int i = 0; i < 4; ++i) {
-            if (peek().type == TokenType::NUMBER) {
-                auto numNode = std::make_shared<ASTNode>(ASTNodeType::NUMBER, peek().value);
-                node->addChild(numNode);
-                advance();
+            if (auto operand = parseOperand()) {
+                node->addChild(operand);
             }
             
             if (i < 3) {
@@ -142,6 +411,18 @@ private:
             }
         }
         
+        // Intervalo de tiempo opcional (tablas con columna TIMESTAMP)
+        if (match(TokenType::COMMA)) {
+            for (int i = 0; i < 2; ++i) {
+                if (auto operand = parseOperand()) {
+                    node->addChild(operand);
+                }
+                if (i == 0) {
+                    expect(TokenType::COMMA);
+                }
+            }
+        }
+        
         expect(TokenType::RPAREN);
         
         return node;
@@ -149,7 +430,7 @@ private:
     
     /**
      * @brief INSERT statement
-     * INSERT INTO table VALUES (val1, val2, ...)
+     * INSERT INTO table VALUES (val1, val2, ...)[, (val1, val2, ...) ...]
      */
     std::shared_ptr<ASTNode> parseInsert() {
         auto node = std::make_shared<ASTNode>(ASTNodeType::INSERT_STMT);
@@ -165,29 +446,29 @@ private:
         }
         
         expect(TokenType::VALUES);
-        expect(TokenType::LPAREN);
         
-        // Values list
-        auto valuesNode = std::make_shared<ASTNode>(ASTNodeType::VALUE_LIST);
-        
-        while (peek().type != TokenType::RPAREN && peek().type != TokenType::END_OF_FILE) {
-            if (peek().type == TokenType::NUMBER) {
-                auto numNode = std::make_shared<ASTNode>(ASTNodeType::NUMBER, peek().value);
-                valuesNode->addChild(numNode);
-                advance();
-            } else if (peek().type == TokenType::STRING) {
-                auto strNode = std::make_shared<ASTNode>(ASTNodeType::STRING, peek().value);
-                valuesNode->addChild(strNode);
-                advance();
-            }
+        // Una VALUE_LIST por fila
+        do {
+            expect(TokenType::LPAREN);
+            auto valuesNode = std::make_shared<ASTNode>(ASTNodeType::VALUE_LIST);
             
-            if (peek().type == TokenType::COMMA) {
-                advance();
+            while (peek().type != TokenType::RPAREN && peek().type != TokenType::END_OF_FILE) {
+                if (auto operand = parseOperand()) {
+                    valuesNode->addChild(operand);
+                } else if (peek().type == TokenType::STRING) {
+                    auto strNode = std::make_shared<ASTNode>(ASTNodeType::STRING, peek().value);
+                    valuesNode->addChild(strNode);
+                    advance();
+                }
+                
+                if (peek().type == TokenType::COMMA) {
+                    advance();
+                }
             }
-        }
-        
-        expect(TokenType::RPAREN);
-        node->addChild(valuesNode);
+            
+            expect(TokenType::RPAREN);
+            node->addChild(valuesNode);
+        } while (match(TokenType::COMMA));
         
         return node;
     }
@@ -226,7 +507,8 @@ private:
                     peek().type == TokenType::DOUBLE ||
                     peek().type == TokenType::VARCHAR ||
                     peek().type == TokenType::POINT ||
-                    peek().type == TokenType::GEOMETRY) {
+                    peek().type == TokenType::GEOMETRY ||
+                    peek().type == TokenType::TIMESTAMP) {
                     colType = peek().value;
                     advance();
                 }
@@ -259,10 +541,21 @@ public:
             return parseInsert();
         } else if (peek().type == TokenType::CREATE) {
             return parseCreateTable();
+        } else if (peek().type == TokenType::EXPLAIN) {
+            return parseExplain();
+        } else if (peek().type == TokenType::LOAD) {
+            return parseLoad();
+        } else if (peek().type == TokenType::COPY) {
+            return parseCopy();
         }
         
         throw std::runtime_error("Unknown SQL statement");
     }
+    
+    /**
+     * @brief Parámetros '?' encontrados por parse()
+     */
+    size_t parameterCount() const { return parameters; }
 };
 
 } // namespace sql
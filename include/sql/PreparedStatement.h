@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sql {
+
+/**
+ * @brief Operando de un plan: parámetro posicional o constante
+ */
+struct PlanOperand {
+    int parameter = -1;         // Índice en los valores enlazados; -1 = constante
+    double constant = 0.0;
+
+    double bind(const std::vector<double>& values) const {
+        return parameter >= 0 ? values[static_cast<size_t>(parameter)] : constant;
+    }
+};
+
+/**
+ * @brief Columna agregada de un GROUP BY grid
+ */
+struct PlanAggregate {
+    enum class Function { COUNT, SUM, AVG };
+
+    Function function = Function::COUNT;
+    std::string label;          // Cabecera de la columna, p.ej. "SUM(value)"
+};
+
+/**
+ * @brief Comparación del payload con un valor (conjunción en WHERE)
+ */
+struct PlanPredicate {
+    enum class Op { EQ, LT, LE, GT, GE };
+
+    Op op = Op::EQ;
+    PlanOperand value;
+};
+
+/**
+ * @brief Plan compilado de un INSERT o SELECT
+ * Ejecutarlo solo enlaza valores y llama al LSM-tree: no hay lexer,
+ * parser ni recorrido del AST.
+ *   INSERT  operands = x, y[, t][, data] por fila, rowWidth operandos cada una
+ *   SELECT  operands = x1, y1, x2, y2[, t1, t2] (vacío = sin WHERE, todo el
+ *           espacio; sin t1, t2 todo el tiempo); limit y offset si hay
+ *           LIMIT/OFFSET; predicates sobre el payload
+ * dimensions es la de la tabla: 3 si tiene columna TIMESTAMP (x, y, t).
+ *   GRID    como SELECT, más cellSize y las columnas agregadas (LIMIT/OFFSET
+ *           se aplican a las celdas)
+ */
+struct QueryPlan {
+    enum class Kind { INSERT, SELECT, COUNT, GRID };
+
+    Kind kind = Kind::SELECT;
+    std::string table;
+    size_t dimensions = 2;
+    std::vector<PlanOperand> operands;
+    size_t rowWidth = 0;
+    bool limited = false;
+    PlanOperand limit;
+    PlanOperand offset;         // Constante 0 si no hay OFFSET
+    PlanOperand cellSize;
+    std::vector<PlanAggregate> aggregates;
+    std::vector<PlanPredicate> predicates;
+    size_t parameters = 0;
+};
+
+/**
+ * @brief Valor de una posición '?' del texto normalizado
+ * Los literales numéricos se sustituyen por '?' (auto-parametrización) y
+ * guardan aquí su valor; los '?' originales son parámetros del usuario.
+ */
+struct PlanSlot {
+    bool user = false;
+    double value = 0.0;
+};
+
+struct NormalizedStatement {
+    std::string key;                // Espacios colapsados, literales numéricos como '?'
+    std::vector<PlanSlot> slots;    // Una entrada por '?' de key, en orden
+
+    size_t userParameters() const {
+        size_t n = 0;
+        for (const auto& s : slots) n += s.user ? 1 : 0;
+        return n;
+    }
+
+    /**
+     * @brief Valores de todas las posiciones con los argumentos del usuario
+     */
+    std::vector<double> bind(const std::vector<double>& args) const {
+        if (args.size() != userParameters()) {
+            throw std::runtime_error("Expected " + std::to_string(userParameters()) +
+                                     " parameter(s), got " + std::to_string(args.size()));
+        }
+        std::vector<double> values;
+        values.reserve(slots.size());
+        size_t next = 0;
+        for (const auto& s : slots) values.push_back(s.user ? args[next++] : s.value);
+        return values;
+    }
+};
+
+/**
+ * @brief Lee un literal numérico como el lexer: [signo] dígitos/puntos [exponente]
+ * @return Posición tras el literal, o begin si no hay número
+ */
+inline const char* scanNumber(const char* begin, const char* end, double& value) {
+    const char* p = begin;
+    if (p < end && (*p == '-' || *p == '+')) ++p;
+    const char* digits = p;
+    while (p < end && (std::isdigit(static_cast<unsigned char>(*p)) || *p == '.')) ++p;
+    if (p == digits) return begin;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        if (q < end && (*q == '-' || *q == '+')) ++q;
+        if (q < end && std::isdigit(static_cast<unsigned char>(*q))) {
+            while (q < end && std::isdigit(static_cast<unsigned char>(*q))) ++q;
+            p = q;
+        }
+    }
+    const char* start = (*begin == '+') ? begin + 1 : begin;
+    auto [parsed, ec] = std::from_chars(start, p, value);
+    if (ec != std::errc() || parsed != p) return begin;
+    return p;
+}
+
+/**
+ * @brief Normaliza una sentencia en una sola pasada
+ * Colapsa espacios, quita el ';' final y sustituye cada literal numérico
+ * por '?' guardando su valor; las cadenas se copian tal cual. Dos
+ * sentencias que solo difieren en sus constantes comparten clave y plan.
+ */
+inline NormalizedStatement normalizeStatement(const std::string& sql) {
+    NormalizedStatement out;
+    out.key.reserve(sql.size());
+    const char* p = sql.data();
+    const char* end = p + sql.size();
+    bool pendingSpace = false;
+
+    auto emit = [&](char c) {
+        if (pendingSpace && !out.key.empty()) out.key += ' ';
+        pendingSpace = false;
+        out.key += c;
+    };
+
+    while (p < end) {
+        char c = *p;
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            pendingSpace = true;
+            ++p;
+        } else if (c == '\'') {
+            emit(*p++);
+            while (p < end) {
+                out.key += *p;
+                if (*p++ == '\'') {
+                    if (p < end && *p == '\'') {
+                        out.key += *p++;
+                        continue;
+                    }
+                    break;
+                }
+            }
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            while (p < end && (std::isalnum(static_cast<unsigned char>(*p)) || *p == '_')) emit(*p++);
+        } else if (c == '?') {
+            emit('?');
+            out.slots.push_back({true, 0.0});
+            ++p;
+        } else {
+            double value = 0.0;
+            const char* next = scanNumber(p, end, value);
+            if (next != p) {
+                emit('?');
+                out.slots.push_back({false, value});
+                p = next;
+            } else {
+                emit(*p++);
+            }
+        }
+    }
+
+    while (!out.key.empty() && out.key.back() == ';') out.key.pop_back();
+    while (!out.key.empty() && out.key.back() == ' ') out.key.pop_back();
+    return out;
+}
+
+/**
+ * @brief Caché LRU de planes compilados por texto normalizado
+ */
+class PlanCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t entries = 0;
+    };
+
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const QueryPlan>>;
+    using EntryList = std::list<Entry>;   // Frente = más reciente
+
+    size_t capacity;
+    EntryList lru;
+    std::unordered_map<std::string, EntryList::iterator> index;
+    Stats stats;
+    mutable std::mutex mutex;
+
+public:
+    explicit PlanCache(size_t maxEntries = 256) : capacity(std::max<size_t>(1, maxEntries)) {}
+
+    std::shared_ptr<const QueryPlan> get(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            ++stats.misses;
+            return nullptr;
+        }
+        ++stats.hits;
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->second;
+    }
+
+    void put(const std::string& key, std::shared_ptr<const QueryPlan> plan) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            it->second->second = std::move(plan);
+            lru.splice(lru.begin(), lru, it->second);
+            return;
+        }
+        if (lru.size() >= capacity) {
+            index.erase(lru.back().first);
+            lru.pop_back();
+        }
+        lru.emplace_front(key, std::move(plan));
+        index[key] = lru.begin();
+    }
+
+    /**
+     * @brief Descarta los planes (p.ej. al recrear una tabla)
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        lru.clear();
+        index.clear();
+    }
+
+    Stats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats s = stats;
+        s.entries = lru.size();
+        return s;
+    }
+};
+
+/**
+ * @brief Sentencia preparada: plan compartido + constantes de su texto
+ */
+struct PreparedStatement {
+    std::string text;
+    NormalizedStatement normalized;
+    std::shared_ptr<const QueryPlan> plan;
+};
+
+} // namespace sql
@@ -1,13 +1,21 @@
 #pragma once
 
 #include "Parser.h"
+#include "PreparedStatement.h"
 #include "../lsm/LSMTree.h"
+#include "../lsm/PointLoader.h"
 #include "../spatial/Point.h"
 #include "../spatial/MBR.h"
 #include <map>
 #include <string>
 #include <memory>
 #include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <limits>
+#include <ostream>
 
 namespace sql {
 
@@ -22,9 +30,19 @@ struct TableSchema {
     std::vector<std::string> columns;
     std::vector<std::string> types;
     std::string spatialColumn;  // Nombre de la columna espacial
+    std::string timeColumn;     // Columna TIMESTAMP (vacío = tabla solo espacial)
+    
+    static constexpr size_t TIME_DIMENSION = 2;   // Los puntos son (x, y, t)
     
     TableSchema() = default;
     TableSchema(const std::string& n) : name(n) {}
+    
+    static bool isTimeType(const std::string& type) {
+        return type == "TIMESTAMP" || type == "timestamp";
+    }
+    
+    bool isTemporal() const { return !timeColumn.empty(); }
+    size_t dimensions() const { return isTemporal() ? 3 : 2; }
 };
 
 /**
@@ -33,12 +51,61 @@ struct TableSchema {
 class CatalogManager {
 private:
     std::map<std::string, TableSchema> tables;
+    std::shared_ptr<Manifest> manifest;  // Opcional: persiste los esquemas
+    
+    /**
+     * @brief Serializa un esquema: columna espacial y luego "col:tipo" por línea
+     */
+    static std::string encodeSchema(const TableSchema& schema) {
+        std::string out = schema.spatialColumn + "\n";
+        for (size_t i = 0; i < schema.columns.size(); ++i) {
+            out += schema.columns[i] + ":" + (i < schema.types.size() ? schema.types[i] : "") + "\n";
+        }
+        return out;
+    }
+    
+    static TableSchema decodeSchema(const std::string& name, const std::string& data) {
+        TableSchema schema(name);
+        std::stringstream ss(data);
+        std::string line;
+        std::getline(ss, schema.spatialColumn);
+        while (std::getline(ss, line)) {
+            size_t colonPos = line.find(':');
+            if (colonPos == std::string::npos) continue;
+            schema.columns.push_back(line.substr(0, colonPos));
+            schema.types.push_back(line.substr(colonPos + 1));
+            if (TableSchema::isTimeType(schema.types.back()) && schema.timeColumn.empty()) {
+                schema.timeColumn = schema.columns.back();
+            }
+        }
+        return schema;
+    }
     
 public:
     void createTable(const TableSchema& schema) {
+        if (manifest) {
+            manifest->logAndApply({VersionEdit::putTable(schema.name, encodeSchema(schema))});
+        }
         tables[schema.name] = schema;
     }
     
+    /**
+     * @brief Conecta el catálogo al MANIFEST y recupera los esquemas guardados
+     */
+    void attachManifest(std::shared_ptr<Manifest> m) {
+        manifest = std::move(m);
+        if (!manifest) return;
+        for (const auto& [name, state] : manifest->getTables()) {
+            if (state.hasSchema) tables[name] = decodeSchema(name, state.schema);
+        }
+    }
+    
+    std::vector<std::string> getTableNames() const {
+        std::vector<std::string> names;
+        for (const auto& [name, schema] : tables) names.push_back(name);
+        return names;
+    }
+    
     bool tableExists(const std::string& name) const {
         return tables.find(name) != tables.end();
     }
@@ -60,6 +127,20 @@ public:
     }
 };
 
+/**
+ * @brief Recursos compartidos y opciones para los LSM-trees de las tablas
+ */
+struct TreeOptions {
+    std::shared_ptr<WriteBufferManager> writeBufferManager;  // Presupuesto global de MemTables
+    std::shared_ptr<util::ThreadPool> queryPool;             // Fan-out de consultas
+    size_t maxQueryParallelism = 4;
+    size_t resultCacheBytes = 0;                             // 0 = sin caché de resultados
+    double resultCacheCellSize = 0.01;
+    std::shared_ptr<Manifest> manifest;                      // Persistencia de componentes
+    double timeWindow = 3600.0;                              // Ventana de las tablas con TIMESTAMP
+    size_t timeWindowMergeComponents = 4;                    // Componentes de una ventana que se fusionan
+};
+
 /**
  * @brief Motor de ejecución de consultas SQL
  * Traduce AST a operaciones sobre LSM-tree
@@ -69,16 +150,87 @@ class QueryExecutor {
 private:
     CatalogManager& catalog;
     std::map<std::string, std::shared_ptr<LSMTree<T>>>& lsmTrees;
+    TreeOptions treeOptions;
+    PlanCache planCache;
+    std::map<std::string, PreparedStatement> preparedStatements;
+    
+    static constexpr size_t INSERT_BATCH_ROWS = 4096;   // Filas por insertBatch() en INSERT multi-fila
+    static constexpr size_t CURSOR_BATCH_ROWS = 1024;   // Filas por lote al servir un cursor
+    
+    /**
+     * @brief Crea el LSM-tree de una tabla y lo conecta al presupuesto global
+     * Una tabla con TIMESTAMP indexa (x, y, t) y compacta por ventanas de
+     * tiempo, de modo que sus componentes quedan disjuntos en el tiempo.
+     */
+    std::shared_ptr<LSMTree<T>> createTree(const std::string& tableName) {
+        const TableSchema& schema = catalog.getTable(tableName);
+        auto tree = std::make_shared<LSMTree<T>>(schema.dimensions());
+        if (schema.isTemporal()) {
+            tree->setCompactionPolicy(
+                std::make_shared<TimeWindowMergePolicy<T>>(TableSchema::TIME_DIMENSION, treeOptions.timeWindow,
+                                                           treeOptions.timeWindowMergeComponents),
+                std::make_shared<TimePartitioning<T>>(TableSchema::TIME_DIMENSION, treeOptions.timeWindow));
+        }
+        if (treeOptions.manifest) {
+            tree->attachManifest(treeOptions.manifest, tableName);
+        }
+        if (treeOptions.writeBufferManager) {
+            tree->attachWriteBufferManager(treeOptions.writeBufferManager, tableName);
+        }
+        if (treeOptions.queryPool) {
+            tree->setQueryThreadPool(treeOptions.queryPool, treeOptions.maxQueryParallelism);
+        }
+        if (treeOptions.resultCacheBytes > 0) {
+            tree->enableResultCache(treeOptions.resultCacheBytes, treeOptions.resultCacheCellSize);
+        }
+        lsmTrees[tableName] = tree;
+        return tree;
+    }
     
 public:
     QueryExecutor(CatalogManager& cat, 
-                 std::map<std::string, std::shared_ptr<LSMTree<T>>>& trees)
-        : catalog(cat), lsmTrees(trees) {}
+                 std::map<std::string, std::shared_ptr<LSMTree<T>>>& trees,
+                 const TreeOptions& options = TreeOptions())
+        : catalog(cat), lsmTrees(trees), treeOptions(options) {}
+    
+    /**
+     * @brief Crea los LSM-trees de las tablas recuperadas del catálogo
+     */
+    void openTables() {
+        for (const auto& name : catalog.getTableNames()) {
+            if (lsmTrees.find(name) == lsmTrees.end()) {
+                createTree(name);
+            }
+        }
+    }
     
     /**
      * @brief Ejecuta una consulta SQL
+     * INSERT y SELECT pasan por la caché de planes: el texto se normaliza
+     * (literales numéricos como '?') y, si ya hay plan, se ejecuta sin
+     * lexer ni parser. PREPARE/EXECUTE/DEALLOCATE gestionan sentencias
+     * preparadas con parámetros '?'. Un INSERT de varias filas no se
+     * cachea: sus tuplas van directamente a escrituras por lotes.
      */
     std::string execute(const std::string& sql) {
+        std::string verb = leadingKeyword(sql);
+        if (verb == "INSERT" && isMultiRowInsert(sql)) {
+            return executeInsertRows(sql);
+        }
+        if (verb == "INSERT" || verb == "SELECT") {
+            NormalizedStatement normalized = normalizeStatement(sql);
+            if (normalized.userParameters() > 0) {
+                return "Error: '?' parameters are only allowed in PREPARE";
+            }
+            std::string error;
+            auto plan = planFor(normalized.key, error);
+            if (!plan) return error;
+            return runPlan(*plan, normalized.bind({}));
+        }
+        if (verb == "PREPARE") return executePrepare(sql);
+        if (verb == "EXECUTE") return executeExecute(sql);
+        if (verb == "DEALLOCATE") return executeDeallocate(sql);
+        
         // Lexer
         SQLLexer lexer(sql);
         auto tokens = lexer.tokenize();
@@ -88,22 +240,101 @@ public:
         auto ast = parser.parse();
         
         // Ejecutar según tipo de statement
-        if (ast->type == ASTNodeType::SELECT_STMT) {
-            return executeSelect(ast);
-        } else if (ast->type == ASTNodeType::INSERT_STMT) {
-            return executeInsert(ast);
-        } else if (ast->type == ASTNodeType::CREATE_TABLE_STMT) {
+        if (ast->type == ASTNodeType::CREATE_TABLE_STMT) {
             return executeCreateTable(ast);
+        } else if (ast->type == ASTNodeType::EXPLAIN_STMT) {
+            return executeExplain(ast);
+        } else if (ast->type == ASTNodeType::LOAD_STMT || ast->type == ASTNodeType::COPY_STMT) {
+            return executeLoad(ast);
         }
         
         return "Error: Unknown statement type";
     }
     
+    /**
+     * @brief Ejecuta una sentencia escribiendo el resultado en out
+     * Un SELECT de filas se sirve con un cursor: cada lote de
+     * CURSOR_BATCH_ROWS filas se escribe (y se vacía out) antes de leer el
+     * siguiente, así que la primera fila aparece sin esperar al resto y la
+     * memoria no depende del tamaño del resultado. El resto de sentencias
+     * escriben lo mismo que execute(sql).
+     */
+    void execute(const std::string& sql, std::ostream& out) {
+        if (leadingKeyword(sql) == "SELECT") {
+            std::string error;
+            bool rowSelect = false;
+            auto cursor = openCursor(sql, error, rowSelect);
+            if (cursor) {
+                streamRows(*cursor, out);
+                return;
+            }
+            if (rowSelect) {
+                out << error;
+                return;
+            }
+        }
+        out << execute(sql);
+    }
+    
+    /**
+     * @brief Abre un cursor para un SELECT * sin parámetros '?'
+     * El llamador pide filas con next(n) y puede abandonarlo en cualquier
+     * momento; LIMIT/OFFSET ya van dentro del cursor.
+     * @return nullptr con error relleno si no es un SELECT de filas válido
+     */
+    std::unique_ptr<typename LSMTree<T>::RangeCursor> openCursor(const std::string& sql,
+                                                                std::string& error) {
+        bool rowSelect = false;
+        auto cursor = openCursor(sql, error, rowSelect);
+        if (!cursor && error.empty()) error = "Error: Cursors need a SELECT * statement";
+        return cursor;
+    }
+    
+    /**
+     * @brief Prepara statement (INSERT o SELECT con '?') con nombre
+     */
+    std::string prepare(const std::string& name, const std::string& statement) {
+        std::string verb = leadingKeyword(statement);
+        if (verb != "INSERT" && verb != "SELECT") {
+            return "Error: Only INSERT and SELECT can be prepared";
+        }
+        PreparedStatement prepared;
+        prepared.text = statement;
+        prepared.normalized = normalizeStatement(statement);
+        std::string error;
+        prepared.plan = planFor(prepared.normalized.key, error);
+        if (!prepared.plan) return error;
+        
+        size_t parameters = prepared.normalized.userParameters();
+        preparedStatements[name] = std::move(prepared);
+        return "PREPARE " + name + " (" + std::to_string(parameters) + " parameter(s))";
+    }
+    
+    /**
+     * @brief Ejecuta una sentencia preparada con sus parámetros
+     */
+    std::string executePrepared(const std::string& name, const std::vector<double>& args) {
+        auto it = preparedStatements.find(name);
+        if (it == preparedStatements.end()) {
+            return "Error: Prepared statement '" + name + "' does not exist";
+        }
+        return runPlan(*it->second.plan, it->second.normalized.bind(args));
+    }
+    
+    bool deallocate(const std::string& name) {
+        return preparedStatements.erase(name) > 0;
+    }
+    
+    PlanCache::Stats getPlanCacheStats() const { return planCache.getStats(); }
+    size_t preparedStatementCount() const { return preparedStatements.size(); }
+    
 private:
     /**
-     * @brief Ejecuta SELECT COUNT(*) ... WHERE spatial_intersect(...)
+     * @brief Resuelve la tabla y el MBR de consulta de un SELECT
+     * @return Mensaje de error, vacío si la consulta es válida
      */
-    std::string executeSelect(const std::shared_ptr<ASTNode>& ast) {
+    std::string resolveSelect(const std::shared_ptr<ASTNode>& ast,
+                              std::shared_ptr<LSMTree<T>>& lsmTree, MBR& queryBox) {
         // Extraer nombre de tabla
         std::string tableName;
         for (const auto& child : ast->children) {
@@ -123,10 +354,11 @@ private:
             return "Error: LSM-tree not found for table '" + tableName + "'";
         }
         
-        auto& lsmTree = it->second;
+        lsmTree = it->second;
+        const size_t dims = catalog.getTable(tableName).dimensions();
         
         // Buscar cláusula WHERE con spatial_intersect
-        MBR queryBox(2);  // Asumimos 2D por defecto
+        queryBox = MBR(dims);
         bool hasWhere = false;
         
         for (const auto& child : ast->children) {
@@ -136,98 +368,783 @@ private:
                 // Extraer parámetros de spatial_intersect
                 for (const auto& whereChild : child->children) {
                     if (whereChild->type == ASTNodeType::SPATIAL_INTERSECT_EXPR) {
-                        queryBox = extractQueryBox(whereChild);
+                        if (whereChild->children.size() > 5 && dims < 3) {
+                            return "Error: Table '" + tableName + "' has no TIMESTAMP column for t1, t2";
+                        }
+                        queryBox = extractQueryBox(whereChild, dims);
                     }
                 }
             }
         }
         
-        // Ejecutar búsqueda espacial
-        std::vector<SpatialRecord<T>> results;
-        
-        if (hasWhere) {
-            results = lsmTree->spatialRangeQuery(queryBox);
-        } else {
+        if (!hasWhere) {
             // Sin WHERE: retornar todos los registros
             // Para esto necesitamos un MBR que cubra todo
-            MBR fullBox(2);
-            Point lower({-1e9, -1e9});
-            Point upper({1e9, 1e9});
-            fullBox.setLower(lower);
-            fullBox.setUpper(upper);
-            results = lsmTree->spatialRangeQuery(fullBox);
+            MBR fullBox(dims);
+            std::vector<double> lower{-1e9, -1e9}, upper{1e9, 1e9};
+            if (dims > 2) {
+                lower.push_back(std::numeric_limits<double>::lowest());
+                upper.push_back(std::numeric_limits<double>::max());
+            }
+            fullBox.setLower(Point(lower));
+            fullBox.setUpper(Point(upper));
+            queryBox = fullBox;
         }
         
-        // Verificar si es COUNT(*)
-        bool isCount = false;
+        return "";
+    }
+    
+    /**
+     * @brief Cursor de un SELECT de filas
+     * @param rowSelect true si la sentencia es un SELECT * válido (aunque falle al abrir)
+     */
+    std::unique_ptr<typename LSMTree<T>::RangeCursor> openCursor(const std::string& sql,
+                                                                std::string& error,
+                                                                bool& rowSelect) {
+        NormalizedStatement normalized = normalizeStatement(sql);
+        if (normalized.userParameters() > 0) {
+            error = "Error: '?' parameters are only allowed in PREPARE";
+            return nullptr;
+        }
+        auto plan = planFor(normalized.key, error);
+        if (!plan || plan->kind != QueryPlan::Kind::SELECT) return nullptr;
+        
+        rowSelect = true;
+        auto values = normalized.bind({});
+        auto it = lsmTrees.find(plan->table);
+        if (it == lsmTrees.end()) {
+            error = "Error: LSM-tree not found for table '" + plan->table + "'";
+            return nullptr;
+        }
+        size_t offset = 0, limit = 0;
+        if (!bindWindow(*plan, values, offset, limit, error)) return nullptr;
+        return it->second->openRangeCursor(planBox(*plan, values), offset, limit,
+                                           bindPredicates(*plan, values));
+    }
+    
+    void streamRows(typename LSMTree<T>::RangeCursor& cursor, std::ostream& out) {
+        out << "Results:\n";
+        for (auto batch = cursor.next(CURSOR_BATCH_ROWS); !batch.empty();
+             batch = cursor.next(CURSOR_BATCH_ROWS)) {
+            for (const auto& rec : batch) formatRow(out, rec);
+            out.flush();
+        }
+        out << "(" << cursor.rowsProduced() << " rows)";
+    }
+    
+    static void formatRow(std::ostream& out, const SpatialRecord<T>& rec) {
+        out << "Point: (";
+        for (size_t i = 0; i < rec.point.dimensions(); ++i) {
+            if (i > 0) out << ", ";
+            out << rec.point[i];
+        }
+        out << ")\n";
+    }
+    
+    /**
+     * @brief Box de consulta de un plan SELECT; sin WHERE, un MBR que cubre todo
+     * En tablas con TIMESTAMP la tercera dimensión es [t1, t2], o todo el
+     * tiempo si spatial_intersect no lo acota.
+     */
+    static MBR planBox(const QueryPlan& plan, const std::vector<double>& values) {
+        std::vector<double> lower{-1e9, -1e9}, upper{1e9, 1e9};
+        if (!plan.operands.empty()) {
+            lower = {plan.operands[0].bind(values), plan.operands[1].bind(values)};
+            upper = {plan.operands[2].bind(values), plan.operands[3].bind(values)};
+        }
+        if (plan.dimensions > 2) {
+            bool timed = plan.operands.size() == 6;
+            lower.push_back(timed ? plan.operands[4].bind(values) : std::numeric_limits<double>::lowest());
+            upper.push_back(timed ? plan.operands[5].bind(values) : std::numeric_limits<double>::max());
+        }
+        return MBR(Point(lower), Point(upper));
+    }
+    
+    /**
+     * @brief OFFSET y LIMIT enlazados (sin LIMIT = SIZE_MAX)
+     */
+    static bool bindWindow(const QueryPlan& plan, const std::vector<double>& values,
+                           size_t& offset, size_t& limit, std::string& error) {
+        double rowsToSkip = plan.offset.bind(values);
+        double maxRows = plan.limited ? plan.limit.bind(values) : 0.0;
+        if (rowsToSkip < 0 || maxRows < 0) {
+            error = "Error: LIMIT and OFFSET must be non-negative";
+            return false;
+        }
+        offset = static_cast<size_t>(rowsToSkip);
+        limit = plan.limited ? static_cast<size_t>(maxRows) : std::numeric_limits<size_t>::max();
+        return true;
+    }
+    
+    /**
+     * @brief Primera palabra de la sentencia, en mayúsculas
+     */
+    static std::string leadingKeyword(const std::string& sql) {
+        size_t start = 0;
+        while (start < sql.size() && std::isspace(static_cast<unsigned char>(sql[start]))) ++start;
+        size_t end = start;
+        while (end < sql.size() && std::isalpha(static_cast<unsigned char>(sql[end]))) ++end;
+        std::string word = sql.substr(start, end - start);
+        std::transform(word.begin(), word.end(), word.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        return word;
+    }
+    
+    /**
+     * @brief Plan de un texto normalizado: de la caché o compilado y cacheado
+     * Los errores (tabla inexistente, valores inválidos) no se cachean.
+     */
+    std::shared_ptr<const QueryPlan> planFor(const std::string& key, std::string& error) {
+        if (auto cached = planCache.get(key)) return cached;
+        
+        SQLLexer lexer(key);
+        SQLParser parser(lexer.tokenize());
+        auto ast = parser.parse();
+        auto plan = compilePlan(ast, error);
+        if (!plan) return nullptr;
+        plan->parameters = parser.parameterCount();
+        planCache.put(key, plan);
+        return plan;
+    }
+    
+    static PlanOperand toOperand(const std::shared_ptr<ASTNode>& node) {
+        PlanOperand operand;
+        if (node->type == ASTNodeType::PARAMETER) {
+            operand.parameter = std::stoi(node->value);
+        } else {
+            operand.constant = std::stod(node->value);
+        }
+        return operand;
+    }
+    
+    static bool isOperand(const std::shared_ptr<ASTNode>& node) {
+        return node->type == ASTNodeType::NUMBER || node->type == ASTNodeType::PARAMETER;
+    }
+    
+    /**
+     * @brief column op valor → predicado sobre el payload
+     * El payload es el único atributo que guarda el LSM-tree: cualquier
+     * columna no espacial de la tabla se refiere a él.
+     */
+    bool compilePredicate(QueryPlan& plan, const std::shared_ptr<ASTNode>& node, std::string& error) {
+        const std::string& column = node->children[0]->value;
+        if (catalog.tableExists(plan.table) && column == catalog.getTable(plan.table).spatialColumn) {
+            error = "Error: Column '" + column + "' is spatial; use spatial_intersect";
+            return false;
+        }
+        if (catalog.tableExists(plan.table) && column == catalog.getTable(plan.table).timeColumn) {
+            error = "Error: Column '" + column + "' is the time dimension; "
+                    "use spatial_intersect(col, x1, y1, x2, y2, t1, t2)";
+            return false;
+        }
+        static const std::map<std::string, PlanPredicate::Op> ops = {
+            {"=", PlanPredicate::Op::EQ}, {"<", PlanPredicate::Op::LT}, {"<=", PlanPredicate::Op::LE},
+            {">", PlanPredicate::Op::GT}, {">=", PlanPredicate::Op::GE}
+        };
+        PlanPredicate predicate;
+        predicate.op = ops.at(node->value);
+        predicate.value = toOperand(node->children[1]);
+        plan.predicates.push_back(predicate);
+        return true;
+    }
+    
+    /**
+     * @brief Conjunción de predicados del plan como intervalo de payloads
+     */
+    static ValueRange bindPredicates(const QueryPlan& plan, const std::vector<double>& values) {
+        ValueRange range;
+        for (const auto& p : plan.predicates) {
+            double v = p.value.bind(values);
+            switch (p.op) {
+                case PlanPredicate::Op::EQ: range.atLeast(v, true); range.atMost(v, true); break;
+                case PlanPredicate::Op::LT: range.atMost(v, false); break;
+                case PlanPredicate::Op::LE: range.atMost(v, true); break;
+                case PlanPredicate::Op::GT: range.atLeast(v, false); break;
+                case PlanPredicate::Op::GE: range.atLeast(v, true); break;
+            }
+        }
+        return range;
+    }
+    
+    /**
+     * @brief Traduce el AST de un INSERT o SELECT a un plan
+     * @return nullptr con error relleno si la sentencia no es válida
+     */
+    std::shared_ptr<QueryPlan> compilePlan(const std::shared_ptr<ASTNode>& ast, std::string& error) {
+        auto plan = std::make_shared<QueryPlan>();
+        
+        if (ast->type == ASTNodeType::INSERT_STMT) {
+            plan->kind = QueryPlan::Kind::INSERT;
+            plan->table = ast->children[0]->value;
+            if (!catalog.tableExists(plan->table)) {
+                error = "Error: Table '" + plan->table + "' does not exist";
+                return nullptr;
+            }
+            // Por fila, las primeras coordenadas son el punto (x, y[, t]); la siguiente, el dato
+            plan->dimensions = catalog.getTable(plan->table).dimensions();
+            for (size_t row = 1; row < ast->children.size(); ++row) {
+                size_t width = 0;
+                for (const auto& value : ast->children[row]->children) {
+                    if (isOperand(value) && width < plan->dimensions + 1) {
+                        plan->operands.push_back(toOperand(value));
+                        ++width;
+                    }
+                }
+                if (row == 1) plan->rowWidth = width;
+                if (width < plan->dimensions) {
+                    error = "Error: Invalid INSERT values in row " + std::to_string(row);
+                    return nullptr;
+                }
+                if (width != plan->rowWidth) {
+                    error = "Error: Row " + std::to_string(row) + " has " + std::to_string(width) +
+                            " values, expected " + std::to_string(plan->rowWidth);
+                    return nullptr;
+                }
+            }
+            return plan;
+        }
+        
+        if (ast->type != ASTNodeType::SELECT_STMT) {
+            error = "Error: Unknown statement type";
+            return nullptr;
+        }
+        
+        plan->kind = QueryPlan::Kind::SELECT;
+        bool selectsGrid = false;
         for (const auto& child : ast->children) {
-            if (child->type == ASTNodeType::COUNT_EXPR) {
-                isCount = true;
-                break;
+            if (child->type == ASTNodeType::IDENTIFIER && plan->table.empty()) {
+                plan->table = child->value;
+            } else if (child->type == ASTNodeType::COUNT_EXPR) {
+                plan->aggregates.push_back({PlanAggregate::Function::COUNT, "COUNT(*)"});
+            } else if (child->type == ASTNodeType::SUM_EXPR) {
+                plan->aggregates.push_back({PlanAggregate::Function::SUM, "SUM(" + child->value + ")"});
+            } else if (child->type == ASTNodeType::AVG_EXPR) {
+                plan->aggregates.push_back({PlanAggregate::Function::AVG, "AVG(" + child->value + ")"});
+            } else if (child->type == ASTNodeType::GRID_EXPR) {
+                selectsGrid = true;
+            } else if (child->type == ASTNodeType::GROUP_BY_CLAUSE) {
+                plan->kind = QueryPlan::Kind::GRID;
+                plan->cellSize = toOperand(child->children[0]->children[1]);
+            } else if (child->type == ASTNodeType::LIMIT_CLAUSE) {
+                plan->limited = true;
+                plan->limit = toOperand(child->children[0]);
+            } else if (child->type == ASTNodeType::OFFSET_CLAUSE) {
+                plan->offset = toOperand(child->children[0]);
+            } else if (child->type == ASTNodeType::WHERE_CLAUSE) {
+                for (const auto& whereChild : child->children) {
+                    if (whereChild->type == ASTNodeType::COMPARISON_EXPR) {
+                        if (!compilePredicate(*plan, whereChild, error)) return nullptr;
+                        continue;
+                    }
+                    if (whereChild->type != ASTNodeType::SPATIAL_INTERSECT_EXPR) continue;
+                    for (size_t i = 1; i < whereChild->children.size(); ++i) {
+                        if (isOperand(whereChild->children[i])) {
+                            plan->operands.push_back(toOperand(whereChild->children[i]));
+                        }
+                    }
+                    if (plan->operands.size() != 4 && plan->operands.size() != 6) {
+                        error = "Error: spatial_intersect expects x1, y1, x2, y2[, t1, t2]";
+                        return nullptr;
+                    }
+                }
+            }
+        }
+        if (!catalog.tableExists(plan->table)) {
+            error = "Error: Table '" + plan->table + "' does not exist";
+            return nullptr;
+        }
+        plan->dimensions = catalog.getTable(plan->table).dimensions();
+        if (plan->operands.size() == 6 && plan->dimensions < 3) {
+            error = "Error: Table '" + plan->table + "' has no TIMESTAMP column for t1, t2";
+            return nullptr;
+        }
+        
+        if (plan->kind == QueryPlan::Kind::GRID) {
+            if (plan->aggregates.empty()) {
+                plan->aggregates.push_back({PlanAggregate::Function::COUNT, "COUNT(*)"});
+            }
+        } else if (selectsGrid || plan->aggregates.size() > 1 ||
+                   (plan->aggregates.size() == 1 &&
+                    plan->aggregates[0].function != PlanAggregate::Function::COUNT)) {
+            error = "Error: SUM, AVG and grid() need GROUP BY grid(column, size)";
+            return nullptr;
+        } else if (!plan->aggregates.empty()) {
+            plan->kind = QueryPlan::Kind::COUNT;
+        }
+        return plan;
+    }
+    
+    /**
+     * @brief Ejecuta un plan con los valores de todas sus posiciones '?'
+     */
+    std::string runPlan(const QueryPlan& plan, const std::vector<double>& values) {
+        auto it = lsmTrees.find(plan.table);
+        
+        if (plan.kind == QueryPlan::Kind::INSERT) {
+            auto tree = it != lsmTrees.end() ? it->second : createTree(plan.table);
+            const size_t width = plan.rowWidth;
+            auto rowRecord = [&](size_t row) {
+                const PlanOperand* op = &plan.operands[row * width];
+                std::vector<double> coords(plan.dimensions);
+                for (size_t d = 0; d < plan.dimensions; ++d) coords[d] = op[d].bind(values);
+                T data = width > plan.dimensions ? static_cast<T>(op[plan.dimensions].bind(values)) : T();
+                Point point(coords);
+                return SpatialRecord<T>(point, data, false);
+            };
+            
+            size_t rows = plan.operands.size() / width;
+            if (rows == 1) {
+                auto record = rowRecord(0);
+                tree->insert(record.point, record.data);
+                return "INSERT successful";
             }
+            std::vector<SpatialRecord<T>> batch;
+            batch.reserve(rows);
+            for (size_t row = 0; row < rows; ++row) batch.push_back(rowRecord(row));
+            return "INSERT " + std::to_string(tree->insertBatch(batch)) + " rows";
         }
         
-        if (isCount) {
-            return "COUNT(*): " + std::to_string(results.size());
+        if (it == lsmTrees.end()) {
+            return "Error: LSM-tree not found for table '" + plan.table + "'";
+        }
+        
+        MBR queryBox = planBox(plan, values);
+        ValueRange range = bindPredicates(plan, values);
+        if (plan.kind == QueryPlan::Kind::COUNT) {
+            if (range.unbounded()) {
+                return "COUNT(*): " + std::to_string(it->second->spatialCount(queryBox));
+            }
+            // Con predicados se cuenta con el cursor, que poda por zone maps
+            auto cursor = it->second->openRangeCursor(queryBox, 0,
+                                                      std::numeric_limits<size_t>::max(), range);
+            size_t count = 0;
+            for (auto batch = cursor->next(CURSOR_BATCH_ROWS); !batch.empty();
+                 batch = cursor->next(CURSOR_BATCH_ROWS)) {
+                count += batch.size();
+            }
+            return "COUNT(*): " + std::to_string(count);
+        }
+        
+        size_t offset = 0, limit = 0;
+        std::string error;
+        if (!bindWindow(plan, values, offset, limit, error)) return error;
+        
+        if (plan.kind == QueryPlan::Kind::GRID) {
+            double cellSize = plan.cellSize.bind(values);
+            if (!(cellSize > 0.0)) return "Error: grid cell size must be positive";
+            return formatGrid(plan, it->second->gridAggregate(queryBox, cellSize, range),
+                              offset, limit);
+        }
+        
+        // Con LIMIT/OFFSET un cursor deja de recorrer componentes al llegar al
+        // límite; con predicados sobre el payload además poda por zone maps
+        std::vector<SpatialRecord<T>> results;
+        if (plan.limited || offset > 0 || !range.unbounded()) {
+            auto cursor = it->second->openRangeCursor(queryBox, offset, limit, range);
+            for (auto batch = cursor->next(CURSOR_BATCH_ROWS); !batch.empty();
+                 batch = cursor->next(CURSOR_BATCH_ROWS)) {
+                std::move(batch.begin(), batch.end(), std::back_inserter(results));
+            }
         } else {
-            // Retornar resultados formateados
-            std::stringstream ss;
-            ss << "Results (" << results.size() << " rows):\n";
-            for (const auto& rec : results) {
-                ss << "Point: (";
-                for (size_t i = 0; i < rec.point.dimensions(); ++i) {
-                    if (i > 0) ss << ", ";
-                    ss << rec.point[i];
+            results = it->second->spatialRangeQuery(queryBox);
+        }
+        
+        std::stringstream ss;
+        ss << "Results (" << results.size() << " rows):\n";
+        for (const auto& rec : results) formatRow(ss, rec);
+        return ss.str();
+    }
+    
+    /**
+     * @brief Una línea por celda no vacía, en orden (columna, fila), y el
+     *        resumen de cuánto se resolvió con agregados de nodo
+     */
+    static std::string formatGrid(const QueryPlan& plan, const GridAggregate& grid,
+                                  size_t offset, size_t limit) {
+        std::stringstream ss;
+        ss << "Grid " << grid.cellSize << " (" << grid.cells.size() << " cells):\n";
+        size_t index = 0, shown = 0;
+        for (const auto& [cell, value] : grid.cells) {
+            if (index++ < offset) continue;
+            if (shown++ == limit) break;
+            ss << "Cell [" << cell.first * grid.cellSize << ", " << cell.second * grid.cellSize
+               << "]-[" << (cell.first + 1) * grid.cellSize << ", "
+               << (cell.second + 1) * grid.cellSize << "):";
+            for (const auto& aggregate : plan.aggregates) {
+                ss << " " << aggregate.label << "=";
+                switch (aggregate.function) {
+                    case PlanAggregate::Function::COUNT: ss << value.count; break;
+                    case PlanAggregate::Function::SUM: ss << value.sum; break;
+                    case PlanAggregate::Function::AVG: ss << value.sum / static_cast<double>(value.count); break;
                 }
-                ss << ")\n";
             }
-            return ss.str();
+            ss << "\n";
         }
+        ss << "Pushdown: " << grid.nodesCredited << " nodes credited (" << grid.recordsCredited
+           << " records), " << grid.recordsVisited << " records visited";
+        return ss.str();
     }
     
     /**
-     * @brief Ejecuta INSERT INTO table VALUES (...)
+     * @brief ¿INSERT con más de una tupla? Solo mira hasta el final de la primera
      */
-    std::string executeInsert(const std::shared_ptr<ASTNode>& ast) {
-        // Extraer nombre de tabla
-        std::string tableName = ast->children[0]->value;
+    static bool isMultiRowInsert(const std::string& sql) {
+        size_t pos = sql.find('(');
+        if (pos == std::string::npos) return false;
+        bool quoted = false;
+        for (; pos < sql.size(); ++pos) {
+            if (sql[pos] == '\'') {
+                quoted = !quoted;
+            } else if (!quoted && sql[pos] == ')') {
+                break;
+            }
+        }
+        pos = sql.find_first_not_of(" \t\r\n", pos + 1);
+        return pos != std::string::npos && sql[pos] == ',';
+    }
+    
+    /**
+     * @brief INSERT INTO t VALUES (...), (...), ...: sin lexer, AST ni plan
+     * Las tuplas se leen en una pasada con scanNumber y se escriben en lotes
+     * de INSERT_BATCH_ROWS con insertBatch(). Como en el INSERT de una fila,
+     * cuentan los primeros números (x, y[, t], dato) y las cadenas se ignoran.
+     * Una fila inválida detiene la sentencia: las anteriores quedan escritas
+     * y el error indica su número (1-based) y cuántas se insertaron.
+     */
+    std::string executeInsertRows(const std::string& sql) {
+        const char* p = sql.data();
+        const char* end = p + sql.size();
+        auto skipSpaces = [&]() {
+            while (p < end && std::isspace(static_cast<unsigned char>(*p))) ++p;
+        };
+        auto isWordChar = [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+        };
+        auto word = [&]() {
+            skipSpaces();
+            const char* begin = p;
+            while (p < end && isWordChar(*p)) ++p;
+            return std::string(begin, p);
+        };
+        auto keyword = [&](const char* expected) {
+            std::string w = word();
+            std::transform(w.begin(), w.end(), w.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+            return w == expected;
+        };
         
+        if (!keyword("INSERT") || !keyword("INTO")) return "Error: Expected INSERT INTO";
+        std::string tableName = word();
+        if (!keyword("VALUES")) return "Error: Expected VALUES after table name";
         if (!catalog.tableExists(tableName)) {
             return "Error: Table '" + tableName + "' does not exist";
         }
+        auto it = lsmTrees.find(tableName);
+        auto tree = it != lsmTrees.end() ? it->second : createTree(tableName);
+        const size_t dims = catalog.getTable(tableName).dimensions();   // x, y[, t]; luego el dato
         
-        // Obtener o crear LSM-tree
-        if (lsmTrees.find(tableName) == lsmTrees.end()) {
-            lsmTrees[tableName] = std::make_shared<LSMTree<T>>(2);
+        std::vector<SpatialRecord<T>> batch;
+        batch.reserve(INSERT_BATCH_ROWS);
+        size_t inserted = 0;
+        auto writeBatch = [&]() {
+            inserted += tree->insertBatch(batch);
+            batch.clear();
+        };
+        
+        size_t row = 0;
+        std::string error;
+        while (error.empty()) {
+            ++row;
+            skipSpaces();
+            if (p == end || *p != '(') {
+                error = "expected '('";
+                break;
+            }
+            ++p;
+            
+            double values[4] = {0.0, 0.0, 0.0, 0.0};
+            size_t count = 0;
+            skipSpaces();
+            while (p < end && *p != ')') {
+                if (*p == '\'') {
+                    bool closed = false;
+                    for (++p; p < end && !closed;) {
+                        if (*p++ != '\'') continue;
+                        if (p < end && *p == '\'') {
+                            ++p;    // '' escapado
+                        } else {
+                            closed = true;
+                        }
+                    }
+                    if (!closed) {
+                        error = "unterminated string";
+                        break;
+                    }
+                } else {
+                    double value;
+                    const char* next = scanNumber(p, end, value);
+                    if (next == p) {
+                        error = "expected a number";
+                        break;
+                    }
+                    if (count < dims + 1) values[count++] = value;
+                    p = next;
+                }
+                skipSpaces();
+                if (p < end && *p == ',') {
+                    ++p;
+                    skipSpaces();
+                } else if (p < end && *p != ')') {
+                    error = "expected ',' or ')'";
+                    break;
+                }
+            }
+            if (!error.empty()) break;
+            if (p == end) {
+                error = "expected ')'";
+                break;
+            }
+            ++p;
+            if (count < dims) {
+                error = dims > 2 ? "expected at least x, y, t" : "expected at least x, y";
+                break;
+            }
+            
+            batch.emplace_back(Point(std::vector<double>(values, values + dims)),
+                               count > dims ? static_cast<T>(values[dims]) : T(), false);
+            if (batch.size() >= INSERT_BATCH_ROWS) writeBatch();
+            
+            skipSpaces();
+            if (p < end && *p == ',') {
+                ++p;
+                continue;
+            }
+            if (p < end && *p == ';') ++p;
+            skipSpaces();
+            if (p != end) error = "unexpected text after the row";
+            break;
         }
+        writeBatch();
         
-        auto& lsmTree = lsmTrees[tableName];
+        if (!error.empty()) {
+            return "Error: row " + std::to_string(row) + ": " + error + " (" +
+                   std::to_string(inserted) + " rows inserted before the error)";
+        }
+        return "INSERT " + std::to_string(inserted) + " rows";
+    }
+    
+    /**
+     * @brief PREPARE name AS statement
+     */
+    std::string executePrepare(const std::string& sql) {
+        std::stringstream ss(sql);
+        std::string keyword, name, as;
+        ss >> keyword >> name >> as;
+        std::transform(as.begin(), as.end(), as.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        if (name.empty() || as != "AS") {
+            return "Error: Usage: PREPARE name AS statement";
+        }
+        std::string statement;
+        std::getline(ss, statement, '\0');
+        return prepare(name, statement);
+    }
+    
+    /**
+     * @brief EXECUTE name [(v1, v2, ...)]: sin lexer ni parser
+     */
+    std::string executeExecute(const std::string& sql) {
+        const char* p = sql.data();
+        const char* end = p + sql.size();
+        auto skipSpaces = [&]() {
+            while (p < end && std::isspace(static_cast<unsigned char>(*p))) ++p;
+        };
         
-        // Extraer valores
-        auto valuesNode = ast->children[1];
-        std::vector<double> coords;
-        T data = T();
+        skipSpaces();
+        p += 7;  // EXECUTE
+        skipSpaces();
+        const char* nameBegin = p;
+        while (p < end && (std::isalnum(static_cast<unsigned char>(*p)) || *p == '_')) ++p;
+        std::string name(nameBegin, p);
+        if (name.empty()) return "Error: Usage: EXECUTE name (v1, v2, ...)";
         
-        for (const auto& value : valuesNode->children) {
-            if (value->type == ASTNodeType::NUMBER) {
-                coords.push_back(std::stod(value->value));
+        std::vector<double> args;
+        skipSpaces();
+        if (p < end && *p == '(') {
+            ++p;
+            skipSpaces();
+            while (p < end && *p != ')') {
+                double value;
+                const char* next = scanNumber(p, end, value);
+                if (next == p) return "Error: EXECUTE parameters must be numbers";
+                args.push_back(value);
+                p = next;
+                skipSpaces();
+                if (p < end && *p == ',') {
+                    ++p;
+                    skipSpaces();
+                }
             }
+            if (p == end) return "Error: Expected ')' after EXECUTE parameters";
+            ++p;
         }
+        skipSpaces();
+        if (p < end && *p == ';') ++p;
+        skipSpaces();
+        if (p != end) return "Error: Unexpected text after EXECUTE";
         
-        // Asumir que las primeras 2 coordenadas son el punto espacial
-        if (coords.size() >= 2) {
-            Point point({coords[0], coords[1]});
-            
-            // El resto son datos (simplificado)
-            if (coords.size() > 2) {
-                data = static_cast<T>(coords[2]);
+        return executePrepared(name, args);
+    }
+    
+    std::string executeDeallocate(const std::string& sql) {
+        std::stringstream ss(sql);
+        std::string keyword, name;
+        ss >> keyword >> name;
+        if (!name.empty() && name.back() == ';') name.pop_back();
+        if (!deallocate(name)) {
+            return "Error: Prepared statement '" + name + "' does not exist";
+        }
+        return "DEALLOCATE " + name;
+    }
+    
+    /**
+     * @brief EXPLAIN [ANALYZE] SELECT ...
+     * Plan: componentes que sobreviven al filtrado MBR. ANALYZE además
+     * ejecuta la consulta y detalla por componente nodos visitados por
+     * nivel, entradas de hoja evaluadas, coincidencias, tiempo y lectura
+     * de disco, más el coste de la reconciliación.
+     */
+    std::string executeExplain(const std::shared_ptr<ASTNode>& ast) {
+        std::shared_ptr<LSMTree<T>> lsmTree;
+        MBR queryBox;
+        std::string error = resolveSelect(ast->children[0], lsmTree, queryBox);
+        if (!error.empty()) {
+            return error;
+        }
+        
+        bool analyze = ast->value == "ANALYZE";
+        auto trace = lsmTree->explainRangeQuery(queryBox, analyze);
+        
+        auto formatBox = [](const MBR& box) {
+            std::stringstream ss;
+            ss << "[";
+            for (size_t d = 0; d < box.dimensions(); ++d) {
+                if (d > 0) ss << ", ";
+                ss << box.getLower()[d] << ".." << box.getUpper()[d];
             }
-            
-            lsmTree->insert(point, data);
-            return "INSERT successful";
+            ss << "]";
+            return ss.str();
+        };
+        
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(3);
+        ss << (analyze ? "EXPLAIN ANALYZE" : "EXPLAIN") << " spatial range " << formatBox(queryBox) << "\n";
+        ss << "  MemTable: " << trace.memTableRecords << " records";
+        if (analyze) {
+            ss << ", " << trace.memTableMatches << " matches, " << trace.memTableMillis << " ms";
         }
+        ss << "\n";
         
-        return "Error: Invalid INSERT values";
+        size_t scanned = 0;
+        for (const auto& c : trace.components) {
+            if (!c.pruned) ++scanned;
+        }
+        ss << "  Components: " << trace.components.size() << " total, " << scanned
+           << " pass MBR filter, " << trace.components.size() - scanned << " pruned\n";
+        
+        for (const auto& c : trace.components) {
+            ss << "    L" << c.level << " " << c.filename << " " << formatBox(c.mbr)
+               << " " << c.records << " records: " << (c.pruned ? "PRUNED" : "SCAN");
+            if (analyze && !c.pruned) {
+                ss << "\n      nodes visited per level: ";
+                for (size_t l = 0; l < c.search.rtree.nodesVisitedPerLevel.size(); ++l) {
+                    if (l > 0) ss << "/";
+                    ss << c.search.rtree.nodesVisitedPerLevel[l];
+                }
+                ss << ", leaf entries tested: " << c.search.rtree.leafEntriesTested
+                   << ", matches: " << c.matches << ", " << c.millis << " ms"
+                   << "\n      component read: "
+                   << (c.search.loadedFromDisk ? "miss (" + std::to_string(c.search.bytesRead) +
+                                                     " bytes from disk)"
+                                               : std::string("hit (resident)"));
+            }
+            ss << "\n";
+        }
+        
+        if (analyze) {
+            ss << "  Reconciliation: " << trace.candidateRows << " candidate rows -> "
+               << trace.resultRows << " rows, " << trace.reconcileMillis << " ms\n";
+            ss << "  Total: " << trace.totalMillis << " ms (sequential, result cache bypassed)\n";
+        }
+        return ss.str();
+    }
+    
+    /**
+     * @brief Ejecuta LOAD 'file' INTO table / COPY table FROM 'file'
+     * Carga paralela con PointLoader y escrituras por lotes. COLUMNS usa
+     * posiciones 1-based: x, y (y t si la tabla tiene TIMESTAMP) y
+     * opcionalmente el payload. Con MAX_ERRORS n
+     * se saltan hasta n líneas inválidas, que se listan con su número.
+     */
+    std::string executeLoad(const std::shared_ptr<ASTNode>& ast) {
+        std::string tableName = ast->children[0]->value;
+        if (!catalog.tableExists(tableName)) {
+            return "Error: Table '" + tableName + "' does not exist";
+        }
+        if (lsmTrees.find(tableName) == lsmTrees.end()) {
+            createTree(tableName);
+        }
+        
+        PointLoaderOptions options;
+        options.format = parsePointFormat(ast->children[1]->value);
+        options.dimensions = catalog.getTable(tableName).dimensions();
+        for (size_t i = 2; i < ast->children.size(); ++i) {
+            const auto& option = ast->children[i];
+            if (option->value == "HEADER") {
+                options.header = true;
+            } else if (option->value == "BULK") {
+                options.bulk = true;
+            } else if (option->value == "DELIMITER") {
+                options.delimiter = option->children[0]->value[0];
+            } else if (option->value == "THREADS") {
+                options.threads = std::max(1, std::stoi(option->children[0]->value));
+            } else if (option->value == "MAX_ERRORS") {
+                options.maxErrors = static_cast<size_t>(std::max(0, std::stoi(option->children[0]->value)));
+            } else if (option->value == "COLUMNS") {
+                const auto& columns = option->children;
+                if (columns.size() < options.dimensions || columns.size() > options.dimensions + 1) {
+                    return options.dimensions > 2 ? "Error: COLUMNS expects (x, y, t) or (x, y, t, data)"
+                                                  : "Error: COLUMNS expects (x, y) or (x, y, data)";
+                }
+                for (size_t c = 0; c < columns.size(); ++c) {
+                    int position = std::stoi(columns[c]->value);
+                    if (position < 1) return "Error: COLUMNS positions start at 1";
+                    if (c < options.dimensions) {
+                        options.coordinateColumns.push_back(static_cast<size_t>(position - 1));
+                    } else {
+                        options.dataColumn = position - 1;
+                    }
+                }
+            }
+        }
+        
+        auto result = PointLoader<T>(options).load(ast->value, *lsmTrees[tableName]);
+        
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2)
+            << (ast->type == ASTNodeType::COPY_STMT ? "COPY " : "LOAD ") << result.records << " records into '" << tableName << "' in "
+            << result.seconds << " s (" << std::setprecision(0) << result.recordsPerSecond()
+            << " records/s, " << result.chunks << " chunks";
+        if (options.bulk) out << ", " << result.components << " components ingested";
+        out << ")";
+        if (result.rejected > 0) {
+            out << "\n" << result.rejected << " line(s) rejected";
+            for (const auto& [line, error] : result.errors) {
+                out << "\n  line " << line << ": " << error;
+            }
+            if (result.rejected > result.errors.size()) out << "\n  ...";
+        }
+        return out.str();
     }
     
     /**
@@ -254,22 +1171,41 @@ private:
                 if (colType == "POINT" || colType == "GEOMETRY" || colType == "point" || colType == "geometry") {
                     schema.spatialColumn = colName;
                 }
+                // La columna de tiempo es la tercera coordenada del índice
+                if (TableSchema::isTimeType(colType)) {
+                    if (schema.isTemporal()) {
+                        return "Error: Only one TIMESTAMP column is supported";
+                    }
+                    schema.timeColumn = colName;
+                }
             }
         }
         
         catalog.createTable(schema);
         
         // Crear LSM-tree para la tabla
-        lsmTrees[schema.name] = std::make_shared<LSMTree<T>>(2);
+        createTree(schema.name);
+        
+        // Los planes compilados fijan dimensiones y columnas: una tabla
+        // recreada con otro esquema no puede reutilizarlos
+        planCache.clear();
+        for (auto it = preparedStatements.begin(); it != preparedStatements.end();) {
+            if (it->second.plan->table == schema.name) {
+                it = preparedStatements.erase(it);
+            } else {
+                ++it;
+            }
+        }
         
         return "Table '" + schema.name + "' created successfully";
     }
     
     /**
      * @brief Extrae MBR de nodo spatial_intersect
+     * @param dims 3 en tablas con TIMESTAMP: sin t1, t2 cubre todo el tiempo
      */
-    MBR extractQueryBox(const std::shared_ptr<ASTNode>& node) {
-        // spatial_intersect tiene: column, x1, y1, x2, y2
+    MBR extractQueryBox(const std::shared_ptr<ASTNode>& node, size_t dims) {
+        // spatial_intersect tiene: column, x1, y1, x2, y2[, t1, t2]
         std::vector<double> coords;
         
         for (size_t i = 1; i < node->children.size(); ++i) {
@@ -279,12 +1215,17 @@ private:
         }
         
         if (coords.size() >= 4) {
-            Point lower({coords[0], coords[1]});
-            Point upper({coords[2], coords[3]});
-            return MBR(lower, upper);
+            std::vector<double> lower{coords[0], coords[1]};
+            std::vector<double> upper{coords[2], coords[3]};
+            if (dims > 2) {
+                bool timed = coords.size() >= 6;
+                lower.push_back(timed ? coords[4] : std::numeric_limits<double>::lowest());
+                upper.push_back(timed ? coords[5] : std::numeric_limits<double>::max());
+            }
+            return MBR(Point(lower), Point(upper));
         }
         
-        return MBR(2);
+        return MBR(dims);
     }
 };
 
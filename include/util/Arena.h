@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <new>
+
+namespace util {
+
+/**
+ * @brief Arena bump-pointer
+ * Reserva bloques grandes y reparte memoria avanzando un puntero.
+ * No libera objetos individuales: todo se libera de una vez con reset()
+ * o al destruir el arena. No es thread-safe (el propietario sincroniza).
+ */
+class Arena {
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t blockSize;
+    std::byte* cursor;
+    size_t remaining;
+    size_t allocatedBytes;   // Bytes entregados a los usuarios
+    size_t reservedBytes;    // Bytes reservados en bloques
+
+    std::byte* newBlock(size_t size) {
+        blocks.push_back(Block{std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+        reservedBytes += size;
+        return blocks.back().data.get();
+    }
+
+public:
+    explicit Arena(size_t blockBytes = 64 * 1024)
+        : blockSize(blockBytes), cursor(nullptr), remaining(0),
+          allocatedBytes(0), reservedBytes(0) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Reserva 'bytes' alineados a 'alignment'
+     */
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        if (bytes == 0) bytes = 1;
+
+        size_t padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+        if (cursor && padding + bytes <= remaining) {
+            std::byte* result = cursor + padding;
+            cursor += padding + bytes;
+            remaining -= padding + bytes;
+            allocatedBytes += bytes;
+            return result;
+        }
+
+        // Peticiones grandes: bloque dedicado para no desperdiciar el actual
+        if (bytes + alignment > blockSize / 4) {
+            std::byte* block = newBlock(bytes + alignment);
+            size_t pad = (alignment - reinterpret_cast<uintptr_t>(block) % alignment) % alignment;
+            allocatedBytes += bytes;
+            return block + pad;
+        }
+
+        cursor = newBlock(blockSize);
+        remaining = blockSize;
+        return allocate(bytes, alignment);
+    }
+
+    /**
+     * @brief Libera toda la memoria del arena de una vez
+     */
+    void reset() {
+        blocks.clear();
+        blocks.shrink_to_fit();
+        cursor = nullptr;
+        remaining = 0;
+        allocatedBytes = 0;
+        reservedBytes = 0;
+    }
+
+    size_t memoryUsage() const { return reservedBytes; }
+    size_t allocated() const { return allocatedBytes; }
+};
+
+/**
+ * @brief Allocator STL sobre un Arena (deallocate es no-op)
+ */
+template<typename U>
+class ArenaAllocator {
+private:
+    Arena* arena;
+
+    template<typename V> friend class ArenaAllocator;
+
+public:
+    using value_type = U;
+
+    explicit ArenaAllocator(Arena* a) noexcept : arena(a) {}
+
+    template<typename V>
+    ArenaAllocator(const ArenaAllocator<V>& other) noexcept : arena(other.arena) {}
+
+    U* allocate(size_t n) {
+        return static_cast<U*>(arena->allocate(n * sizeof(U), alignof(U)));
+    }
+
+    void deallocate(U*, size_t) noexcept {}
+
+    template<typename V>
+    bool operator==(const ArenaAllocator<V>& other) const noexcept { return arena == other.arena; }
+
+    template<typename V>
+    bool operator!=(const ArenaAllocator<V>& other) const noexcept { return arena != other.arena; }
+};
+
+} // namespace util
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace util {
+
+/**
+ * @brief Shard del hilo actual (asignación round-robin, fija por hilo)
+ */
+template<size_t Shards>
+inline size_t currentShard() {
+    static std::atomic<size_t> nextShard{0};
+    thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % Shards;
+    return shard;
+}
+
+/**
+ * @brief Contador repartido en shards por hilo
+ * add() es un fetch_add relajado sobre la línea de caché del hilo; la
+ * lectura suma todos los shards sin bloquear.
+ */
+class ShardedCounter {
+public:
+    static constexpr size_t SHARDS = 16;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Slot, SHARDS> slots;
+
+public:
+    void add(uint64_t n = 1) {
+        slots[currentShard<SHARDS>()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t load() const {
+        uint64_t total = 0;
+        for (const auto& s : slots) total += s.value.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    void reset() {
+        for (auto& s : slots) s.value.store(0, std::memory_order_relaxed);
+    }
+
+    ShardedCounter& operator++() { add(1); return *this; }
+    void operator++(int) { add(1); }
+    ShardedCounter& operator+=(uint64_t n) { add(n); return *this; }
+    operator uint64_t() const { return load(); }
+};
+
+/**
+ * @brief Histograma de latencias estilo HDR (log-lineal), en nanosegundos
+ * Cada potencia de dos se divide en 32 sub-buckets lineales: error relativo
+ * < 3.2% en cualquier percentil. Rango hasta 2^44 ns (~4.9 h); los valores
+ * mayores se acumulan en el último bucket (max sigue siendo exacto).
+ *
+ * record() cuesta un clz y dos o tres operaciones atómicas relajadas sobre
+ * el shard del hilo; snapshot() agrega los shards sin bloquear.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 6;                      // 64 valores exactos
+    static constexpr uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+    static constexpr uint64_t HALF = SUB_BUCKETS / 2;
+    static constexpr unsigned MAX_BITS = 44;
+    static constexpr size_t BUCKETS = SUB_BUCKETS + (MAX_BITS - SUB_BUCKET_BITS + 1) * HALF;
+    static constexpr size_t SHARDS = 16;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        std::vector<uint64_t> counts;
+
+        double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+
+        /**
+         * @brief Valor del percentil q (0-100), en ns
+         */
+        uint64_t percentile(double q) const {
+            if (count == 0) return 0;
+            uint64_t rank = static_cast<uint64_t>(q / 100.0 * static_cast<double>(count) + 0.5);
+            rank = std::min(std::max<uint64_t>(rank, 1), count);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < counts.size(); ++i) {
+                seen += counts[i];
+                if (seen >= rank) return std::min(highestEquivalent(i), max);
+            }
+            return max;
+        }
+
+        /**
+         * @brief Registros entre una instantánea anterior y esta (ventanas)
+         * El máximo de la ventana se aproxima por su bucket más alto.
+         */
+        Snapshot since(const Snapshot& earlier) const {
+            Snapshot delta;
+            delta.counts = counts;
+            for (size_t i = 0; i < earlier.counts.size() && i < delta.counts.size(); ++i) {
+                delta.counts[i] -= std::min(delta.counts[i], earlier.counts[i]);
+            }
+            delta.count = count >= earlier.count ? count - earlier.count : 0;
+            delta.sum = sum >= earlier.sum ? sum - earlier.sum : 0;
+            for (size_t i = delta.counts.size(); i-- > 0;) {
+                if (delta.counts[i]) {
+                    delta.max = std::min(highestEquivalent(i), max);
+                    break;
+                }
+            }
+            return delta;
+        }
+    };
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, BUCKETS> counts{};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+    };
+    std::vector<Shard> shards;
+
+    static unsigned highestBit(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63u - static_cast<unsigned>(__builtin_clzll(v));
+#else
+        unsigned bit = 0;
+        while (v >>= 1) ++bit;
+        return bit;
+#endif
+    }
+
+public:
+    static size_t bucketOf(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+        unsigned msb = highestBit(value);
+        if (msb >= MAX_BITS) return BUCKETS - 1;
+        unsigned shift = msb - (SUB_BUCKET_BITS - 1);          // value >> shift ∈ [HALF, SUB_BUCKETS)
+        return SUB_BUCKETS + (shift - 1) * HALF + ((value >> shift) - HALF);
+    }
+
+    /**
+     * @brief Mayor valor que cae en el bucket (cota superior del error)
+     */
+    static uint64_t highestEquivalent(size_t bucket) {
+        if (bucket < SUB_BUCKETS) return bucket;
+        uint64_t shift = (bucket - SUB_BUCKETS) / HALF + 1;
+        uint64_t sub = (bucket - SUB_BUCKETS) % HALF + HALF;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    LatencyHistogram() : shards(SHARDS) {}
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t nanos) {
+        Shard& s = shards[currentShard<SHARDS>()];
+        s.counts[bucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+        s.sum.fetch_add(nanos, std::memory_order_relaxed);
+        uint64_t prev = s.max.load(std::memory_order_relaxed);
+        while (nanos > prev &&
+               !s.max.compare_exchange_weak(prev, nanos, std::memory_order_relaxed)) {
+        }
+    }
+
+    void record(std::chrono::steady_clock::duration elapsed) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        record(static_cast<uint64_t>(std::max<int64_t>(0, ns)));
+    }
+
+    Snapshot snapshot() const {
+        Snapshot snap;
+        snap.counts.assign(BUCKETS, 0);
+        for (const auto& s : shards) {
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                uint64_t c = s.counts[i].load(std::memory_order_relaxed);
+                snap.counts[i] += c;
+                snap.count += c;
+            }
+            snap.sum += s.sum.load(std::memory_order_relaxed);
+            snap.max = std::max(snap.max, s.max.load(std::memory_order_relaxed));
+        }
+        return snap;
+    }
+
+    void reset() {
+        for (auto& s : shards) {
+            for (auto& c : s.counts) c.store(0, std::memory_order_relaxed);
+            s.sum.store(0, std::memory_order_relaxed);
+            s.max.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+/**
+ * @brief Registra en un histograma la duración del ámbito
+ */
+class ScopedLatency {
+private:
+    LatencyHistogram& histogram;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedLatency(LatencyHistogram& h)
+        : histogram(h), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedLatency() { histogram.record(std::chrono::steady_clock::now() - start); }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+};
+
+} // namespace util
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+/**
+ * @brief Impide que el compilador elimine el cálculo de value
+ */
+template<typename V>
+inline void doNotOptimize(const V& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * @brief Mediana de una muestra (la copia se ordena parcialmente)
+ */
+inline double median(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    double m = values[mid];
+    if (values.size() % 2 == 0) {
+        m = (m + *std::max_element(values.begin(), values.begin() + mid)) / 2.0;
+    }
+    return m;
+}
+
+/**
+ * @brief Desviación absoluta mediana (robusta frente a repeticiones atípicas)
+ */
+inline double medianAbsoluteDeviation(const std::vector<double>& values) {
+    double m = median(values);
+    std::vector<double> deviations;
+    deviations.reserve(values.size());
+    for (double v : values) deviations.push_back(std::fabs(v - m));
+    return median(std::move(deviations));
+}
+
+struct MicroBenchOptions {
+    size_t warmup = 2;          // Repeticiones descartadas
+    size_t repetitions = 15;    // Repeticiones medidas
+};
+
+/**
+ * @brief Resultado de un kernel: tiempos por repetición en ns
+ */
+struct MicroBenchResult {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> params;
+    size_t items = 0;           // Operaciones por repetición
+    std::vector<double> samples;
+    double medianNs = 0.0;
+    double madNs = 0.0;
+    double minNs = 0.0;
+
+    double nsPerItem() const { return items ? medianNs / static_cast<double>(items) : 0.0; }
+    double madPercent() const { return medianNs > 0.0 ? 100.0 * madNs / medianNs : 0.0; }
+};
+
+/**
+ * @brief Arnés mínimo de microbenchmarks
+ * Cada repetición ejecuta setup() sin medir y body() midiendo con
+ * steady_clock; se descartan las primeras de calentamiento y se resume
+ * con mediana, MAD y mínimo. body() debe procesar `items` operaciones.
+ */
+class MicroBench {
+private:
+    MicroBenchOptions options;
+    std::vector<MicroBenchResult> results;
+
+public:
+    explicit MicroBench(const MicroBenchOptions& opts = MicroBenchOptions()) : options(opts) {
+        options.repetitions = std::max<size_t>(1, options.repetitions);
+    }
+
+    const MicroBenchResult& run(const std::string& name,
+                                std::vector<std::pair<std::string, std::string>> params,
+                                size_t items,
+                                const std::function<void()>& setup,
+                                const std::function<void()>& body) {
+        using Clock = std::chrono::steady_clock;
+
+        MicroBenchResult result;
+        result.name = name;
+        result.params = std::move(params);
+        result.items = items;
+
+        for (size_t rep = 0; rep < options.warmup + options.repetitions; ++rep) {
+            if (setup) setup();
+            auto start = Clock::now();
+            body();
+            auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            if (rep >= options.warmup) result.samples.push_back(elapsed);
+        }
+
+        result.medianNs = median(result.samples);
+        result.madNs = medianAbsoluteDeviation(result.samples);
+        result.minNs = *std::min_element(result.samples.begin(), result.samples.end());
+        results.push_back(std::move(result));
+        return results.back();
+    }
+
+    const std::vector<MicroBenchResult>& getResults() const { return results; }
+    const MicroBenchOptions& getOptions() const { return options; }
+};
+
+/**
+ * @brief Línea legible de un resultado
+ */
+inline void printMicroBenchResult(std::ostream& out, const MicroBenchResult& r) {
+    std::string label = r.name;
+    for (const auto& [key, value] : r.params) label += " " + key + "=" + value;
+
+    std::ios::fmtflags flags(out.flags());
+    std::streamsize precision = out.precision();
+    out << std::left << std::setw(66) << label << std::right << std::fixed << std::setprecision(2)
+        << std::setw(12) << r.nsPerItem() << " ns/item  ±" << std::setw(6) << r.madPercent()
+        << "%  (" << std::setprecision(3) << r.medianNs / 1e6 << " ms/rep)\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+/**
+ * @brief Escapa comillas, barras y controles para una cadena JSON
+ */
+inline std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Resultados en JSON estable (mismo orden y claves) para diffs entre commits
+ */
+inline void writeMicroBenchJSON(std::ostream& out, const std::vector<MicroBenchResult>& results,
+                                const MicroBenchOptions& options) {
+    std::ios::fmtflags flags(out.flags());
+    std::streamsize precision = out.precision();
+    out << std::setprecision(6);
+
+    out << "{\n  \"warmup\": " << options.warmup << ",\n  \"repetitions\": "
+        << options.repetitions << ",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << jsonEscape(r.name) << "\"";
+        for (const auto& [key, value] : r.params) {
+            out << ", \"" << jsonEscape(key) << "\": \"" << jsonEscape(value) << "\"";
+        }
+        out << ", \"items\": " << r.items
+            << ", \"median_ns\": " << r.medianNs
+            << ", \"mad_ns\": " << r.madNs
+            << ", \"min_ns\": " << r.minNs
+            << ", \"ns_per_item\": " << r.nsPerItem() << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace util
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+namespace util {
+
+/**
+ * @brief Pool de hilos fijo con cola FIFO de tareas
+ * Compartido entre consultas; cada consulta limita cuántas tareas encola.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping;
+
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+        : stopping(false) {
+        workers.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        available.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push(std::move(task));
+        }
+        available.notify_one();
+    }
+
+    size_t size() const { return workers.size(); }
+};
+
+} // namespace util
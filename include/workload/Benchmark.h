@@ -0,0 +1,539 @@
+#pragma once
+
+#include "Workload.h"
+#include "MixedWorkload.h"
+#include "MovingObjects.h"
+#include "../util/Histogram.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace workload {
+
+/**
+ * @brief Parámetros de lsm_bench (comunes a todas las configuraciones)
+ */
+struct BenchOptions {
+    std::vector<std::string> benchmarks{"fillrandom", "readrandom", "rangequery",
+                                        "count", "knn", "mixed"};
+    size_t num = 1000000;                  // Registros de fillseq/fillrandom
+    size_t reads = 100000;                 // Operaciones de readrandom/mixed
+    size_t queries = 1000;                 // Consultas de rangequery/count/knn
+    std::vector<double> selectivities{1e-3, 1e-5};
+    size_t k = 10;                         // Vecinos de knn
+    double writeRatio = 0.5;               // Fracción de escrituras en mixed
+    std::string dataset = "random";        // random, clustered
+    size_t clusters = 20;
+    unsigned seed = 42;
+    MixedWorkloadOptions ycsb;             // Clientes, mezcla y duración de ycsb
+    MovingObjectsOptions moving;           // Flota, velocidades y muestreo de moving
+    std::string timeseriesPath;            // CSV de la serie de moving (se añade por config)
+};
+
+/**
+ * @brief Resultado de un benchmark con nombre sobre una configuración
+ */
+struct BenchResult {
+    std::string config;
+    std::string name;
+    uint64_t ops = 0;
+    double seconds = 0.0;
+    util::LatencyHistogram::Snapshot latency;   // ns por operación
+    uint64_t rows = 0;                          // Filas devueltas (lecturas)
+    double writeAmplification = 0.0;            // Registros escritos a disco / escrituras
+    double readAmplification = 0.0;             // Componentes leídos por consulta (este benchmark)
+    double spaceAmplification = 0.0;            // Bytes del árbol / bytes lógicos vivos
+    uint64_t treeBytes = 0;
+    size_t components = 0;
+    uint64_t peakRSSBytes = 0;
+
+    double opsPerSecond() const { return seconds > 0.0 ? static_cast<double>(ops) / seconds : 0.0; }
+    double microsPerOp() const { return ops ? seconds * 1e6 / static_cast<double>(ops) : 0.0; }
+};
+
+/**
+ * @brief Benchmarks con nombre estilo db_bench sobre un LSM-tree configurado
+ * Los benchmarks se ejecutan en orden sobre el mismo árbol, como en
+ * db_bench: readrandom, rangequery, count, knn y mixed leen lo que haya
+ * cargado un fill anterior.
+ *
+ *   fillseq        inserta num puntos en orden (x, y)
+ *   fillrandom     inserta num puntos en orden aleatorio
+ *   readrandom     consultas de punto sobre claves existentes
+ *   rangequery     consultas por rango, una pasada por selectividad
+ *   count          COUNT(*) por rango con la primera selectividad
+ *   knn            k vecinos más cercanos (ventana creciente)
+ *   mixed          writeRatio inserciones nuevas, resto lecturas de punto
+ *   ycsb           carga num claves y ejecuta clientes concurrentes con la
+ *                  mezcla de options.ycsb; un resultado por operación
+ *   moving         flota de options.moving con borrado + reinserción por
+ *                  reporte; imprime la serie temporal y devuelve
+ *                  resultados de actualizaciones y consultas
+ *
+ * Cada benchmark comprueba que midió trabajo real (registros cargados,
+ * claves encontradas, filas devueltas) y si no lanza runtime_error: un
+ * árbol que no devuelve nada da cifras espectaculares y falsas.
+ */
+template<typename T>
+class DbBench {
+public:
+    using Config = typename BenchmarkRunner<T>::BenchmarkConfig;
+
+private:
+    Config config;
+    BenchOptions options;
+    std::unique_ptr<lsm::LSMTree<T>> tree;
+    DatasetGenerator generator;
+    std::mt19937_64 rng;
+    std::vector<Point> keys;               // Claves vivas (para lecturas)
+    uint64_t liveRecords = 0;              // Registros lógicos vivos (aprox.)
+
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t DIMENSIONS = 2;
+
+    static uint64_t logicalRecordBytes() {
+        return DIMENSIONS * sizeof(double) + sizeof(T);
+    }
+
+    std::vector<SpatialRecord<T>> generate(size_t count) {
+        if (options.dataset == "clustered") {
+            return generator.template generateClusteredDataset<T>(count, options.clusters);
+        }
+        return generator.template generateRandomDataset<T>(count);
+    }
+
+    Point randomPoint() {
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        return Point({unit(rng), unit(rng)});
+    }
+
+    const Point& randomKey() {
+        std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+        return keys[pick(rng)];
+    }
+
+    /**
+     * @brief Aborta el benchmark si un resultado no tiene sentido
+     */
+    static void sanityCheck(bool ok, const std::string& what) {
+        if (!ok) throw std::runtime_error("Sanity check failed: " + what);
+    }
+
+    void requireKeys(const std::string& name) const {
+        if (keys.empty()) {
+            throw std::runtime_error(name + " requires a previous fillseq or fillrandom");
+        }
+    }
+
+    /**
+     * @brief Ejecuta ops veces op(i) midiendo cada operación
+     * op devuelve las filas leídas (0 en escrituras).
+     */
+    BenchResult measure(const std::string& name, size_t ops,
+                        const std::function<uint64_t(size_t)>& op) {
+        const auto& metrics = tree->getMetrics();
+        uint64_t readsBefore = metrics.totalReads;
+        uint64_t scannedBefore = metrics.readAmplification;
+
+        util::LatencyHistogram histogram;
+        BenchResult result;
+        auto start = Clock::now();
+        for (size_t i = 0; i < ops; ++i) {
+            auto t = Clock::now();
+            result.rows += op(i);
+            histogram.record(Clock::now() - t);
+        }
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        result.config = config.name;
+        result.name = name;
+        result.ops = ops;
+        result.latency = histogram.snapshot();
+
+        uint64_t reads = metrics.totalReads - readsBefore;
+        if (reads > 0) {
+            result.readAmplification =
+                static_cast<double>(metrics.readAmplification - scannedBefore) / reads;
+        }
+        fillTreeStats(result);
+        return result;
+    }
+
+    void fillTreeStats(BenchResult& result) const {
+        const auto& metrics = tree->getMetrics();
+        uint64_t writes = metrics.totalWrites;
+        result.writeAmplification =
+            writes ? static_cast<double>(metrics.writeAmplification.load()) / writes : 0.0;
+
+        uint64_t bytes = tree->getMemTableMemoryUsage();
+        for (const auto& level : tree->getLevelStats()) bytes += level.bytes;
+        result.treeBytes = bytes;
+        result.components = tree->getComponentCount();
+        uint64_t logical = liveRecords * logicalRecordBytes();
+        result.spaceAmplification = logical ? static_cast<double>(bytes) / logical : 0.0;
+        result.peakRSSBytes = peakRSSBytes();
+    }
+
+    BenchResult fill(const std::string& name, bool sequential) {
+        auto records = generate(options.num);
+        if (sequential) {
+            std::sort(records.begin(), records.end(),
+                      [](const SpatialRecord<T>& a, const SpatialRecord<T>& b) {
+                          return a.point[0] != b.point[0] ? a.point[0] < b.point[0]
+                                                          : a.point[1] < b.point[1];
+                      });
+        }
+        keys.reserve(keys.size() + records.size());
+        size_t totalBefore = tree->getTotalRecords();
+        size_t rejected = 0;
+        auto result = measure(name, records.size(), [&](size_t i) -> uint64_t {
+            if (!tree->insert(records[i].point, records[i].data)) ++rejected;
+            return 0;
+        });
+        for (const auto& rec : records) keys.push_back(rec.point);
+        liveRecords += records.size();
+
+        // El flush final cuenta en WA pero no en la latencia por operación
+        tree->flush();
+        fillTreeStats(result);
+
+        size_t loaded = tree->getTotalRecords() - std::min(totalBefore, tree->getTotalRecords());
+        sanityCheck(rejected == 0, name + " rejected " + std::to_string(rejected) + " insert(s)");
+        sanityCheck(loaded >= records.size(), name + " loaded " + std::to_string(loaded) + " of " +
+                                                  std::to_string(records.size()) + " records");
+        return result;
+    }
+
+    /**
+     * @brief kNN con ventana creciente sobre consultas por rango
+     * El lado inicial es el de una celda con k puntos esperados; se dobla
+     * hasta que la ventana contiene k puntos a distancia <= semilado (así
+     * ningún punto fuera de ella puede estar más cerca) o cubre el dominio.
+     */
+    uint64_t knn(const Point& center) {
+        double density = std::max<double>(1.0, static_cast<double>(keys.size()));
+        double half = std::sqrt(static_cast<double>(options.k) / density) / 2.0;
+
+        while (true) {
+            MBR box(Point({center[0] - half, center[1] - half}),
+                    Point({center[0] + half, center[1] + half}));
+            auto found = tree->spatialRangeQuery(box);
+
+            std::vector<double> distances;
+            distances.reserve(found.size());
+            for (const auto& rec : found) {
+                double dx = rec.point[0] - center[0], dy = rec.point[1] - center[1];
+                distances.push_back(std::sqrt(dx * dx + dy * dy));
+            }
+            size_t k = std::min(options.k, distances.size());
+            if (k > 0) {
+                std::nth_element(distances.begin(), distances.begin() + (k - 1), distances.end());
+            }
+            bool covered = half >= 1.0;
+            if (covered || (k == options.k && distances[k - 1] <= half)) {
+                return k;
+            }
+            half *= 2.0;
+        }
+    }
+
+public:
+    DbBench(const Config& cfg, const BenchOptions& opts)
+        : config(cfg), options(opts), tree(std::make_unique<lsm::LSMTree<T>>(DIMENSIONS)),
+          generator(opts.seed), rng(opts.seed) {
+        BenchmarkRunner<T>::configureTree(*tree, config);
+    }
+
+    /**
+     * @brief Pico de memoria residente del proceso (0 si no se conoce)
+     */
+    static uint64_t peakRSSBytes() {
+#if defined(__unix__) || defined(__APPLE__)
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+        return static_cast<uint64_t>(usage.ru_maxrss);          // bytes
+#else
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;   // KB
+#endif
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Ejecuta un benchmark por nombre
+     * rangequery devuelve un resultado por selectividad.
+     */
+    std::vector<BenchResult> run(const std::string& name) {
+        if (name == "fillseq") return {fill(name, true)};
+        if (name == "fillrandom") return {fill(name, false)};
+
+        if (name == "readrandom") {
+            requireKeys(name);
+            // Las claves leídas se cargaron antes y nunca se borran: todas deben aparecer
+            size_t hits = 0;
+            auto result = measure(name, options.reads, [&](size_t) -> uint64_t {
+                size_t rows = tree->pointQuery(randomKey()).size();
+                hits += rows > 0 ? 1 : 0;
+                return rows;
+            });
+            sanityCheck(hits == options.reads, name + " found " + std::to_string(hits) + " of " +
+                                                   std::to_string(options.reads) + " existing keys");
+            return {result};
+        }
+
+        if (name == "rangequery") {
+            requireKeys(name);
+            std::vector<BenchResult> results;
+            for (double selectivity : options.selectivities) {
+                std::vector<MBR> boxes;
+                boxes.reserve(options.queries);
+                for (size_t i = 0; i < options.queries; ++i) {
+                    boxes.push_back(generator.generateQueryBox(selectivity));
+                }
+                std::ostringstream label;
+                label << "rangequery[" << selectivity << "]";
+                results.push_back(measure(label.str(), boxes.size(), [&](size_t i) -> uint64_t {
+                    return tree->spatialRangeQuery(boxes[i]).size();
+                }));
+                sanityCheck(boxes.empty() || results.back().rows > 0,
+                            label.str() + " returned no rows in " + std::to_string(boxes.size()) + " queries");
+            }
+            return results;
+        }
+
+        if (name == "count") {
+            requireKeys(name);
+            double selectivity = options.selectivities.empty() ? 1e-3 : options.selectivities.front();
+            std::vector<MBR> boxes;
+            for (size_t i = 0; i < options.queries; ++i) {
+                boxes.push_back(generator.generateQueryBox(selectivity));
+            }
+            auto result = measure(name, boxes.size(), [&](size_t i) -> uint64_t {
+                return tree->spatialCount(boxes[i]);
+            });
+            sanityCheck(boxes.empty() || result.rows > 0,
+                        name + " counted 0 rows in " + std::to_string(boxes.size()) + " queries");
+            return {result};
+        }
+
+        if (name == "knn") {
+            requireKeys(name);
+            auto result = measure(name, options.queries, [&](size_t) -> uint64_t {
+                return knn(randomPoint());
+            });
+            sanityCheck(options.queries == 0 || result.rows > 0,
+                        name + " found " + std::to_string(result.rows) + " neighbour(s) in " +
+                            std::to_string(options.queries) + " queries");
+            return {result};
+        }
+
+        if (name == "mixed") {
+            requireKeys(name);
+            std::uniform_real_distribution<double> coin(0.0, 1.0);
+            auto result = measure(name, options.reads, [&](size_t i) -> uint64_t {
+                if (coin(rng) < options.writeRatio) {
+                    Point p = randomPoint();
+                    tree->insert(p, static_cast<T>(i));
+                    keys.push_back(p);
+                    ++liveRecords;
+                    return 0;
+                }
+                return tree->pointQuery(randomKey()).size();
+            });
+            return {result};
+        }
+
+        if (name == "ycsb") return runMixed();
+        if (name == "moving") return runMoving();
+
+        throw std::invalid_argument("Unknown benchmark: " + name);
+    }
+
+    /**
+     * @brief ycsb: clientes concurrentes con ventanas impresas en vivo
+     */
+    std::vector<BenchResult> runMixed() {
+        MixedWorkloadDriver<T> driver(*tree, options.ycsb);
+        driver.load(options.num);
+        liveRecords += options.num;
+
+        const auto& metrics = tree->getMetrics();
+        uint64_t readsBefore = metrics.totalReads;
+        uint64_t scannedBefore = metrics.readAmplification;
+
+        auto report = driver.run([](const typename MixedWorkloadDriver<T>::WindowStats& w) {
+            printMixedWindow(std::cout, w.startSeconds, w.seconds, w.ops);
+        });
+        liveRecords += report.totals[static_cast<size_t>(MixedOp::INSERT)].count;
+        liveRecords -= std::min<uint64_t>(liveRecords,
+                                          report.totals[static_cast<size_t>(MixedOp::DELETE)].count);
+
+        uint64_t reads = metrics.totalReads - readsBefore;
+        double readAmplification =
+            reads ? static_cast<double>(metrics.readAmplification - scannedBefore) / reads : 0.0;
+
+        std::vector<BenchResult> results;
+        for (size_t i = 0; i < MIXED_OP_COUNT; ++i) {
+            if (report.totals[i].count == 0) continue;
+            BenchResult r;
+            r.config = config.name;
+            r.name = std::string("ycsb.") + mixedOpName(static_cast<MixedOp>(i));
+            r.ops = report.totals[i].count;
+            r.seconds = report.seconds;
+            r.latency = report.totals[i];
+            r.readAmplification = readAmplification;
+            fillTreeStats(r);
+            results.push_back(std::move(r));
+        }
+        return results;
+    }
+
+    /**
+     * @brief moving: serie temporal de tombstones, espacio y compactación
+     */
+    std::vector<BenchResult> runMoving() {
+        MovingObjectsDriver<T> driver(*tree, options.moving);
+        driver.load();
+        liveRecords += options.moving.objects;
+
+        std::ofstream csv;
+        if (!options.timeseriesPath.empty()) {
+            csv.open(options.timeseriesPath, std::ios::app);
+            if (!csv) throw std::runtime_error("Cannot write " + options.timeseriesPath);
+        }
+
+        printMovingObjectsHeader(std::cout);
+        auto report = driver.run([&](const MovingObjectsSample& s) {
+            printMovingObjectsSample(std::cout, s);
+            if (csv) writeMovingObjectsCSVRow(csv, config.name, s);
+        });
+
+        auto result = [&](const char* suffix, uint64_t ops,
+                          const util::LatencyHistogram::Snapshot& latency) {
+            BenchResult r;
+            r.config = config.name;
+            r.name = std::string("moving.") + suffix;
+            r.ops = ops;
+            r.seconds = report.wallSeconds;
+            r.latency = latency;
+            fillTreeStats(r);
+            return r;
+        };
+        return {result("update", report.updates, report.updateLatency),
+                result("query", report.queries, report.queryLatency)};
+    }
+
+    std::vector<BenchResult> runAll() {
+        std::vector<BenchResult> results;
+        for (const auto& name : options.benchmarks) {
+            auto part = run(name);
+            results.insert(results.end(), part.begin(), part.end());
+        }
+        return results;
+    }
+
+    const lsm::LSMTree<T>& getTree() const { return *tree; }
+};
+
+/**
+ * @brief Línea estilo db_bench de un resultado
+ */
+inline void printBenchResult(std::ostream& out, const BenchResult& r) {
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    std::ios::fmtflags flags(out.flags());
+    std::streamsize precision = out.precision();
+
+    out << std::left << std::setw(22) << r.name << std::right << ": " << std::fixed
+        << std::setprecision(3) << std::setw(10) << r.microsPerOp() << " micros/op "
+        << std::setprecision(0) << std::setw(10) << r.opsPerSecond() << " ops/sec; "
+        << std::setprecision(1) << "p50 " << us(r.latency.percentile(50))
+        << " p99 " << us(r.latency.percentile(99))
+        << " p99.9 " << us(r.latency.percentile(99.9))
+        << " max " << us(r.latency.max) << " us; " << r.ops << " ops";
+    if (r.rows) out << ", " << r.rows << " rows";
+    out << "\n" << std::setprecision(2)
+        << std::string(24, ' ') << "WA " << r.writeAmplification
+        << "  RA " << r.readAmplification
+        << "  space amp " << r.spaceAmplification
+        << "  tree " << static_cast<double>(r.treeBytes) / (1024.0 * 1024.0) << " MB in "
+        << r.components << " components"
+        << "  peak RSS " << static_cast<double>(r.peakRSSBytes) / (1024.0 * 1024.0) << " MB\n";
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+inline std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Resultados como un array JSON (un objeto por benchmark y configuración)
+ */
+inline void writeBenchJSON(std::ostream& out, const std::vector<BenchResult>& results) {
+    std::ios::fmtflags flags(out.flags());
+    std::streamsize precision = out.precision();
+    out << std::setprecision(6);
+
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "  {\"config\": \"" << jsonEscape(r.config) << "\", \"benchmark\": \""
+            << jsonEscape(r.name) << "\", \"ops\": " << r.ops
+            << ", \"seconds\": " << r.seconds
+            << ", \"ops_per_sec\": " << r.opsPerSecond()
+            << ", \"latency_ns\": {\"mean\": " << r.latency.mean()
+            << ", \"p50\": " << r.latency.percentile(50)
+            << ", \"p90\": " << r.latency.percentile(90)
+            << ", \"p99\": " << r.latency.percentile(99)
+            << ", \"p99.9\": " << r.latency.percentile(99.9)
+            << ", \"max\": " << r.latency.max << "}"
+            << ", \"rows\": " << r.rows
+            << ", \"write_amplification\": " << r.writeAmplification
+            << ", \"read_amplification\": " << r.readAmplification
+            << ", \"space_amplification\": " << r.spaceAmplification
+            << ", \"tree_bytes\": " << r.treeBytes
+            << ", \"components\": " << r.components
+            << ", \"peak_rss_bytes\": " << r.peakRSSBytes << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace workload
@@ -0,0 +1,342 @@
+#pragma once
+
+#include "../lsm/LSMTree.h"
+#include "../util/Histogram.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace workload {
+
+using namespace spatial;
+
+/**
+ * @brief Generador Zipfian (Gray et al., el mismo que usa YCSB)
+ * Devuelve rangos en [0, items): el 0 es el más popular.
+ */
+class ZipfianGenerator {
+private:
+    uint64_t items;
+    double theta;
+    double alpha;
+    double zetan;
+    double eta;
+
+    static double zeta(uint64_t n, double theta) {
+        double sum = 0.0;
+        for (uint64_t i = 1; i <= n; ++i) sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        return sum;
+    }
+
+public:
+    explicit ZipfianGenerator(uint64_t n, double skew = 0.99)
+        : items(std::max<uint64_t>(1, n)), theta(skew) {
+        if (theta <= 0.0 || theta >= 1.0) {
+            throw std::invalid_argument("Zipfian theta must be in (0, 1)");
+        }
+        double zeta2 = zeta(2, theta);
+        zetan = zeta(items, theta);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1.0 - std::pow(2.0 / static_cast<double>(items), 1.0 - theta)) / (1.0 - zeta2 / zetan);
+    }
+
+    template<typename RNG>
+    uint64_t next(RNG& rng) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * zetan;
+        if (uz < 1.0) return 0;
+        if (uz < 1.0 + std::pow(0.5, theta)) return std::min<uint64_t>(1, items - 1);
+        auto rank = static_cast<uint64_t>(static_cast<double>(items) *
+                                          std::pow(eta * u - eta + 1.0, alpha));
+        return std::min(rank, items - 1);
+    }
+
+    uint64_t size() const { return items; }
+};
+
+/**
+ * @brief Operaciones del driver mixto
+ */
+enum class MixedOp : size_t { INSERT = 0, DELETE, POINT, RANGE, COUNT };
+
+constexpr size_t MIXED_OP_COUNT = 5;
+
+inline const char* mixedOpName(MixedOp op) {
+    switch (op) {
+        case MixedOp::INSERT: return "insert";
+        case MixedOp::DELETE: return "delete";
+        case MixedOp::POINT:  return "point";
+        case MixedOp::RANGE:  return "range";
+        case MixedOp::COUNT:  return "count";
+    }
+    return "?";
+}
+
+struct MixedWorkloadOptions {
+    size_t threads = 4;
+    double durationSeconds = 10.0;
+    double targetOpsPerSecond = 0.0;   // 0 = lazo cerrado; > 0 = lazo abierto (total)
+    std::array<double, MIXED_OP_COUNT> mix{{0.05, 0.05, 0.50, 0.30, 0.10}};  // insert, delete, point, range, count
+    std::string distribution = "zipfian";   // uniform, zipfian
+    double zipfTheta = 0.99;
+    double rangeSelectivity = 1e-4;    // Área de range/count sobre [0,1]^2
+    size_t windowMillis = 1000;
+    unsigned seed = 42;
+};
+
+/**
+ * @brief Driver estilo YCSB con N clientes concurrentes sobre un LSMTree
+ * La clave k se corresponde con un punto fijo (hash de k) en [0,1]^2, de
+ * modo que cualquier hilo puede reconstruirlo sin estado compartido. Las
+ * claves populares (Zipfian) concentran lecturas, borrados y centros de
+ * consultas por rango en los mismos lugares: puntos calientes espaciales.
+ *
+ * En lazo abierto cada cliente sigue un calendario fijo y la latencia se
+ * mide desde el instante previsto (sin omisión coordinada): los atascos
+ * por flush o backpressure aparecen en los percentiles.
+ */
+template<typename T>
+class MixedWorkloadDriver {
+public:
+    struct WindowStats {
+        double startSeconds = 0.0;
+        std::array<util::LatencyHistogram::Snapshot, MIXED_OP_COUNT> ops;
+        double seconds = 0.0;
+    };
+
+    struct Report {
+        double seconds = 0.0;
+        std::array<util::LatencyHistogram::Snapshot, MIXED_OP_COUNT> totals;
+        std::array<uint64_t, MIXED_OP_COUNT> errors{};
+        std::vector<WindowStats> windows;
+    };
+
+private:
+    lsm::LSMTree<T>& tree;
+    MixedWorkloadOptions options;
+    std::atomic<uint64_t> nextKey{0};       // Claves [0, nextKey) insertadas alguna vez
+    uint64_t loadedKeys = 0;
+    std::array<util::LatencyHistogram, MIXED_OP_COUNT> histograms;
+    std::array<std::atomic<uint64_t>, MIXED_OP_COUNT> errors{};
+
+    static uint64_t splitmix64(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    static double unitOf(uint64_t bits) {
+        return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);   // 2^-53
+    }
+
+    MixedOp chooseOp(double u) const {
+        double total = 0.0;
+        for (double p : options.mix) total += p;
+        double acc = 0.0;
+        for (size_t i = 0; i < MIXED_OP_COUNT; ++i) {
+            acc += options.mix[i] / total;
+            if (u < acc) return static_cast<MixedOp>(i);
+        }
+        return MixedOp::POINT;
+    }
+
+    MBR queryBoxAround(const Point& center) const {
+        double half = std::sqrt(options.rangeSelectivity) / 2.0;
+        return MBR(Point({center[0] - half, center[1] - half}),
+                   Point({center[0] + half, center[1] + half}));
+    }
+
+    void client(size_t id, std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end) {
+        using Clock = std::chrono::steady_clock;
+        std::mt19937_64 rng(options.seed * 7919 + id);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        ZipfianGenerator zipf(std::max<uint64_t>(1, loadedKeys), options.zipfTheta);
+        const bool zipfian = options.distribution == "zipfian";
+
+        // Lazo abierto: cada cliente emite targetOpsPerSecond / threads
+        const bool openLoop = options.targetOpsPerSecond > 0.0;
+        const auto interval = openLoop
+            ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(
+                  static_cast<double>(options.threads) / options.targetOpsPerSecond))
+            : Clock::duration::zero();
+        auto intended = start + interval * static_cast<int64_t>(id) / static_cast<int64_t>(options.threads);
+
+        while (true) {
+            Clock::time_point issue;
+            if (openLoop) {
+                if (intended >= end) break;
+                std::this_thread::sleep_until(intended);
+                issue = intended;
+                intended += interval;
+            } else {
+                issue = Clock::now();
+                if (issue >= end) break;
+            }
+
+            MixedOp op = chooseOp(unit(rng));
+            uint64_t known = nextKey.load(std::memory_order_relaxed);
+            uint64_t key = 0;
+            if (known > 0) {
+                key = zipfian ? zipf.next(rng) % known
+                              : std::uniform_int_distribution<uint64_t>(0, known - 1)(rng);
+            }
+
+            try {
+                switch (op) {
+                    case MixedOp::INSERT: {
+                        uint64_t k = nextKey.fetch_add(1, std::memory_order_relaxed);
+                        tree.insert(pointForKey(k), static_cast<T>(k));
+                        break;
+                    }
+                    case MixedOp::DELETE:
+                        tree.remove(pointForKey(key));
+                        break;
+                    case MixedOp::POINT:
+                        tree.pointQuery(pointForKey(key));
+                        break;
+                    case MixedOp::RANGE:
+                        tree.spatialRangeQuery(queryBoxAround(pointForKey(key)));
+                        break;
+                    case MixedOp::COUNT:
+                        tree.spatialCount(queryBoxAround(pointForKey(key)));
+                        break;
+                }
+            } catch (const std::exception&) {
+                errors[static_cast<size_t>(op)].fetch_add(1, std::memory_order_relaxed);
+            }
+            histograms[static_cast<size_t>(op)].record(Clock::now() - issue);
+        }
+    }
+
+public:
+    MixedWorkloadDriver(lsm::LSMTree<T>& target, const MixedWorkloadOptions& opts)
+        : tree(target), options(opts) {
+        if (options.threads == 0) throw std::invalid_argument("threads must be > 0");
+        if (options.distribution != "uniform" && options.distribution != "zipfian") {
+            throw std::invalid_argument("Unknown key distribution: " + options.distribution);
+        }
+        double total = 0.0;
+        for (double p : options.mix) {
+            if (p < 0.0) throw std::invalid_argument("Operation proportions must be >= 0");
+            total += p;
+        }
+        if (total <= 0.0) throw std::invalid_argument("Operation mix is empty");
+        options.windowMillis = std::max<size_t>(1, options.windowMillis);
+    }
+
+    /**
+     * @brief Punto asociado a una clave (determinista)
+     */
+    static Point pointForKey(uint64_t key) {
+        uint64_t h = splitmix64(key);
+        return Point({unitOf(h), unitOf(splitmix64(h))});
+    }
+
+    /**
+     * @brief Carga inicial de n claves y flush (no se mide)
+     */
+    void load(uint64_t n) {
+        for (uint64_t k = 0; k < n; ++k) {
+            tree.insert(pointForKey(k), static_cast<T>(k));
+        }
+        tree.flush();
+        nextKey = std::max<uint64_t>(nextKey, n);
+        loadedKeys = nextKey;
+    }
+
+    /**
+     * @brief Ejecuta los clientes durante durationSeconds
+     * @param onWindow Se llama al cerrar cada ventana (informe en vivo)
+     */
+    Report run(const std::function<void(const WindowStats&)>& onWindow = nullptr) {
+        using Clock = std::chrono::steady_clock;
+        if (loadedKeys == 0) loadedKeys = nextKey;
+        for (auto& h : histograms) h.reset();
+        for (auto& e : errors) e.store(0, std::memory_order_relaxed);
+
+        auto start = Clock::now();
+        auto end = start + std::chrono::duration_cast<Clock::duration>(
+                               std::chrono::duration<double>(options.durationSeconds));
+
+        std::vector<std::thread> clients;
+        clients.reserve(options.threads);
+        for (size_t i = 0; i < options.threads; ++i) {
+            clients.emplace_back([this, i, start, end]() { client(i, start, end); });
+        }
+
+        // Ventanas: diferencia entre instantáneas acumuladas consecutivas
+        Report report;
+        std::array<util::LatencyHistogram::Snapshot, MIXED_OP_COUNT> previous;
+        for (size_t i = 0; i < MIXED_OP_COUNT; ++i) previous[i] = histograms[i].snapshot();
+        auto windowStart = start;
+        const auto window = std::chrono::milliseconds(options.windowMillis);
+
+        auto closeWindow = [&](Clock::time_point now) {
+            WindowStats w;
+            w.startSeconds = std::chrono::duration<double>(windowStart - start).count();
+            w.seconds = std::chrono::duration<double>(now - windowStart).count();
+            for (size_t i = 0; i < MIXED_OP_COUNT; ++i) {
+                auto current = histograms[i].snapshot();
+                w.ops[i] = current.since(previous[i]);
+                previous[i] = std::move(current);
+            }
+            windowStart = now;
+            if (onWindow) onWindow(w);
+            report.windows.push_back(std::move(w));
+        };
+
+        while (Clock::now() < end) {
+            auto next = std::min(windowStart + window, end);
+            std::this_thread::sleep_until(next);
+            if (next < end) closeWindow(Clock::now());
+        }
+        for (auto& c : clients) c.join();
+        closeWindow(Clock::now());
+
+        report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        for (size_t i = 0; i < MIXED_OP_COUNT; ++i) {
+            report.totals[i] = histograms[i].snapshot();
+            report.errors[i] = errors[i].load(std::memory_order_relaxed);
+        }
+        return report;
+    }
+
+    const MixedWorkloadOptions& getOptions() const { return options; }
+};
+
+/**
+ * @brief Línea de una ventana: ops/s y p99 (us) por operación
+ */
+inline void printMixedWindow(std::ostream& out, double startSeconds, double seconds,
+                             const std::array<util::LatencyHistogram::Snapshot, MIXED_OP_COUNT>& ops) {
+    std::ios::fmtflags flags(out.flags());
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1) << "[" << std::setw(6) << startSeconds << "s]";
+    for (size_t i = 0; i < MIXED_OP_COUNT; ++i) {
+        if (ops[i].count == 0) continue;
+        double rate = seconds > 0.0 ? static_cast<double>(ops[i].count) / seconds : 0.0;
+        out << "  " << mixedOpName(static_cast<MixedOp>(i)) << " " << std::setprecision(0) << rate
+            << "/s p99 " << std::setprecision(1) << static_cast<double>(ops[i].percentile(99)) / 1000.0
+            << "us";
+    }
+    out << "\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace workload
@@ -0,0 +1,413 @@
+#pragma once
+
+#include "../lsm/LSMTree.h"
+#include "../util/Histogram.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace workload {
+
+using namespace spatial;
+
+/**
+ * @brief Parámetros del workload de objetos en movimiento (seguimiento de flotas)
+ * Las velocidades y tiempos están en unidades de [0,1]^2 y segundos
+ * simulados; la simulación avanza en ticks tan rápido como permita el árbol.
+ */
+struct MovingObjectsOptions {
+    size_t objects = 10000;
+    double speed = 0.0005;                  // Unidades por segundo simulado
+    double speedJitter = 0.5;               // Variación ± relativa por objeto
+    double updateIntervalSeconds = 5.0;     // Cada objeto reporta su posición con este periodo
+    size_t roads = 32;                      // Carreteras (mitad horizontales, mitad verticales)
+    double turnProbability = 0.3;           // Probabilidad de girar en un cruce
+    double gpsNoise = 0.0002;               // Ruido perpendicular a la carretera
+    double simulatedSeconds = 600.0;
+    double tickSeconds = 1.0;
+    double sampleEverySeconds = 30.0;       // Periodo de la serie temporal (simulado)
+    size_t queriesPerSample = 100;          // Consultas por rango en cada muestra
+    double querySelectivity = 1e-4;         // Área de cada consulta sobre [0,1]^2
+    unsigned seed = 42;
+};
+
+/**
+ * @brief Cambio de posición reportado por un objeto
+ */
+struct ObjectUpdate {
+    uint64_t id;
+    Point from;
+    Point to;
+};
+
+/**
+ * @brief Generador de trayectorias sobre una red de carreteras tipo Manhattan
+ * La mitad de las carreteras se reparte uniformemente y la otra mitad se
+ * concentra alrededor de un centro urbano, de modo que los objetos forman
+ * corredores densos como en datos reales de vehículos. Cada objeto recorre
+ * su carretera, gira en los cruces con turnProbability, rebota en los
+ * bordes y reporta su posición cada updateIntervalSeconds con fase
+ * aleatoria (los reportes se reparten en el tiempo).
+ */
+class TrajectoryGenerator {
+private:
+    struct Object {
+        bool horizontal;        // Circula por una carretera horizontal (y fija)
+        size_t road;
+        double along;           // Coordenada sobre la carretera
+        double direction;       // +1 o -1
+        double speed;
+        double nextReport;
+        Point reported;
+    };
+
+    MovingObjectsOptions options;
+    std::mt19937_64 rng;
+    std::vector<double> horizontalRoads;    // Coordenadas y, ordenadas
+    std::vector<double> verticalRoads;      // Coordenadas x, ordenadas
+    std::vector<Object> objects;
+    double now = 0.0;
+
+    double uniform() { return std::uniform_real_distribution<double>(0.0, 1.0)(rng); }
+
+    std::vector<double> makeRoads(size_t count, double center) {
+        std::normal_distribution<double> urban(center, 0.08);
+        std::vector<double> roads;
+        for (size_t i = 0; i < count; ++i) {
+            double c = (i % 2 == 0) ? uniform() : urban(rng);
+            roads.push_back(std::min(1.0, std::max(0.0, c)));
+        }
+        std::sort(roads.begin(), roads.end());
+        return roads;
+    }
+
+    const std::vector<double>& roadsOf(bool horizontal) const {
+        return horizontal ? horizontalRoads : verticalRoads;
+    }
+
+    const std::vector<double>& crossRoadsOf(bool horizontal) const {
+        return horizontal ? verticalRoads : horizontalRoads;
+    }
+
+    Point positionOf(const Object& o) {
+        double across = roadsOf(o.horizontal)[o.road] +
+                        std::normal_distribution<double>(0.0, options.gpsNoise)(rng);
+        across = std::min(1.0, std::max(0.0, across));
+        return o.horizontal ? Point({o.along, across}) : Point({across, o.along});
+    }
+
+    /**
+     * @brief Avanza un objeto dt segundos; como mucho gira en un cruce por tick
+     */
+    void move(Object& o, double dt) {
+        double from = o.along;
+        double to = from + o.direction * o.speed * dt;
+        if (to < 0.0 || to > 1.0) {
+            to = to < 0.0 ? -to : 2.0 - to;
+            o.direction = -o.direction;
+        }
+
+        const auto& cross = crossRoadsOf(o.horizontal);
+        double lo = std::min(from, to), hi = std::max(from, to);
+        auto first = std::upper_bound(cross.begin(), cross.end(), lo);
+        if (first != cross.end() && *first <= hi && uniform() < options.turnProbability) {
+            double oldRoad = roadsOf(o.horizontal)[o.road];
+            o.horizontal = !o.horizontal;
+            o.road = static_cast<size_t>(first - cross.begin());
+            o.along = oldRoad;
+            o.direction = uniform() < 0.5 ? 1.0 : -1.0;
+            return;
+        }
+        o.along = to;
+    }
+
+public:
+    explicit TrajectoryGenerator(const MovingObjectsOptions& opts) : options(opts), rng(opts.seed) {
+        if (options.roads < 2) throw std::invalid_argument("Moving objects need at least 2 roads");
+        if (options.updateIntervalSeconds <= 0.0) {
+            throw std::invalid_argument("Update interval must be positive");
+        }
+        double cx = 0.3 + 0.4 * uniform(), cy = 0.3 + 0.4 * uniform();
+        horizontalRoads = makeRoads(options.roads / 2, cy);
+        verticalRoads = makeRoads(options.roads - options.roads / 2, cx);
+
+        objects.reserve(options.objects);
+        for (size_t i = 0; i < options.objects; ++i) {
+            Object o;
+            o.horizontal = uniform() < 0.5;
+            o.road = static_cast<size_t>(uniform() * roadsOf(o.horizontal).size());
+            o.road = std::min(o.road, roadsOf(o.horizontal).size() - 1);
+            o.along = uniform();
+            o.direction = uniform() < 0.5 ? 1.0 : -1.0;
+            o.speed = options.speed * (1.0 + options.speedJitter * (2.0 * uniform() - 1.0));
+            o.nextReport = uniform() * options.updateIntervalSeconds;
+            o.reported = positionOf(o);
+            objects.push_back(std::move(o));
+        }
+    }
+
+    /**
+     * @brief Posición inicial reportada de cada objeto (id = índice)
+     */
+    std::vector<Point> initialPositions() const {
+        std::vector<Point> positions;
+        positions.reserve(objects.size());
+        for (const auto& o : objects) positions.push_back(o.reported);
+        return positions;
+    }
+
+    /**
+     * @brief Avanza la simulación dt segundos y devuelve los reportes debidos
+     */
+    std::vector<ObjectUpdate> advance(double dt) {
+        now += dt;
+        std::vector<ObjectUpdate> updates;
+        for (size_t i = 0; i < objects.size(); ++i) {
+            Object& o = objects[i];
+            move(o, dt);
+            if (o.nextReport <= now) {
+                Point next = positionOf(o);
+                updates.push_back({i, o.reported, next});
+                o.reported = std::move(next);
+                while (o.nextReport <= now) o.nextReport += options.updateIntervalSeconds;
+            }
+        }
+        return updates;
+    }
+
+    /**
+     * @brief Última posición reportada de un objeto (centro de consultas)
+     */
+    const Point& reportedPosition(size_t id) const { return objects[id].reported; }
+
+    size_t size() const { return objects.size(); }
+    double currentTime() const { return now; }
+};
+
+/**
+ * @brief Punto de la serie temporal del workload de objetos en movimiento
+ * Los contadores de compactación son acumulados; las latencias, de la
+ * ventana desde la muestra anterior.
+ */
+struct MovingObjectsSample {
+    double simSeconds = 0.0;
+    double wallSeconds = 0.0;
+    uint64_t updates = 0;                   // Acumuladas (borrado + reinserción)
+    size_t records = 0;                     // Físicos, incluidos tombstones y versiones
+    size_t tombstones = 0;
+    double tombstoneRatio = 0.0;            // tombstones / records
+    uint64_t treeBytes = 0;
+    double spaceAmplification = 0.0;        // Bytes del árbol / bytes lógicos vivos
+    size_t components = 0;
+    uint64_t merges = 0;
+    double mergeSeconds = 0.0;
+    uint64_t compactionBytesRead = 0;
+    uint64_t compactionBytesWritten = 0;
+    util::LatencyHistogram::Snapshot updateLatency;
+    util::LatencyHistogram::Snapshot queryLatency;
+};
+
+/**
+ * @brief Ejecuta trayectorias contra un LSMTree: cada reporte es un tombstone
+ * en la posición anterior más una inserción en la nueva
+ * Cada sampleEverySeconds simulados lanza queriesPerSample consultas por
+ * rango centradas en objetos al azar (donde está el tráfico) y toma una
+ * muestra del estado del árbol.
+ */
+template<typename T>
+class MovingObjectsDriver {
+public:
+    struct Report {
+        double wallSeconds = 0.0;
+        uint64_t updates = 0;
+        uint64_t queries = 0;
+        util::LatencyHistogram::Snapshot updateLatency;
+        util::LatencyHistogram::Snapshot queryLatency;
+        std::vector<MovingObjectsSample> samples;
+    };
+
+private:
+    lsm::LSMTree<T>& tree;
+    MovingObjectsOptions options;
+    TrajectoryGenerator generator;
+    std::mt19937_64 rng;
+    util::LatencyHistogram updateHistogram;
+    util::LatencyHistogram queryHistogram;
+
+    using Clock = std::chrono::steady_clock;
+
+    static uint64_t logicalRecordBytes(size_t dims) {
+        return dims * sizeof(double) + sizeof(T);
+    }
+
+    MBR queryBoxAround(const Point& center) const {
+        double half = std::sqrt(options.querySelectivity) / 2.0;
+        return MBR(Point({center[0] - half, center[1] - half}),
+                   Point({center[0] + half, center[1] + half}));
+    }
+
+    void runQueries() {
+        std::uniform_int_distribution<size_t> pick(0, generator.size() - 1);
+        for (size_t q = 0; q < options.queriesPerSample && generator.size() > 0; ++q) {
+            MBR box = queryBoxAround(generator.reportedPosition(pick(rng)));
+            auto start = Clock::now();
+            tree.spatialRangeQuery(box);
+            queryHistogram.record(Clock::now() - start);
+        }
+    }
+
+    MovingObjectsSample sample(double simSeconds, double wallSeconds, uint64_t updates) const {
+        MovingObjectsSample s;
+        s.simSeconds = simSeconds;
+        s.wallSeconds = wallSeconds;
+        s.updates = updates;
+        s.records = tree.getTotalRecords();
+        s.tombstones = tree.getTombstoneCount();
+        s.tombstoneRatio = s.records ? static_cast<double>(s.tombstones) / s.records : 0.0;
+        s.treeBytes = tree.getMemTableMemoryUsage();
+        for (const auto& level : tree.getLevelStats()) {
+            s.treeBytes += level.bytes;
+            s.merges += level.merges;
+            s.mergeSeconds += level.mergeSeconds;
+            s.compactionBytesRead += level.compactionBytesRead;
+            s.compactionBytesWritten += level.compactionBytesWritten;
+        }
+        uint64_t logical = generator.size() * logicalRecordBytes(2);
+        s.spaceAmplification = logical ? static_cast<double>(s.treeBytes) / logical : 0.0;
+        s.components = tree.getComponentCount();
+        return s;
+    }
+
+public:
+    MovingObjectsDriver(lsm::LSMTree<T>& t, const MovingObjectsOptions& opts)
+        : tree(t), options(opts), generator(opts), rng(opts.seed * 31 + 7) {
+        if (options.tickSeconds <= 0.0 || options.sampleEverySeconds <= 0.0) {
+            throw std::invalid_argument("Tick and sample periods must be positive");
+        }
+    }
+
+    /**
+     * @brief Inserta la posición inicial de todos los objetos y hace flush
+     */
+    void load() {
+        auto positions = generator.initialPositions();
+        for (size_t i = 0; i < positions.size(); ++i) {
+            tree.insert(positions[i], static_cast<T>(i));
+        }
+        tree.flush();
+    }
+
+    /**
+     * @brief Simula simulatedSeconds; onSample recibe cada punto de la serie
+     */
+    Report run(const std::function<void(const MovingObjectsSample&)>& onSample = nullptr) {
+        Report report;
+        auto start = Clock::now();
+        auto previousUpdates = updateHistogram.snapshot();
+        auto previousQueries = queryHistogram.snapshot();
+        double nextSample = options.sampleEverySeconds;
+        double simulated = 0.0;
+
+        while (simulated < options.simulatedSeconds) {
+            double dt = std::min(options.tickSeconds, options.simulatedSeconds - simulated);
+            simulated += dt;
+            for (const auto& update : generator.advance(dt)) {
+                auto t = Clock::now();
+                tree.remove(update.from);
+                tree.insert(update.to, static_cast<T>(update.id));
+                updateHistogram.record(Clock::now() - t);
+                ++report.updates;
+            }
+
+            if (simulated + 1e-9 >= nextSample || simulated >= options.simulatedSeconds) {
+                runQueries();
+                report.queries += options.queriesPerSample;
+                double wall = std::chrono::duration<double>(Clock::now() - start).count();
+                auto s = sample(simulated, wall, report.updates);
+                auto updates = updateHistogram.snapshot();
+                auto queries = queryHistogram.snapshot();
+                s.updateLatency = updates.since(previousUpdates);
+                s.queryLatency = queries.since(previousQueries);
+                previousUpdates = std::move(updates);
+                previousQueries = std::move(queries);
+                if (onSample) onSample(s);
+                report.samples.push_back(std::move(s));
+                while (nextSample <= simulated + 1e-9) nextSample += options.sampleEverySeconds;
+            }
+        }
+
+        report.wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+        report.updateLatency = updateHistogram.snapshot();
+        report.queryLatency = queryHistogram.snapshot();
+        return report;
+    }
+};
+
+/**
+ * @brief Cabecera de la tabla de la serie temporal
+ */
+inline void printMovingObjectsHeader(std::ostream& out) {
+    out << "   sim(s)  wall(s)     updates  tombstones  tomb%  space amp  files  merges"
+           "  merge(s)  compact(MB)  upd p99(us)  qry p99(us)\n";
+}
+
+/**
+ * @brief Fila de la serie temporal
+ */
+inline void printMovingObjectsSample(std::ostream& out, const MovingObjectsSample& s) {
+    std::ios::fmtflags flags(out.flags());
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << std::setw(9) << s.simSeconds
+        << std::setw(9) << s.wallSeconds
+        << std::setw(12) << s.updates
+        << std::setw(12) << s.tombstones
+        << std::setw(7) << 100.0 * s.tombstoneRatio
+        << std::setprecision(2)
+        << std::setw(11) << s.spaceAmplification
+        << std::setw(7) << s.components
+        << std::setw(8) << s.merges
+        << std::setw(10) << s.mergeSeconds
+        << std::setw(13) << static_cast<double>(s.compactionBytesWritten) / (1024.0 * 1024.0)
+        << std::setprecision(1)
+        << std::setw(13) << s.updateLatency.percentile(99) / 1e3
+        << std::setw(13) << s.queryLatency.percentile(99) / 1e3 << "\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+/**
+ * @brief Cabecera CSV de la serie temporal (una fila por muestra y configuración)
+ */
+inline void writeMovingObjectsCSVHeader(std::ostream& out) {
+    out << "config,sim_seconds,wall_seconds,updates,records,tombstones,tombstone_ratio,"
+           "tree_bytes,space_amplification,components,merges,merge_seconds,"
+           "compaction_bytes_read,compaction_bytes_written,update_p50_us,update_p99_us,"
+           "query_p50_us,query_p99_us\n";
+}
+
+inline void writeMovingObjectsCSVRow(std::ostream& out, const std::string& config,
+                                     const MovingObjectsSample& s) {
+    std::ios::fmtflags flags(out.flags());
+    std::streamsize precision = out.precision();
+    out << std::setprecision(6)
+        << '"' << config << "\"," << s.simSeconds << ',' << s.wallSeconds << ','
+        << s.updates << ',' << s.records << ',' << s.tombstones << ',' << s.tombstoneRatio << ','
+        << s.treeBytes << ',' << s.spaceAmplification << ',' << s.components << ','
+        << s.merges << ',' << s.mergeSeconds << ',' << s.compactionBytesRead << ','
+        << s.compactionBytesWritten << ','
+        << s.updateLatency.percentile(50) / 1e3 << ',' << s.updateLatency.percentile(99) / 1e3 << ','
+        << s.queryLatency.percentile(50) / 1e3 << ',' << s.queryLatency.percentile(99) / 1e3 << "\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace workload
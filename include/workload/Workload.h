@@ -2,9 +2,12 @@
 
 #include "../spatial/Point.h"
 #include "../lsm/LSMTree.h"
+#include "../lsm/ExternalSort.h"
 #include <vector>
 #include <random>
 #include <cmath>
+#include <iostream>
+#include <iomanip>
 
 namespace workload {
 
@@ -150,6 +153,20 @@ public:
         lsmTree.flush();
     }
     
+    /**
+     * @brief Fase de carga para datasets mayores que la RAM
+     * Ordena externamente por Hilbert, escribe componentes empaquetados
+     * y los ingiere directamente en el árbol.
+     */
+    void externalLoadPhase(typename lsm::ExternalHilbertSorter<T>::ChunkReader reader,
+                           const typename lsm::ExternalHilbertSorter<T>::Options& sortOptions,
+                           size_t maxComponentSize,
+                           const std::string& componentDirectory) {
+        lsm::ExternalHilbertSorter<T> sorter(sortOptions);
+        auto files = sorter.sortIntoComponents(reader, maxComponentSize, componentDirectory);
+        lsmTree.ingestComponents(files);
+    }
+    
     /**
      * @brief Fase de inserciones adicionales
      */
@@ -209,7 +226,7 @@ public:
         std::cout << "\n=== Performance Metrics ===\n";
         std::cout << "Write Amplification: " << metrics.writeAmplification << "\n";
         std::cout << "Read Amplification: " << metrics.readAmplification << "\n";
-        std::cout << "Avg Query Latency: " << metrics.avgQueryLatency << " ms\n";
+        std::cout << "Avg Query Latency: " << metrics.avgQueryLatency() << " ms\n";
     }
 };
 
@@ -235,6 +252,32 @@ public:
         size_t componentCount;
     };
     
+    /**
+     * @brief Configuraciones evaluadas en el paper (9+)
+     */
+    static std::vector<BenchmarkConfig> paperConfigurations() {
+        return {
+            {"Binomial k=4 / Simple", "Binomial", "Simple", "Size", 4},
+            {"Binomial k=10 / Simple", "Binomial", "Simple", "Size", 10},
+            {"Binomial k=4 / Hilbert", "Binomial", "Hilbert", "Size", 4},
+            {"Tiered B=4 / Simple", "Tiered", "Simple", "Size", 4},
+            {"Tiered B=10 / Simple", "Tiered", "Simple", "Size", 10},
+            {"Leveled / STR / Simple", "Leveled", "Simple", "STR", 10},
+            {"Leveled / STR / Hilbert", "Leveled", "Hilbert", "STR", 10},
+            {"Leveled / RStarGrove / Simple", "Leveled", "Simple", "RStarGrove", 10},
+            {"Concurrent / Simple", "Concurrent", "Simple", "Size", 2}
+        };
+    }
+    
+    /**
+     * @brief Aplica política de merge, comparador y particionado al árbol
+     */
+    static void configureTree(lsm::LSMTree<T>& tree, const BenchmarkConfig& config) {
+        tree.setCompactionPolicy(
+            lsm::makeMergePolicy<T>(config.mergePolicy, static_cast<size_t>(config.policyParameter)),
+            lsm::makePartitioningStrategy<T>(config.partitioning, config.comparator));
+    }
+    
     /**
      * @brief Ejecuta benchmark comparativo
      * Referencia: Comparación de 9+ configuraciones del paper
@@ -251,6 +294,7 @@ public:
             
             // Crear LSM-tree con configuración
             lsm::LSMTree<T> tree(2);
+            configureTree(tree, config);
             
             // Ejecutar workload
             WorkloadExecutor<T> executor(tree);
@@ -269,7 +313,7 @@ public:
             result.configName = config.name;
             result.writeAmplification = metrics.writeAmplification;
             result.readAmplification = metrics.readAmplification;
-            result.avgQueryLatency = metrics.avgQueryLatency;
+            result.avgQueryLatency = metrics.avgQueryLatency();
             result.componentCount = tree.getComponentCount();
             
             results.push_back(result);
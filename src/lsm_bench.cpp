@@ -0,0 +1,190 @@
+#include "workload/Benchmark.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, sep)) {
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--flag=value ...]\n"
+              << "  --benchmarks=a,b,...    fillseq, fillrandom, readrandom, rangequery, count, knn, mixed,\n"
+              << "                          ycsb, moving\n"
+              << "                          (default fillrandom,readrandom,rangequery,count,knn,mixed)\n"
+              << "  --num=N                 records loaded by fill benchmarks (default 1000000)\n"
+              << "  --reads=N               operations of readrandom and mixed (default 100000)\n"
+              << "  --queries=N             queries of rangequery, count and knn (default 1000)\n"
+              << "  --selectivities=s,...   range query selectivities (default 0.001,0.00001)\n"
+              << "  --k=N                   neighbours for knn (default 10)\n"
+              << "  --write_ratio=F         fraction of inserts in mixed (default 0.5)\n"
+              << "  --dataset=NAME          random or clustered (default random)\n"
+              << "  --clusters=N            clusters of the clustered dataset (default 20)\n"
+              << "  --seed=N                random seed (default 42)\n"
+              << "  --configs=paper         run every configuration evaluated in the paper\n"
+              << "  --merge_policy=NAME     Binomial, Tiered, Concurrent, Leveled (default Leveled)\n"
+              << "  --comparator=NAME       Simple or Hilbert (default Simple)\n"
+              << "  --partitioning=NAME     Size, STR, RStarGrove (default STR)\n"
+              << "  --policy_param=N        k, B, minimum components or level ratio (default 10)\n"
+              << "  --json=PATH             also write results as JSON ('-' for stdout)\n"
+              << "ycsb (concurrent clients; loads --num keys first):\n"
+              << "  --threads=N             client threads (default 4)\n"
+              << "  --duration=S            seconds to run (default 10)\n"
+              << "  --target_rate=R         total ops/sec, open loop (default 0 = closed loop)\n"
+              << "  --mix=op:w,...          insert, delete, point, range, count weights\n"
+              << "                          (default insert:5,delete:5,point:50,range:30,count:10)\n"
+              << "  --key_distribution=D    uniform or zipfian (default zipfian)\n"
+              << "  --zipf_theta=F          Zipfian skew in (0,1) (default 0.99)\n"
+              << "  --ycsb_selectivity=F    area of range/count queries (default 0.0001)\n"
+              << "  --window_ms=N           reporting window (default 1000)\n"
+              << "moving (vehicle fleet, each report = delete old + insert new position):\n"
+              << "  --objects=N             moving objects (default 10000)\n"
+              << "  --speed=F               units of [0,1]^2 per simulated second (default 0.0005)\n"
+              << "  --update_interval=S     seconds between reports of an object (default 5)\n"
+              << "  --roads=N               roads of the Manhattan-like network (default 32)\n"
+              << "  --sim_seconds=S         simulated time (default 600)\n"
+              << "  --sample_every=S        simulated seconds between samples (default 30)\n"
+              << "  --sample_queries=N      range queries per sample (default 100)\n"
+              << "  --timeseries=PATH       write the time series as CSV\n";
+}
+
+} // namespace
+
+/**
+ * @brief Benchmark estilo db_bench: configuraciones del paper a escala
+ */
+int main(int argc, char* argv[]) {
+    using Runner = workload::BenchmarkRunner<int>;
+
+    workload::BenchOptions options;
+    Runner::BenchmarkConfig single{"", "Leveled", "Simple", "STR", 10};
+    bool paper = false;
+    std::string jsonPath;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg(argv[i]);
+            if (arg == "--help" || arg == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            }
+            size_t eq = arg.find('=');
+            if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+                throw std::invalid_argument("Malformed argument: " + arg);
+            }
+            std::string key = arg.substr(2, eq - 2), value = arg.substr(eq + 1);
+
+            if (key == "benchmarks") options.benchmarks = split(value, ',');
+            else if (key == "num") options.num = std::stoull(value);
+            else if (key == "reads") options.reads = std::stoull(value);
+            else if (key == "queries") options.queries = std::stoull(value);
+            else if (key == "k") options.k = std::stoull(value);
+            else if (key == "write_ratio") options.writeRatio = std::stod(value);
+            else if (key == "dataset") options.dataset = value;
+            else if (key == "clusters") options.clusters = std::stoull(value);
+            else if (key == "seed") options.seed = static_cast<unsigned>(std::stoul(value));
+            else if (key == "merge_policy") single.mergePolicy = value;
+            else if (key == "comparator") single.comparator = value;
+            else if (key == "partitioning") single.partitioning = value;
+            else if (key == "policy_param") single.policyParameter = std::stoi(value);
+            else if (key == "json") jsonPath = value;
+            else if (key == "threads") options.ycsb.threads = std::stoull(value);
+            else if (key == "duration") options.ycsb.durationSeconds = std::stod(value);
+            else if (key == "target_rate") options.ycsb.targetOpsPerSecond = std::stod(value);
+            else if (key == "key_distribution") options.ycsb.distribution = value;
+            else if (key == "zipf_theta") options.ycsb.zipfTheta = std::stod(value);
+            else if (key == "ycsb_selectivity") options.ycsb.rangeSelectivity = std::stod(value);
+            else if (key == "window_ms") options.ycsb.windowMillis = std::stoull(value);
+            else if (key == "objects") options.moving.objects = std::stoull(value);
+            else if (key == "speed") options.moving.speed = std::stod(value);
+            else if (key == "update_interval") options.moving.updateIntervalSeconds = std::stod(value);
+            else if (key == "roads") options.moving.roads = std::stoull(value);
+            else if (key == "sim_seconds") options.moving.simulatedSeconds = std::stod(value);
+            else if (key == "sample_every") options.moving.sampleEverySeconds = std::stod(value);
+            else if (key == "sample_queries") options.moving.queriesPerSample = std::stoull(value);
+            else if (key == "timeseries") options.timeseriesPath = value;
+            else if (key == "mix") {
+                options.ycsb.mix.fill(0.0);
+                for (const auto& entry : split(value, ',')) {
+                    size_t colon = entry.find(':');
+                    if (colon == std::string::npos) throw std::invalid_argument("Malformed mix: " + entry);
+                    std::string op = entry.substr(0, colon);
+                    double weight = std::stod(entry.substr(colon + 1));
+                    size_t i = 0;
+                    while (i < workload::MIXED_OP_COUNT &&
+                           op != workload::mixedOpName(static_cast<workload::MixedOp>(i))) ++i;
+                    if (i == workload::MIXED_OP_COUNT) throw std::invalid_argument("Unknown operation: " + op);
+                    options.ycsb.mix[i] = weight;
+                }
+            }
+            else if (key == "configs") {
+                if (value != "paper") throw std::invalid_argument("Unknown config set: " + value);
+                paper = true;
+            } else if (key == "selectivities") {
+                options.selectivities.clear();
+                for (const auto& s : split(value, ',')) options.selectivities.push_back(std::stod(s));
+            } else {
+                throw std::invalid_argument("Unknown flag: --" + key);
+            }
+        }
+        if (options.dataset != "random" && options.dataset != "clustered") {
+            throw std::invalid_argument("Unknown dataset: " + options.dataset);
+        }
+
+        std::vector<Runner::BenchmarkConfig> configs;
+        if (paper) {
+            configs = Runner::paperConfigurations();
+        } else {
+            single.name = single.mergePolicy + " / " + single.partitioning + " / " + single.comparator;
+            configs.push_back(single);
+        }
+
+        std::cout << "Records:    " << options.num << " (" << options.dataset << ")\n"
+                  << "Benchmarks: ";
+        for (size_t i = 0; i < options.benchmarks.size(); ++i) {
+            std::cout << (i ? "," : "") << options.benchmarks[i];
+        }
+        std::cout << "\n";
+
+        if (!options.timeseriesPath.empty()) {
+            std::ofstream csv(options.timeseriesPath);
+            if (!csv) throw std::runtime_error("Cannot write " + options.timeseriesPath);
+            workload::writeMovingObjectsCSVHeader(csv);
+        }
+
+        std::vector<workload::BenchResult> all;
+        for (const auto& config : configs) {
+            std::cout << "\n=== " << config.name << " ===\n";
+            workload::DbBench<int> bench(config, options);
+            for (const auto& name : options.benchmarks) {
+                for (const auto& result : bench.run(name)) {
+                    workload::printBenchResult(std::cout, result);
+                    all.push_back(result);
+                }
+            }
+        }
+
+        if (jsonPath == "-") {
+            workload::writeBenchJSON(std::cout, all);
+        } else if (!jsonPath.empty()) {
+            std::ofstream out(jsonPath);
+            if (!out) throw std::runtime_error("Cannot write " + jsonPath);
+            workload::writeBenchJSON(out, all);
+            std::cout << "\nWrote " << all.size() << " result(s) to " << jsonPath << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,294 @@
+#include "util/MicroBench.h"
+#include "spatial/MBR.h"
+#include "spatial/RTree.h"
+#include "spatial/SpatialComparators.h"
+#include "lsm/LSMTree.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace spatial;
+using Params = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @brief Puntos D-dimensionales en [0,1]^D, uniformes o en clusters gaussianos
+ */
+std::vector<Point> generatePoints(size_t count, size_t dims, const std::string& distribution,
+                                  unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<double> spread(0.0, 0.02);
+
+    std::vector<std::vector<double>> centers;
+    if (distribution == "clustered") {
+        for (size_t c = 0; c < 20; ++c) {
+            std::vector<double> center(dims);
+            for (auto& v : center) v = unit(rng);
+            centers.push_back(center);
+        }
+    }
+
+    std::vector<Point> points;
+    points.reserve(count);
+    std::vector<double> coords(dims);
+    for (size_t i = 0; i < count; ++i) {
+        if (centers.empty()) {
+            for (auto& v : coords) v = unit(rng);
+        } else {
+            const auto& center = centers[rng() % centers.size()];
+            for (size_t d = 0; d < dims; ++d) {
+                coords[d] = std::min(1.0, std::max(0.0, center[d] + spread(rng)));
+            }
+        }
+        points.emplace_back(coords);
+    }
+    return points;
+}
+
+std::vector<SpatialRecord<int>> toRecords(const std::vector<Point>& points) {
+    std::vector<SpatialRecord<int>> records;
+    records.reserve(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        records.emplace_back(points[i], static_cast<int>(i), false);
+    }
+    return records;
+}
+
+/**
+ * @brief Cajas pequeñas (lado 0.01) centradas en los puntos
+ */
+std::vector<MBR> boxesAround(const std::vector<Point>& points, size_t dims) {
+    std::vector<MBR> boxes;
+    boxes.reserve(points.size());
+    std::vector<double> lo(dims), hi(dims);
+    for (const auto& p : points) {
+        for (size_t d = 0; d < dims; ++d) {
+            lo[d] = p[d] - 0.005;
+            hi[d] = p[d] + 0.005;
+        }
+        boxes.emplace_back(Point(lo), Point(hi));
+    }
+    return boxes;
+}
+
+/**
+ * @brief Aborta si un kernel no hizo el trabajo esperado: un resultado
+ * incorrecto o degenerado invalidaría la medición
+ */
+void check(bool ok, const std::string& kernel, const Params& params, const std::string& what) {
+    if (ok) return;
+    std::string label = kernel;
+    for (const auto& [key, value] : params) label += " " + key + "=" + value;
+    throw std::runtime_error("Sanity check failed for " + label + ": " + what);
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, sep)) {
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--flag=value ...]\n"
+              << "  --filter=SUBSTR       only kernels whose name contains SUBSTR\n"
+              << "  --sizes=n,...         dataset sizes (default 1000,100000)\n"
+              << "  --dims=d,...          dimensions (default 2,3,4; hilbert_encode is 2-D only)\n"
+              << "  --distributions=...   random, clustered (default both)\n"
+              << "  --warmup=N            discarded repetitions (default 2)\n"
+              << "  --repetitions=N       measured repetitions (default 15)\n"
+              << "  --json=PATH           also write results as JSON ('-' for stdout)\n";
+}
+
+} // namespace
+
+/**
+ * @brief Microbenchmarks de kernels espaciales y de construcción de índices
+ * Kernels: mbr_intersects, hilbert_encode, simple_comparator_sort,
+ * rtree_bulk_load y remove_duplicates_tombstones.
+ */
+int main(int argc, char* argv[]) {
+    util::MicroBenchOptions options;
+    std::vector<size_t> sizes{1000, 100000};
+    std::vector<size_t> dimensions{2, 3, 4};
+    std::vector<std::string> distributions{"random", "clustered"};
+    std::string filter, jsonPath;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg(argv[i]);
+            if (arg == "--help" || arg == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            }
+            size_t eq = arg.find('=');
+            if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+                throw std::invalid_argument("Malformed argument: " + arg);
+            }
+            std::string key = arg.substr(2, eq - 2), value = arg.substr(eq + 1);
+
+            if (key == "filter") filter = value;
+            else if (key == "json") jsonPath = value;
+            else if (key == "warmup") options.warmup = std::stoull(value);
+            else if (key == "repetitions") options.repetitions = std::stoull(value);
+            else if (key == "distributions") distributions = split(value, ',');
+            else if (key == "sizes") {
+                sizes.clear();
+                for (const auto& s : split(value, ',')) sizes.push_back(std::stoull(s));
+            } else if (key == "dims") {
+                dimensions.clear();
+                for (const auto& s : split(value, ',')) dimensions.push_back(std::stoull(s));
+            } else {
+                throw std::invalid_argument("Unknown flag: --" + key);
+            }
+        }
+        for (const auto& dist : distributions) {
+            if (dist != "random" && dist != "clustered") {
+                throw std::invalid_argument("Unknown distribution: " + dist);
+            }
+        }
+
+        util::MicroBench bench(options);
+        auto enabled = [&filter](const std::string& name) {
+            return filter.empty() || name.find(filter) != std::string::npos;
+        };
+        auto report = [](const util::MicroBenchResult& r) {
+            util::printMicroBenchResult(std::cout, r);
+        };
+
+        for (const auto& dist : distributions) {
+            for (size_t dims : dimensions) {
+                for (size_t n : sizes) {
+                    Params params{{"distribution", dist}, {"dims", std::to_string(dims)},
+                                  {"size", std::to_string(n)}};
+                    auto points = generatePoints(n, dims, dist, 42);
+                    auto records = toRecords(points);
+
+                    if (enabled("mbr_intersects")) {
+                        auto boxes = boxesAround(points, dims);
+                        // Referencia: solape por dimensión calculado a mano
+                        size_t expected = 0;
+                        for (size_t i = 0; i < boxes.size(); ++i) {
+                            const MBR& a = boxes[i];
+                            const MBR& b = boxes[(i + 1) % boxes.size()];
+                            bool overlap = true;
+                            for (size_t d = 0; d < dims; ++d) {
+                                overlap = overlap && a.getLower()[d] <= b.getUpper()[d] &&
+                                          b.getLower()[d] <= a.getUpper()[d];
+                            }
+                            expected += overlap;
+                        }
+                        size_t hits = 0;
+                        report(bench.run("mbr_intersects", params, n, nullptr, [&]() {
+                            hits = 0;
+                            for (size_t i = 0; i < boxes.size(); ++i) {
+                                hits += boxes[i].intersects(boxes[(i + 1) % boxes.size()]);
+                            }
+                            util::doNotOptimize(hits);
+                        }));
+                        check(hits == expected, "mbr_intersects", params,
+                              std::to_string(hits) + " hits, expected " + std::to_string(expected));
+                    }
+
+                    if (dims == 2 && enabled("hilbert_encode")) {
+                        MBR bounds(Point({0.0, 0.0}), Point({1.0, 1.0}));
+                        std::vector<uint64_t> keys(points.size());
+                        report(bench.run("hilbert_encode", params, n, nullptr, [&]() {
+                            for (size_t i = 0; i < points.size(); ++i) {
+                                keys[i] = HilbertCurveComparator::computeHilbertIndex(points[i], bounds);
+                            }
+                            util::doNotOptimize(keys.data());
+                        }));
+                        // Claves constantes o casi (p. ej. bounds mal normalizados) no miden nada
+                        std::set<uint64_t> distinct(keys.begin(), keys.end());
+                        check(distinct.size() > points.size() / 2, "hilbert_encode", params,
+                              std::to_string(distinct.size()) + " distinct keys for " +
+                                  std::to_string(points.size()) + " points");
+                    }
+
+                    if (enabled("simple_comparator_sort")) {
+                        std::vector<SpatialRecord<int>> work;
+                        report(bench.run("simple_comparator_sort", params, n,
+                                         [&]() { work = records; },
+                                         [&]() {
+                                             std::sort(work.begin(), work.end(), SimpleComparator());
+                                             util::doNotOptimize(work.data());
+                                         }));
+                        check(work.size() == n && std::is_sorted(work.begin(), work.end(), SimpleComparator()),
+                              "simple_comparator_sort", params, "output is not a sorted permutation");
+                    }
+
+                    if (enabled("rtree_bulk_load")) {
+                        std::vector<SpatialRecord<int>> work;
+                        size_t indexed = 0;
+                        report(bench.run("rtree_bulk_load", params, n,
+                                         [&]() { work = records; },
+                                         [&]() {
+                                             RTree<int> tree(dims);
+                                             tree.build(std::move(work));
+                                             util::doNotOptimize(tree);
+                                             indexed = tree.size();
+                                         }));
+                        check(indexed == n, "rtree_bulk_load", params,
+                              std::to_string(indexed) + " records indexed, expected " + std::to_string(n));
+                    }
+
+                    if (enabled("remove_duplicates_tombstones")) {
+                        // Del más reciente al más antiguo, como tras leer varios
+                        // componentes solapados: 5% de tombstones, los registros y
+                        // un 10% de versiones antiguas repetidas
+                        std::vector<SpatialRecord<int>> input;
+                        for (size_t i = 0; i < n / 20; ++i) {
+                            input.emplace_back(records[(i * 13) % n].point, 0, true);
+                        }
+                        input.insert(input.end(), records.begin(), records.end());
+                        for (size_t i = 0; i < n / 10; ++i) input.push_back(records[(i * 7) % n]);
+
+                        std::map<Point, bool, SimpleComparator> newest;
+                        for (const auto& r : input) newest.emplace(r.point, r.isTombstone);
+                        size_t expected = static_cast<size_t>(std::count_if(newest.begin(), newest.end(),
+                            [](const std::pair<const Point, bool>& e) { return !e.second; }));
+
+                        lsm::LSMTree<int> tree(dims);
+                        std::vector<SpatialRecord<int>> work;
+                        report(bench.run("remove_duplicates_tombstones", params, input.size(),
+                                         [&]() { work = input; },
+                                         [&]() {
+                                             tree.removeDuplicatesAndTombstones(work);
+                                             util::doNotOptimize(work.size());
+                                         }));
+                        check(work.size() == expected && expected < newest.size(),
+                              "remove_duplicates_tombstones", params,
+                              std::to_string(work.size()) + " survivors, expected " +
+                                  std::to_string(expected) + " of " + std::to_string(newest.size()));
+                    }
+                }
+            }
+        }
+
+        if (jsonPath == "-") {
+            util::writeMicroBenchJSON(std::cout, bench.getResults(), bench.getOptions());
+        } else if (!jsonPath.empty()) {
+            std::ofstream out(jsonPath);
+            if (!out) throw std::runtime_error("Cannot write " + jsonPath);
+            util::writeMicroBenchJSON(out, bench.getResults(), bench.getOptions());
+            std::cout << "\nWrote " << bench.getResults().size() << " result(s) to " << jsonPath << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
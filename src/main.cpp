@@ -1,5 +1,7 @@
 #include "cli/CLI.h"
 #include "workload/Workload.h"
+#include "lsm/ComponentBuilder.h"
+#include "lsm/ExternalSort.h"
 #include <iostream>
 #include <iomanip>
 
@@ -42,17 +44,7 @@ int main(int argc, char* argv[]) {
                 std::cout << "Generated query sets\n";
                 
                 // Configuraciones a evaluar (9+ configuraciones del paper)
-                std::vector<workload::BenchmarkRunner<int>::BenchmarkConfig> configs = {
-                    {"Binomial k=4 / Simple", "Binomial", "Simple", "Size", 4},
-                    {"Binomial k=10 / Simple", "Binomial", "Simple", "Size", 10},
-                    {"Binomial k=4 / Hilbert", "Binomial", "Hilbert", "Size", 4},
-                    {"Tiered B=4 / Simple", "Tiered", "Simple", "Size", 4},
-                    {"Tiered B=10 / Simple", "Tiered", "Simple", "Size", 10},
-                    {"Leveled / STR / Simple", "Leveled", "Simple", "STR", 10},
-                    {"Leveled / STR / Hilbert", "Leveled", "Hilbert", "STR", 10},
-                    {"Leveled / RStarGrove / Simple", "Leveled", "Simple", "RStarGrove", 10},
-                    {"Concurrent / Simple", "Concurrent", "Simple", "Size", 2}
-                };
+                auto configs = workload::BenchmarkRunner<int>::paperConfigurations();
                 
                 // Ejecutar benchmark comparativo
                 workload::BenchmarkRunner<int> runner;
@@ -92,17 +84,88 @@ int main(int argc, char* argv[]) {
                     const auto& metrics = trees["cities"]->getMetrics();
                     std::cout << "  Total writes: " << metrics.totalWrites << "\n";
                     std::cout << "  Total reads: " << metrics.totalReads << "\n";
-                    std::cout << "  Avg latency: " << metrics.avgQueryLatency << " ms\n";
+                    std::cout << "  Avg latency: " << metrics.avgQueryLatency() << " ms\n";
                 }
                 
                 std::cout << "\nDemo complete. Starting interactive mode...\n";
                 cli.start();
                 
+            } else if (mode == "build-components") {
+                // Constructor offline de componentes para ingesta directa
+                if (argc < 4) {
+                    std::cout << "Usage: " << argv[0]
+                              << " build-components <input.csv> <outdir> [STR|RStarGrove] [maxComponentSize]\n";
+                    return 1;
+                }
+                
+                lsm::ComponentBuilder<int>::Options options;
+                options.outputDirectory = argv[3];
+                if (argc > 4) options.partitioning = argv[4];
+                if (argc > 5) options.maxComponentSize = std::stoul(argv[5]);
+                
+                lsm::ComponentBuilder<int> builder(options);
+                auto records = builder.readCSV(argv[2]);
+                std::cout << "Read " << records.size() << " records from " << argv[2] << "\n";
+                
+                auto files = builder.build(records);
+                std::cout << "Wrote " << files.size() << " component file(s) using "
+                          << options.partitioning << " partitioning:\n";
+                for (const auto& file : files) {
+                    std::cout << "  " << file << "\n";
+                }
+                
+            } else if (mode == "sort-components") {
+                // Ordenamiento externo Hilbert para datasets mayores que la RAM
+                if (argc < 4) {
+                    std::cout << "Usage: " << argv[0]
+                              << " sort-components <input.csv> <outdir> [memoryMB] [tempMB] [maxComponentSize]\n";
+                    return 1;
+                }
+                
+                lsm::ExternalHilbertSorter<int>::Options options;
+                options.tempDirectory = std::string(argv[3]) + "/tmp";
+                if (argc > 4) options.memoryBudgetBytes = std::stoull(argv[4]) * 1024 * 1024;
+                if (argc > 5) options.tempSpaceBudgetBytes = std::stoull(argv[5]) * 1024 * 1024;
+                size_t maxComponentSize = argc > 6 ? std::stoul(argv[6]) : 100000;
+                
+                // Primera pasada: dominio de los datos para la clave Hilbert
+                lsm::CSVChunkReader<int> boundsReader(argv[2], options.dimensions);
+                options.bounds = lsm::ExternalHilbertSorter<int>::scanBounds(std::ref(boundsReader),
+                                                                             options.dimensions);
+                
+                lsm::ExternalHilbertSorter<int> sorter(options);
+                lsm::CSVChunkReader<int> reader(argv[2], options.dimensions);
+                auto files = sorter.sortIntoComponents(std::ref(reader), maxComponentSize, argv[3]);
+                
+                const auto& stats = sorter.getStats();
+                std::cout << "Sorted " << stats.recordsSorted << " records in "
+                          << stats.runsWritten << " run(s), " << stats.mergePasses
+                          << " merge pass(es), peak temp " << stats.peakTempBytes << " bytes\n";
+                std::cout << "Wrote " << files.size() << " component file(s):\n";
+                for (const auto& file : files) {
+                    std::cout << "  " << file << "\n";
+                }
+                
+            } else if (mode == "open") {
+                // Modo interactivo persistente: recupera tablas desde el MANIFEST
+                if (argc < 3) {
+                    std::cout << "Usage: " << argv[0] << " open <dataDirectory>\n";
+                    return 1;
+                }
+                cli::CLI<int> persistentCli(lsm::WriteBufferManager::Options(), 0, argv[2]);
+                persistentCli.start();
+                
             } else {
                 std::cout << "Unknown mode: " << mode << "\n";
-                std::cout << "Usage: " << argv[0] << " [benchmark|demo]\n";
+                std::cout << "Usage: " << argv[0] << " [benchmark|demo|build-components|sort-components|open]\n";
                 std::cout << "  benchmark - Run full performance evaluation\n";
                 std::cout << "  demo      - Run interactive demo\n";
+                std::cout << "  build-components <input.csv> <outdir> [STR|RStarGrove] [maxComponentSize]\n";
+                std::cout << "            - Build component files for direct ingestion\n";
+                std::cout << "  sort-components <input.csv> <outdir> [memoryMB] [tempMB] [maxComponentSize]\n";
+                std::cout << "            - External Hilbert sort for datasets larger than RAM\n";
+                std::cout << "  open <dataDirectory>\n";
+                std::cout << "            - Start interactive CLI on a persistent database\n";
                 std::cout << "  (no args) - Start interactive CLI\n";
                 return 1;
             }